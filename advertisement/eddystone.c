@@ -1,5 +1,5 @@
 /*
- * Eddystone URL advertisement
+ * Eddystone URL, UID and TLM advertisements
  */
 
 // Standard Libraries
@@ -27,32 +27,86 @@
 
 // Platform, Peripherals, Devices, Services
 #include "simple_ble.h"
+#include "multi_adv.h"
 #include "eddystone.h"
 
 static ble_uuid_t PHYSWEB_SERVICE_UUID[] = {{PHYSWEB_SERVICE_ID, BLE_UUID_TYPE_BLE}};
 static ble_advdata_uuid_list_t PHYSWEB_SERVICE_LIST = {1, PHYSWEB_SERVICE_UUID};
 
-void eddystone_adv(char* url_str, const ble_advdata_t* scan_response_data) {
-    uint32_t err_code;
+// Indexed by their PHYSWEB_URLSCHEME_* and PHYSWEB_URLEND_* codes. A scheme
+// or ending that starts with another one comes first, so the first match is
+// the longest.
+static const char* const url_schemes[] = {
+    "http://www.", "https://www.", "http://", "https://",
+};
+static const char* const url_ends[] = {
+    ".com/", ".org/", ".edu/", ".net/", ".info/", ".biz/", ".gov/",
+    ".com", ".org", ".edu", ".net", ".info", ".biz", ".gov",
+};
 
-    // Physical Web data
-    uint8_t url_frame_length = 3 + strlen((char*)url_str); // Change to 4 if URLEND is applied
-    uint8_t m_url_frame[url_frame_length];
-    m_url_frame[0] = PHYSWEB_URL_TYPE;
-    m_url_frame[1] = PHYSWEB_TX_POWER;
-    m_url_frame[2] = PHYSWEB_URLSCHEME_HTTP;
-    for (uint8_t i=0; i<strlen((char*)url_str); i++) {
-        m_url_frame[i+3] = url_str[i];
+// Encode a URL into the scheme and URL fields of an Eddystone-URL frame.
+// URLs without a scheme are taken as http://, and www. is folded into the
+// scheme. Every ending starts with a dot and has no other, so matches can
+// not overlap and taking the longest one at each dot gives the shortest
+// frame. Returns the encoded length, or 0 if the URL does not fit.
+uint8_t eddystone_url_encode(uint8_t* encoded, const char* url_str) {
+    uint8_t scheme = PHYSWEB_URLSCHEME_HTTP;
+    uint8_t length = 0;
+    size_t  n;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(url_schemes)/sizeof(url_schemes[0]); i++) {
+        n = strlen(url_schemes[i]);
+        if (strncmp(url_str, url_schemes[i], n) == 0) {
+            scheme = i;
+            url_str += n;
+            break;
+        }
+    }
+    if (i == sizeof(url_schemes)/sizeof(url_schemes[0]) &&
+            strncmp(url_str, "www.", 4) == 0) {
+        scheme = PHYSWEB_URLSCHEME_HTTPWWW;
+        url_str += 4;
     }
-    //m_url_frame[url_frame_length-1] = PHYSWEB_URLEND_COMSLASH; // Remember to change url_frame_length
-    
+    encoded[length++] = scheme;
+
+    while (*url_str != '\0') {
+        if (length > PHYSWEB_URL_MAX_LEN) {
+            return 0;
+        }
+
+        if (*url_str == '.') {
+            for (i = 0; i < sizeof(url_ends)/sizeof(url_ends[0]); i++) {
+                n = strlen(url_ends[i]);
+                if (strncmp(url_str, url_ends[i], n) == 0) {
+                    break;
+                }
+            }
+            if (i < sizeof(url_ends)/sizeof(url_ends[0])) {
+                encoded[length++] = i;
+                url_str += n;
+                continue;
+            }
+        }
+
+        encoded[length++] = *url_str++;
+    }
+
+    return length;
+}
+
+// Encode a frame as Eddystone service data
+static void eddystone_frame_compile(multi_adv_payload_t* payload,
+                                    uint8_t* frame,
+                                    uint8_t frame_length,
+                                    const ble_advdata_t* scan_response_data) {
     // Physical web service
     ble_advdata_service_data_t service_data;
     service_data.service_uuid   = PHYSWEB_SERVICE_ID;
-    service_data.data.p_data    = m_url_frame;
-    service_data.data.size      = url_frame_length;
+    service_data.data.p_data    = frame;
+    service_data.data.size      = frame_length;
 
-    // Build and set advertising data
+    // Build and encode advertising data
     ble_advdata_t advdata;
     memset(&advdata, 0, sizeof(advdata));
     advdata.flags                   = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
@@ -60,9 +114,113 @@ void eddystone_adv(char* url_str, const ble_advdata_t* scan_response_data) {
     advdata.service_data_count      = 1;
     advdata.uuids_complete          = PHYSWEB_SERVICE_LIST;
 
+    multi_adv_compile(payload, &advdata, scan_response_data);
+}
+
+// Find the Eddystone frame in an encoded payload
+static uint8_t* eddystone_frame_get(multi_adv_payload_t* payload) {
+    uint8_t i = 0;
+
+    while (i + 3 < payload->adv_len) {
+        if (payload->adv_data[i+1] == BLE_GAP_AD_TYPE_SERVICE_DATA &&
+                payload->adv_data[i+2] == (PHYSWEB_SERVICE_ID & 0xFF) &&
+                payload->adv_data[i+3] == (PHYSWEB_SERVICE_ID >> 8)) {
+            return &payload->adv_data[i+4];
+        }
+        i += payload->adv_data[i] + 1;
+    }
+
+    return NULL;
+}
+
+// Eddystone fields are big endian
+static void uint16_big_put(uint8_t* p, uint16_t value) {
+    p[0] = value >> 8;
+    p[1] = value;
+}
+
+static void uint32_big_put(uint8_t* p, uint32_t value) {
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+void eddystone_url_compile(multi_adv_payload_t* payload,
+                           char* url_str,
+                           const ble_advdata_t* scan_response_data) {
+    // Physical Web data
+    uint8_t m_url_frame[2 + 1 + PHYSWEB_URL_MAX_LEN];
+    uint8_t url_length = eddystone_url_encode(&m_url_frame[2], url_str);
+    if (url_length == 0) {
+        APP_ERROR_CHECK(NRF_ERROR_DATA_SIZE);
+        return;
+    }
+    m_url_frame[0] = PHYSWEB_URL_TYPE;
+    m_url_frame[1] = PHYSWEB_TX_POWER;
+
+    eddystone_frame_compile(payload, m_url_frame, 2 + url_length, scan_response_data);
+}
+
+void eddystone_uid_compile(multi_adv_payload_t* payload,
+                           const uint8_t* namespace_id,
+                           const uint8_t* instance_id,
+                           const ble_advdata_t* scan_response_data) {
+    uint8_t m_uid_frame[PHYSWEB_UID_FRAME_LEN];
+
+    m_uid_frame[0] = PHYSWEB_UID_TYPE;
+    m_uid_frame[1] = PHYSWEB_TX_POWER;
+    memcpy(&m_uid_frame[2], namespace_id, PHYSWEB_UID_NAMESPACE_LEN);
+    memcpy(&m_uid_frame[2 + PHYSWEB_UID_NAMESPACE_LEN], instance_id, PHYSWEB_UID_INSTANCE_LEN);
+    // Reserved
+    m_uid_frame[18] = 0;
+    m_uid_frame[19] = 0;
+
+    eddystone_frame_compile(payload, m_uid_frame, sizeof(m_uid_frame), scan_response_data);
+}
+
+void eddystone_tlm_compile(multi_adv_payload_t* payload,
+                           const ble_advdata_t* scan_response_data) {
+    uint8_t m_tlm_frame[PHYSWEB_TLM_FRAME_LEN];
+
+    memset(m_tlm_frame, 0, sizeof(m_tlm_frame));
+    m_tlm_frame[0] = PHYSWEB_TLM_TYPE;
+    m_tlm_frame[1] = PHYSWEB_TLM_VERSION;
+    // Battery voltage 0 and this temperature mean not supported, until the
+    // first eddystone_tlm_update()
+    uint16_big_put(&m_tlm_frame[4], PHYSWEB_TLM_TEMP_UNKNOWN);
+
+    eddystone_frame_compile(payload, m_tlm_frame, sizeof(m_tlm_frame), scan_response_data);
+}
+
+// Patch the telemetry fields of a compiled TLM payload in place. battery_mv
+// is in mV, temperature in 1/256 degrees C, adv_count the number of
+// advertisements sent and uptime in 0.1 s since power on. Sent with the
+// payload's next multi_adv_set(), or the next rotation to it.
+void eddystone_tlm_update(multi_adv_payload_t* payload,
+                          uint16_t battery_mv,
+                          int16_t temperature,
+                          uint32_t adv_count,
+                          uint32_t uptime) {
+    uint8_t* frame = eddystone_frame_get(payload);
+    if (frame == NULL || frame[0] != PHYSWEB_TLM_TYPE) {
+        APP_ERROR_CHECK(NRF_ERROR_INVALID_PARAM);
+        return;
+    }
+
+    uint16_big_put(&frame[2], battery_mv);
+    uint16_big_put(&frame[4], (uint16_t)temperature);
+    uint32_big_put(&frame[6], adv_count);
+    uint32_big_put(&frame[10], uptime);
+}
+
+void eddystone_adv(char* url_str, const ble_advdata_t* scan_response_data) {
+    multi_adv_payload_t payload;
+
+    eddystone_url_compile(&payload, url_str, scan_response_data);
+
     // Actually set advertisement data
-    err_code = ble_advdata_set(&advdata, scan_response_data);
-    APP_ERROR_CHECK(err_code);
+    multi_adv_set(&payload);
 
     // Start the advertisement
     advertising_start();
@@ -1,25 +1,52 @@
 #ifndef __EDDYSTONE_H
 #define __EDDYSTONE_H
 
+#include "multi_adv.h"
+
 // Functions
 void eddystone_adv(char*, const ble_advdata_t*);
+void eddystone_url_compile(multi_adv_payload_t*, char*, const ble_advdata_t*);
+void eddystone_uid_compile(multi_adv_payload_t*, const uint8_t*, const uint8_t*, const ble_advdata_t*);
+void eddystone_tlm_compile(multi_adv_payload_t*, const ble_advdata_t*);
+void eddystone_tlm_update(multi_adv_payload_t*, uint16_t, int16_t, uint32_t, uint32_t);
+uint8_t eddystone_url_encode(uint8_t*, const char*);
 
 // Physical Web
 #define PHYSWEB_SERVICE_ID  0xFEAA
+#define PHYSWEB_UID_TYPE    0x00    // Denotes UIDs
 #define PHYSWEB_URL_TYPE    0x10    // Denotes URLs (vs URIs or TLM data)
+#define PHYSWEB_TLM_TYPE    0x20    // Denotes TLM data
 #define PHYSWEB_TX_POWER    0xBA    // Tx Power. Measured at 1 m plus 41 dBm. (who cares)
 
+#define PHYSWEB_URL_MAX_LEN         17      // Encoded URL, not counting the scheme
+
+#define PHYSWEB_UID_NAMESPACE_LEN   10
+#define PHYSWEB_UID_INSTANCE_LEN    6
+#define PHYSWEB_UID_FRAME_LEN       20
+
+#define PHYSWEB_TLM_VERSION         0x00    // Unencrypted TLM
+#define PHYSWEB_TLM_FRAME_LEN       14
+#define PHYSWEB_TLM_TEMP_UNKNOWN    0x8000
+
 #define PHYSWEB_URLSCHEME_HTTPWWW   0x00    // http://www.
 #define PHYSWEB_URLSCHEME_HTTPSWWW  0x01    // https://www.
 #define PHYSWEB_URLSCHEME_HTTP      0x02    // http://
 #define PHYSWEB_URLSCHEME_HTTPS     0x03    // https://
 
-#define PHYSWEB_URLEND_COMSLASH 0x00    // .com/
-#define PHYSWEB_URLEND_ORGSLASH 0x01    // .org/
-#define PHYSWEB_URLEND_EDUSLASH 0x02    // .edu/
-#define PHYSWEB_URLEND_COM      0x07    // .com
-#define PHYSWEB_URLEND_ORG      0x08    // .org
-#define PHYSWEB_URLEND_EDU      0x09    // .edu
+#define PHYSWEB_URLEND_COMSLASH     0x00    // .com/
+#define PHYSWEB_URLEND_ORGSLASH     0x01    // .org/
+#define PHYSWEB_URLEND_EDUSLASH     0x02    // .edu/
+#define PHYSWEB_URLEND_NETSLASH     0x03    // .net/
+#define PHYSWEB_URLEND_INFOSLASH    0x04    // .info/
+#define PHYSWEB_URLEND_BIZSLASH     0x05    // .biz/
+#define PHYSWEB_URLEND_GOVSLASH     0x06    // .gov/
+#define PHYSWEB_URLEND_COM          0x07    // .com
+#define PHYSWEB_URLEND_ORG          0x08    // .org
+#define PHYSWEB_URLEND_EDU          0x09    // .edu
+#define PHYSWEB_URLEND_NET          0x0A    // .net
+#define PHYSWEB_URLEND_INFO         0x0B    // .info
+#define PHYSWEB_URLEND_BIZ          0x0C    // .biz
+#define PHYSWEB_URLEND_GOV          0x0D    // .gov
 
 
 #endif
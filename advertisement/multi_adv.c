@@ -0,0 +1,44 @@
+/*
+ * Advertising payloads encoded once and handed to the softdevice as is.
+ *
+ * Each advertisement is encoded into a payload with multi_adv_compile(), and
+ * multi_adv_set() only passes the stored bytes to the softdevice. See
+ * multi_adv_rotate.c to rotate between several payloads.
+ */
+
+// Standard Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Nordic Libraries
+#include "nordic_common.h"
+#include "ble.h"
+#include "ble_advdata.h"
+#include "app_error.h"
+
+// Platform, Peripherals, Devices, Services
+#include "multi_adv.h"
+
+// Encode advertising and scan response data into a payload. srdata may be
+// NULL, in which case the payload has an empty scan response.
+void multi_adv_compile(multi_adv_payload_t* payload,
+                       const ble_advdata_t* advdata,
+                       const ble_advdata_t* srdata) {
+    uint32_t err_code;
+
+    err_code = ble_advdata_encode(advdata, srdata,
+                                  payload->adv_data, &payload->adv_len,
+                                  payload->sr_data, &payload->sr_len);
+    APP_ERROR_CHECK(err_code);
+}
+
+// Give a payload to the softdevice. Takes effect at the next advertising
+// event, so it can be called while advertising.
+void multi_adv_set(const multi_adv_payload_t* payload) {
+    uint32_t err_code;
+
+    err_code = sd_ble_gap_adv_data_set(payload->adv_data, payload->adv_len,
+                                       payload->sr_data, payload->sr_len);
+    APP_ERROR_CHECK(err_code);
+}
@@ -0,0 +1,22 @@
+#ifndef __MULTI_ADV_H
+#define __MULTI_ADV_H
+
+#include "ble_gap.h"
+#include "ble_advdata.h"
+
+// Advertising and scan response data, encoded once and sent to the
+// softdevice as is
+typedef struct multi_adv_payload_s {
+    uint8_t adv_data[BLE_GAP_ADV_MAX_SIZE];
+    uint8_t adv_len;
+    uint8_t sr_data[BLE_GAP_ADV_MAX_SIZE];
+    uint8_t sr_len;
+} multi_adv_payload_t;
+
+// Functions
+void multi_adv_compile(multi_adv_payload_t* payload,
+                       const ble_advdata_t* advdata,
+                       const ble_advdata_t* srdata);
+void multi_adv_set(const multi_adv_payload_t* payload);
+
+#endif
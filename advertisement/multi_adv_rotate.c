@@ -0,0 +1,100 @@
+/*
+ * Rotate between several advertisements.
+ *
+ * The payloads are compiled with multi_adv_compile(). The rotation then only
+ * hands the stored bytes to the softdevice, from the radio notification
+ * interrupt at the end of an advertising event.
+ *
+ * Add multi_adv_rotate.c and ble_radio_notification.c to APPLICATION_SRCS
+ * when using the rotation.
+ */
+
+// Standard Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Nordic Libraries
+#include "nordic_common.h"
+#include "nrf_soc.h"
+#include "ble.h"
+#include "ble_radio_notification.h"
+#include "app_error.h"
+
+// Platform, Peripherals, Devices, Services
+#include "simple_ble.h"
+#include "multi_adv.h"
+#include "multi_adv_rotate.h"
+
+static const multi_adv_payload_t* slots[MULTI_ADV_MAX_SLOTS];
+static uint8_t slot_count = 0;
+static uint8_t slot_current = 0;
+
+// Number of advertising events each payload is sent for
+static uint8_t events_per_slot = 1;
+static uint8_t event_count = 0;
+
+static volatile bool rotating = false;
+
+// Called when the radio starts and stops. The payload is changed when the
+// radio stops, so the next advertising event sends the next payload.
+// Connection events are counted too.
+static void radio_notification_handler(bool radio_active) {
+    if (radio_active || !rotating) {
+        return;
+    }
+
+    event_count++;
+    if (event_count < events_per_slot) {
+        return;
+    }
+    event_count = 0;
+
+    slot_current++;
+    if (slot_current >= slot_count) {
+        slot_current = 0;
+    }
+    multi_adv_set(slots[slot_current]);
+}
+
+// Must be called after the softdevice is enabled, and only once
+void multi_adv_init(uint8_t events) {
+    uint32_t err_code;
+
+    events_per_slot = MAX(events, 1);
+    slot_count = 0;
+
+    err_code = ble_radio_notification_init(NRF_APP_PRIORITY_LOW,
+                                           NRF_RADIO_NOTIFICATION_DISTANCE_800US,
+                                           radio_notification_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+// Add a payload to the rotation. The payload is not copied and must stay
+// valid while rotating.
+void multi_adv_add(const multi_adv_payload_t* payload) {
+    if (slot_count >= MULTI_ADV_MAX_SLOTS) {
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+        return;
+    }
+
+    slots[slot_count++] = payload;
+}
+
+void multi_adv_start(void) {
+    if (slot_count == 0) {
+        return;
+    }
+
+    slot_current = 0;
+    event_count = 0;
+    multi_adv_set(slots[0]);
+
+    rotating = (slot_count > 1);
+    advertising_start();
+}
+
+void multi_adv_stop(void) {
+    rotating = false;
+    advertising_stop();
+}
@@ -0,0 +1,17 @@
+#ifndef __MULTI_ADV_ROTATE_H
+#define __MULTI_ADV_ROTATE_H
+
+#include "multi_adv.h"
+
+// Maximum number of payloads in the rotation
+#ifndef MULTI_ADV_MAX_SLOTS
+#define MULTI_ADV_MAX_SLOTS 4
+#endif
+
+// Functions
+void multi_adv_init(uint8_t events_per_slot);
+void multi_adv_add(const multi_adv_payload_t* payload);
+void multi_adv_start(void);
+void multi_adv_stop(void);
+
+#endif
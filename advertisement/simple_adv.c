@@ -27,32 +27,27 @@
 
 // Platform, Peripherals, Devices, Services
 #include "simple_ble.h"
+#include "multi_adv.h"
 #include "simple_adv.h"
 
-void simple_adv_only_name () {
-    uint32_t      err_code;
+void simple_adv_only_name_compile (multi_adv_payload_t* payload) {
     ble_advdata_t advdata;
 
-    // Build and set advertising data
+    // Build and encode advertising data
     memset(&advdata, 0, sizeof(advdata));
 
     advdata.name_type          = BLE_ADVDATA_FULL_NAME;
     advdata.include_appearance = true;
     advdata.flags              = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
 
-    err_code = ble_advdata_set(&advdata, NULL);
-    APP_ERROR_CHECK(err_code);
-
-    // Start the advertisement
-    advertising_start();
+    multi_adv_compile(payload, &advdata, NULL);
 }
 
-void simple_adv_service (ble_uuid_t* service_uuid) {
-    uint32_t      err_code;
+void simple_adv_service_compile (multi_adv_payload_t* payload, ble_uuid_t* service_uuid) {
     ble_advdata_t advdata;
     ble_advdata_t srdata;
 
-    // Build and set advertising data
+    // Build and encode advertising data
     memset(&advdata, 0, sizeof(advdata));
     memset(&srdata, 0, sizeof(srdata));
 
@@ -65,8 +60,24 @@ void simple_adv_service (ble_uuid_t* service_uuid) {
     // Put the name in the SCAN RESPONSE data
     srdata.name_type                = BLE_ADVDATA_FULL_NAME;
 
-    err_code = ble_advdata_set(&advdata, &srdata);
-    APP_ERROR_CHECK(err_code);
+    multi_adv_compile(payload, &advdata, &srdata);
+}
+
+void simple_adv_only_name () {
+    multi_adv_payload_t payload;
+
+    simple_adv_only_name_compile(&payload);
+    multi_adv_set(&payload);
+
+    // Start the advertisement
+    advertising_start();
+}
+
+void simple_adv_service (ble_uuid_t* service_uuid) {
+    multi_adv_payload_t payload;
+
+    simple_adv_service_compile(&payload, service_uuid);
+    multi_adv_set(&payload);
 
     // Start the advertisement
     advertising_start();
@@ -1,8 +1,12 @@
 #ifndef __SIMPLE_ADV_H
 #define __SIMPLE_ADV_H
 
+#include "multi_adv.h"
+
 // Functions
 void simple_adv_only_name ();
 void simple_adv_service (ble_uuid_t* service_uuid);
+void simple_adv_only_name_compile (multi_adv_payload_t* payload);
+void simple_adv_service_compile (multi_adv_payload_t* payload, ble_uuid_t* service_uuid);
 
 #endif
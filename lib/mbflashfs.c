@@ -0,0 +1,964 @@
+// Most Basic Flash Filesystem
+//
+// Log-structured filesystem in internal flash, with the same stdio functions
+// as mbramfs.c. Build this file (and crc16.c) instead of mbramfs.c when the
+// files must survive a reset.
+//
+// Every change is appended to a log as a record, and a record is only valid
+// when the CRC in its last word matches. The filesystem is rebuilt at the
+// first fopen by scanning the log, so a record torn by a power cut is
+// ignored along with the rest of its page. Writes are buffered per handle and
+// flushed as one record, so flash is programmed in whole words. When the free
+// pages run low, the oldest page is garbage collected: its live records are
+// copied to the head of the log and the page is erased. Pages are reused in
+// log order, which levels wear across the filesystem.
+//
+// Flash is written with nrf_nvmc, so the filesystem must not be used while
+// the SoftDevice is enabled. Define MBFLASHFS_START_ADDR to keep it clear of
+// the bootloader and pstorage pages, by default it takes the last pages of
+// flash.
+
+
+#include "stdio.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "string.h"
+
+#include "nrf.h"
+#include "nrf_nvmc.h"
+#include "crc16.h"
+
+#include "mbflashfs.h"
+
+#ifndef MBFLASHFS_PAGE_COUNT
+#define MBFLASHFS_PAGE_COUNT 8     // flash pages used by the filesystem
+#endif
+#ifndef MBFLASHFS_PAGE_SIZE
+#define MBFLASHFS_PAGE_SIZE 1024   // nRF51 flash page size
+#endif
+#ifndef MBFLASHFS_MAX_FILES
+#define MBFLASHFS_MAX_FILES 8
+#endif
+#ifndef MBFLASHFS_MAX_HANDLES
+#define MBFLASHFS_MAX_HANDLES 4
+#endif
+#ifndef MBFLASHFS_NAME_LEN
+#define MBFLASHFS_NAME_LEN 16      // including the terminating null
+#endif
+#ifndef MBFLASHFS_WRITE_BUFFER_SIZE
+#define MBFLASHFS_WRITE_BUFFER_SIZE 128  // bytes buffered per handle, a multiple of 4
+#endif
+#ifndef MBFLASHFS_RESERVE_PAGES
+#define MBFLASHFS_RESERVE_PAGES 2  // erased pages kept for garbage collection, one more than a page of live data needs
+#endif
+#define MBFLASHFS_HASH_BUCKETS 8   // must be a power of two
+
+#if MBFLASHFS_WRITE_BUFFER_SIZE % 4 != 0
+#error "MBFLASHFS_WRITE_BUFFER_SIZE must be a multiple of 4"
+#endif
+#if MBFLASHFS_WRITE_BUFFER_SIZE + 20 > MBFLASHFS_PAGE_SIZE
+#error "A full write buffer must fit in one page"
+#endif
+
+#define MODE_READ   0x01
+#define MODE_WRITE  0x02
+#define MODE_APPEND 0x04
+
+// Page layout: magic, sequence number, records
+#define PAGE_MAGIC 0x5346424D      // "MBFS"
+#define PAGE_HEADER_SIZE 8
+#define PAGE_NONE 0xFF
+
+// Record layout: type/file/length, file offset, payload padded to words, CRC
+#define RECORD_HEADER_SIZE 8
+#define RECORD_TRAILER_SIZE 4
+#define RECORD_TRAILER_MARK 0x5AA50000
+#define RECORD_CREATE 1            // payload is the file name
+#define RECORD_DATA   2            // payload is file data at the given offset
+#define RECORD_DELETE 3            // no payload, earlier records of the file are dead
+
+#define ERASED_WORD 0xFFFFFFFF
+#define WORD_ALIGN(len) (((len) + 3) & ~3)
+
+typedef struct {
+	char name[MBFLASHFS_NAME_LEN];
+	uint32_t size;
+	uint32_t valid_from;       // log position of the first record of this file that counts
+	int8_t next;               // next file in the same hash bucket, -1 at the end
+	uint8_t in_use;
+} mbflashfs_file_t;
+
+// The FILE pointers given to the application point to these
+typedef struct {
+	int8_t file;               // index into files, -1 if the file was removed
+	uint8_t in_use;
+	uint8_t mode;
+	uint32_t pos;
+	uint32_t buf_offset;       // file offset of the buffered data
+	uint32_t buf_len;
+	uint32_t buf[MBFLASHFS_WRITE_BUFFER_SIZE / 4];
+} mbflashfs_handle_t;
+
+// Walks the records of the log in the order they were written
+typedef struct {
+	uint8_t order[MBFLASHFS_PAGE_COUNT];
+	uint8_t page_count;
+	uint8_t index;
+	uint32_t offset;           // offset of the next record in the current page
+	// the current record
+	uint32_t addr;
+	uint32_t pos;
+	uint8_t type;
+	uint8_t file;
+	uint16_t len;
+	uint32_t file_offset;
+} log_iter_t;
+
+static bool mounted = false;
+static uint32_t base_addr;
+static uint32_t page_seq[MBFLASHFS_PAGE_COUNT];  // 0 for erased pages
+static uint32_t page_checked[MBFLASHFS_PAGE_COUNT];  // records below this offset passed their CRC
+static uint32_t next_seq;
+static uint8_t head_page;
+static uint32_t head_offset;
+static bool gc_active = false;
+static bool use_reserve = false;  // set while deleting, so a full log can be emptied
+
+static mbflashfs_file_t files[MBFLASHFS_MAX_FILES];
+static mbflashfs_handle_t handles[MBFLASHFS_MAX_HANDLES];
+static int8_t buckets[MBFLASHFS_HASH_BUCKETS];
+static uint32_t gc_buf[MBFLASHFS_WRITE_BUFFER_SIZE / 4];
+static mbflashfs_stats_t stats;
+
+
+static uint32_t flash_word (uint32_t addr) {
+	return *(const uint32_t*) (uintptr_t) addr;
+}
+
+static const uint8_t* flash_ptr (uint32_t addr) {
+	return (const uint8_t*) (uintptr_t) addr;
+}
+
+static uint32_t page_addr (uint8_t page) {
+	return base_addr + page*MBFLASHFS_PAGE_SIZE;
+}
+
+// Log position of an offset in a page. Positions grow with every page taken
+// into use, so they order records across pages.
+static uint32_t log_pos (uint8_t page, uint32_t offset) {
+	return page_seq[page]*MBFLASHFS_PAGE_SIZE + offset;
+}
+
+static void page_erase (uint8_t page) {
+	nrf_nvmc_page_erase(page_addr(page));
+	page_seq[page] = 0;
+	page_checked[page] = PAGE_HEADER_SIZE;
+}
+
+static uint8_t free_page_count (void) {
+	uint8_t count = 0;
+	uint8_t i;
+	for (i = 0; i < MBFLASHFS_PAGE_COUNT; i++) {
+		if (page_seq[i] == 0) {
+			count++;
+		}
+	}
+	return count;
+}
+
+
+/*******************************************************************************
+ *   LOG
+ ******************************************************************************/
+static bool record_valid (uint32_t addr, uint16_t len) {
+	uint16_t crc = crc16_compute(flash_ptr(addr), RECORD_HEADER_SIZE + len, NULL);
+	uint32_t trailer = flash_word(addr + RECORD_HEADER_SIZE + WORD_ALIGN(len));
+	return trailer == (RECORD_TRAILER_MARK | crc);
+}
+
+// Start walking the log. With only_page set, only that page is walked.
+static void log_iter_init (log_iter_t* it, uint8_t only_page) {
+	uint8_t i, j;
+
+	it->page_count = 0;
+	for (i = 0; i < MBFLASHFS_PAGE_COUNT; i++) {
+		if (page_seq[i] == 0 || (only_page != PAGE_NONE && i != only_page)) {
+			continue;
+		}
+		// insertion sort on sequence number
+		for (j = it->page_count; j > 0 && page_seq[it->order[j-1]] > page_seq[i]; j--) {
+			it->order[j] = it->order[j-1];
+		}
+		it->order[j] = i;
+		it->page_count++;
+	}
+	it->index = 0;
+	it->offset = PAGE_HEADER_SIZE;
+}
+
+// Step to the next valid record. An invalid record ends its page, since
+// nothing after it was written. The CRC of a record is only computed the
+// first time it is walked, later walks trust it.
+static bool log_iter_next (log_iter_t* it) {
+	while (it->index < it->page_count) {
+		uint8_t page = it->order[it->index];
+		uint32_t addr = page_addr(page) + it->offset;
+
+		if (it->offset + RECORD_HEADER_SIZE + RECORD_TRAILER_SIZE <= MBFLASHFS_PAGE_SIZE) {
+			uint32_t header = flash_word(addr);
+			uint16_t len = header & 0xFFFF;
+			uint32_t size = RECORD_HEADER_SIZE + WORD_ALIGN(len) + RECORD_TRAILER_SIZE;
+
+			if (header != ERASED_WORD && it->offset + size <= MBFLASHFS_PAGE_SIZE &&
+					(it->offset < page_checked[page] || record_valid(addr, len))) {
+				if (it->offset + size > page_checked[page]) {
+					page_checked[page] = it->offset + size;
+				}
+				it->addr = addr;
+				it->pos = log_pos(page, it->offset);
+				it->type = header >> 24;
+				it->file = (header >> 16) & 0xFF;
+				it->len = len;
+				it->file_offset = flash_word(addr + 4);
+				it->offset += size;
+				return true;
+			}
+		}
+
+		it->index++;
+		it->offset = PAGE_HEADER_SIZE;
+	}
+	return false;
+}
+
+static void write_words (uint32_t addr, const uint8_t* data, uint32_t len) {
+	uint32_t i;
+	for (i = 0; i < len; i += 4) {
+		uint32_t word = ERASED_WORD;
+		memcpy(&word, data + i, (len - i < 4) ? len - i : 4);
+		nrf_nvmc_write_word(addr + i, word);
+	}
+}
+
+static int gc_page (bool use_margin);
+
+// Start a new head page. Normal writes leave the reserve pages for the
+// garbage collector, and collect the oldest page to free one up.
+static int log_new_page (void) {
+	uint8_t attempts = 0;
+	uint8_t page;
+
+	while (!gc_active && free_page_count() <= MBFLASHFS_RESERVE_PAGES) {
+		if (attempts++ == MBFLASHFS_PAGE_COUNT || gc_page(false) != 0) {
+			// a delete may still dip into the reserve, but never takes the
+			// last erased page, which garbage collection needs
+			if (!use_reserve || free_page_count() <= 1) {
+				return -1;
+			}
+			break;
+		}
+	}
+
+	// take the first erased page after the head, so pages are used in turn
+	for (page = 0; page < MBFLASHFS_PAGE_COUNT; page++) {
+		uint8_t candidate = (head_page == PAGE_NONE) ? page : (head_page + 1 + page) % MBFLASHFS_PAGE_COUNT;
+		if (page_seq[candidate] == 0) {
+			break;
+		}
+	}
+	if (page == MBFLASHFS_PAGE_COUNT) {
+		return -1;
+	}
+	page = (head_page == PAGE_NONE) ? page : (head_page + 1 + page) % MBFLASHFS_PAGE_COUNT;
+
+	// the magic goes last, so a page with a torn sequence number is not used
+	nrf_nvmc_write_word(page_addr(page) + 4, next_seq);
+	nrf_nvmc_write_word(page_addr(page), PAGE_MAGIC);
+	stats.flash_bytes += PAGE_HEADER_SIZE;
+
+	page_seq[page] = next_seq++;
+	page_checked[page] = PAGE_HEADER_SIZE;
+	head_page = page;
+	head_offset = PAGE_HEADER_SIZE;
+	return 0;
+}
+
+// Append a record to the log. The CRC is written last, so a record cut short
+// by a reset is never taken as valid.
+static int log_append (uint8_t type, uint8_t file, uint32_t offset, const void* data, uint16_t len, uint32_t* pos) {
+	uint32_t size = RECORD_HEADER_SIZE + WORD_ALIGN(len) + RECORD_TRAILER_SIZE;
+	uint32_t header[2];
+	uint32_t addr;
+	uint16_t crc;
+
+	if (head_page == PAGE_NONE || head_offset + size > MBFLASHFS_PAGE_SIZE) {
+		if (log_new_page() != 0) {
+			return -1;
+		}
+	}
+
+	addr = page_addr(head_page) + head_offset;
+	header[0] = ((uint32_t) type << 24) | ((uint32_t) file << 16) | len;
+	header[1] = offset;
+	crc = crc16_compute((const uint8_t*) header, sizeof(header), NULL);
+	crc = crc16_compute(data, len, &crc);
+
+	write_words(addr, (const uint8_t*) header, sizeof(header));
+	write_words(addr + RECORD_HEADER_SIZE, data, len);
+	nrf_nvmc_write_word(addr + RECORD_HEADER_SIZE + WORD_ALIGN(len), RECORD_TRAILER_MARK | crc);
+
+	if (pos != NULL) {
+		*pos = log_pos(head_page, head_offset);
+	}
+	head_offset += size;
+	page_checked[head_page] = head_offset;
+	stats.flash_bytes += size;
+	return 0;
+}
+
+
+/*******************************************************************************
+ *   FILES
+ ******************************************************************************/
+// FNV-1a hash of the file name
+static uint32_t name_hash (const char* name) {
+	uint32_t hash = 2166136261u;
+	while (*name) {
+		hash = (hash ^ (uint8_t) *name++) * 16777619u;
+	}
+	return hash & (MBFLASHFS_HASH_BUCKETS - 1);
+}
+
+static void bucket_insert (int8_t file) {
+	uint32_t bucket = name_hash(files[file].name);
+	files[file].next = buckets[bucket];
+	buckets[bucket] = file;
+}
+
+static void bucket_remove (int8_t file) {
+	int8_t* link = &buckets[name_hash(files[file].name)];
+	while (*link != file) {
+		link = &files[*link].next;
+	}
+	*link = files[file].next;
+}
+
+static int8_t file_find (const char* name) {
+	int8_t i = buckets[name_hash(name)];
+	while (i >= 0 && strcmp(files[i].name, name) != 0) {
+		i = files[i].next;
+	}
+	return i;
+}
+
+// Move handles positioned past the end of a file back to the end
+static void file_handles_clamp (int8_t file) {
+	uint8_t i;
+	for (i = 0; i < MBFLASHFS_MAX_HANDLES; i++) {
+		if (handles[i].in_use && handles[i].file == file && handles[i].pos > files[file].size) {
+			handles[i].pos = files[file].size;
+		}
+	}
+}
+
+static int8_t file_create (const char* name) {
+	int8_t i;
+
+	if (strlen(name) >= MBFLASHFS_NAME_LEN) {
+		return -1;
+	}
+	for (i = 0; i < MBFLASHFS_MAX_FILES && files[i].in_use; i++);
+	if (i == MBFLASHFS_MAX_FILES) {
+		return -1;
+	}
+	if (log_append(RECORD_CREATE, i, 0, name, strlen(name) + 1, NULL) != 0) {
+		return -1;
+	}
+
+	strcpy(files[i].name, name);
+	files[i].in_use = 1;
+	files[i].size = 0;
+	file_handles_clamp(i);
+	bucket_insert(i);
+	return i;
+}
+
+static int file_delete (int8_t file) {
+	uint32_t pos;
+	int result;
+	uint8_t i;
+
+	use_reserve = true;
+	result = log_append(RECORD_DELETE, file, 0, NULL, 0, &pos);
+	use_reserve = false;
+	if (result != 0) {
+		return -1;
+	}
+
+	bucket_remove(file);
+	files[file].in_use = 0;
+	files[file].size = 0;
+	files[file].valid_from = pos + 1;
+	file_handles_clamp(file);
+
+	for (i = 0; i < MBFLASHFS_MAX_HANDLES; i++) {
+		if (handles[i].in_use && handles[i].file == file) {
+			handles[i].file = -1;
+		}
+	}
+	return 0;
+}
+
+// Size of a file as recorded in the log, without buffered writes
+static uint32_t file_logged_size (int8_t file) {
+	log_iter_t it;
+	uint32_t size = 0;
+
+	log_iter_init(&it, PAGE_NONE);
+	while (log_iter_next(&it)) {
+		if (it.type == RECORD_DATA && it.file == file && it.pos >= files[file].valid_from &&
+				it.file_offset + it.len > size) {
+			size = it.file_offset + it.len;
+		}
+	}
+	return size;
+}
+
+// Write the buffered data of a handle to the log. If the log is full the
+// buffered data is dropped.
+static int handle_flush (mbflashfs_handle_t* h) {
+	if (h->buf_len == 0) {
+		return 0;
+	}
+	if (log_append(RECORD_DATA, h->file, h->buf_offset, h->buf, h->buf_len, NULL) != 0) {
+		uint8_t i;
+
+		h->buf_len = 0;
+		// the file ends with the log or with data still buffered by other handles
+		files[h->file].size = file_logged_size(h->file);
+		for (i = 0; i < MBFLASHFS_MAX_HANDLES; i++) {
+			if (handles[i].in_use && handles[i].file == h->file && handles[i].buf_len > 0 &&
+					handles[i].buf_offset + handles[i].buf_len > files[h->file].size) {
+				files[h->file].size = handles[i].buf_offset + handles[i].buf_len;
+			}
+		}
+		file_handles_clamp(h->file);
+		return -1;
+	}
+	h->buf_len = 0;
+	return 0;
+}
+
+static int file_flush (int8_t file) {
+	int result = 0;
+	uint8_t i;
+	for (i = 0; i < MBFLASHFS_MAX_HANDLES; i++) {
+		if (handles[i].in_use && handles[i].file == file && handle_flush(&handles[i]) != 0) {
+			result = -1;
+		}
+	}
+	return result;
+}
+
+// Copy file contents out of the log. Later records overwrite earlier ones.
+static void file_read (int8_t file, uint32_t offset, uint8_t* dst, uint32_t len) {
+	log_iter_t it;
+
+	memset(dst, 0, len);
+	log_iter_init(&it, PAGE_NONE);
+	while (log_iter_next(&it)) {
+		if (it.type == RECORD_DATA && it.file == file && it.pos >= files[file].valid_from &&
+				it.file_offset < offset + len && it.file_offset + it.len > offset) {
+			uint32_t start = (it.file_offset > offset) ? it.file_offset : offset;
+			uint32_t end = (it.file_offset + it.len < offset + len) ? it.file_offset + it.len : offset + len;
+			memcpy(dst + (start - offset), flash_ptr(it.addr + RECORD_HEADER_SIZE) + (start - it.file_offset), end - start);
+		}
+	}
+}
+
+// A data record is dead if a later record of the same file covers all of it.
+// Only the log after the record is walked.
+static bool record_shadowed (const log_iter_t* record) {
+	log_iter_t it;
+	uint8_t page = record->order[record->index];
+
+	log_iter_init(&it, PAGE_NONE);
+	while (it.order[it.index] != page) {
+		it.index++;
+	}
+	it.offset = record->offset;
+	while (log_iter_next(&it)) {
+		if (it.type == RECORD_DATA && it.file == record->file &&
+				it.file_offset <= record->file_offset &&
+				it.file_offset + it.len >= record->file_offset + record->len) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Where the records of a planned garbage collection would go
+typedef struct {
+	uint32_t offset;           // head offset after the planned records
+	uint8_t pages;             // pages the planned records would start
+} gc_plan_t;
+
+static void gc_plan_record (gc_plan_t* plan, uint16_t len) {
+	uint32_t size = RECORD_HEADER_SIZE + WORD_ALIGN(len) + RECORD_TRAILER_SIZE;
+	if (plan->offset + size > MBFLASHFS_PAGE_SIZE) {
+		plan->pages++;
+		plan->offset = PAGE_HEADER_SIZE;
+	}
+	plan->offset += size;
+}
+
+// Copy the current contents of a file range to the head of the log, so
+// overwritten parts are resolved. With a plan, only place the records.
+static int gc_copy (int8_t file, uint32_t offset, uint32_t end, gc_plan_t* plan) {
+	while (offset < end) {
+		uint32_t chunk = (end - offset < sizeof(gc_buf)) ? end - offset : sizeof(gc_buf);
+		if (plan != NULL) {
+			gc_plan_record(plan, chunk);
+		} else {
+			file_read(file, offset, (uint8_t*) gc_buf, chunk);
+			if (log_append(RECORD_DATA, file, offset, gc_buf, chunk, NULL) != 0) {
+				return -1;
+			}
+		}
+		offset += chunk;
+	}
+	return 0;
+}
+
+// Copy the live records of a page to the head of the log, or with a plan
+// only place them. Live data records that follow each other in the file are
+// merged, so small appends are compacted into full records.
+static int gc_copy_page (uint8_t page, gc_plan_t* plan) {
+	log_iter_t it;
+	int result = 0;
+	int8_t run_file = -1;
+	uint32_t run_start = 0;
+	uint32_t run_end = 0;
+
+	log_iter_init(&it, page);
+	while (result == 0 && log_iter_next(&it)) {
+		mbflashfs_file_t* f;
+		uint32_t end;
+
+		if (it.file >= MBFLASHFS_MAX_FILES) {
+			continue;
+		}
+		f = &files[it.file];
+		if (!f->in_use || it.pos < f->valid_from) {
+			continue;
+		}
+
+		if (it.type == RECORD_CREATE) {
+			uint16_t len = strlen(f->name) + 1;
+			if (plan != NULL) {
+				gc_plan_record(plan, len);
+			} else {
+				result = log_append(RECORD_CREATE, it.file, 0, f->name, len, NULL);
+			}
+		} else if (it.type == RECORD_DATA && it.file_offset < f->size && !record_shadowed(&it)) {
+			end = (it.file_offset + it.len < f->size) ? it.file_offset + it.len : f->size;
+			if (run_file == it.file && it.file_offset == run_end) {
+				run_end = end;
+				continue;
+			}
+			if (run_file >= 0) {
+				result = gc_copy(run_file, run_start, run_end, plan);
+			}
+			run_file = it.file;
+			run_start = it.file_offset;
+			run_end = end;
+		}
+	}
+	if (result == 0 && run_file >= 0) {
+		result = gc_copy(run_file, run_start, run_end, plan);
+	}
+	return result;
+}
+
+// Move the live records of the oldest page to the head, then erase it. The
+// page is left alone if its live records do not fit in the free pages. One
+// erased page is kept back unless use_margin is set, so a collection cut
+// short by a reset can always be finished at the next mount.
+static int gc_page (bool use_margin) {
+	gc_plan_t plan;
+	uint8_t oldest = PAGE_NONE;
+	uint8_t i;
+	int result;
+
+	for (i = 0; i < MBFLASHFS_PAGE_COUNT; i++) {
+		if (page_seq[i] != 0 && i != head_page && (oldest == PAGE_NONE || page_seq[i] < page_seq[oldest])) {
+			oldest = i;
+		}
+	}
+	if (oldest == PAGE_NONE) {
+		return -1;
+	}
+
+	plan.offset = (head_page == PAGE_NONE) ? MBFLASHFS_PAGE_SIZE : head_offset;
+	plan.pages = 0;
+	gc_copy_page(oldest, &plan);
+	if (plan.pages + (use_margin ? 0 : 1) > free_page_count()) {
+		return -1;
+	}
+
+	gc_active = true;
+	result = gc_copy_page(oldest, NULL);
+	gc_active = false;
+
+	if (result != 0) {
+		return -1;
+	}
+	page_erase(oldest);
+	stats.page_erases++;
+	return 0;
+}
+
+// Rebuild the file table from the log. Replaying the log checks the CRC of
+// every record once.
+static void fs_mount (void) {
+	log_iter_t it;
+	uint8_t i;
+	uint32_t max_seq = 0;
+
+#ifdef MBFLASHFS_START_ADDR
+	base_addr = MBFLASHFS_START_ADDR;
+#else
+	base_addr = (NRF_FICR->CODESIZE - MBFLASHFS_PAGE_COUNT) * NRF_FICR->CODEPAGESIZE;
+#endif
+
+	memset(files, 0, sizeof(files));
+	memset(handles, 0, sizeof(handles));
+	memset(buckets, -1, sizeof(buckets));
+	head_page = PAGE_NONE;
+	gc_active = false;
+
+	for (i = 0; i < MBFLASHFS_PAGE_COUNT; i++) {
+		uint32_t magic = flash_word(page_addr(i));
+		uint32_t seq = flash_word(page_addr(i) + 4);
+
+		page_checked[i] = PAGE_HEADER_SIZE;
+		if (magic == PAGE_MAGIC && seq != ERASED_WORD && seq != 0) {
+			page_seq[i] = seq;
+			if (seq > max_seq) {
+				max_seq = seq;
+				head_page = i;
+			}
+		} else {
+			// erased, or cut short while being erased or started
+			uint32_t offset;
+			page_seq[i] = 0;
+			for (offset = 0; offset < MBFLASHFS_PAGE_SIZE; offset += 4) {
+				if (flash_word(page_addr(i) + offset) != ERASED_WORD) {
+					nrf_nvmc_page_erase(page_addr(i));
+					break;
+				}
+			}
+		}
+	}
+	next_seq = max_seq + 1;
+
+	// replay the log
+	head_offset = PAGE_HEADER_SIZE;
+	log_iter_init(&it, PAGE_NONE);
+	while (log_iter_next(&it)) {
+		mbflashfs_file_t* f;
+
+		if (it.file >= MBFLASHFS_MAX_FILES) {
+			continue;
+		}
+		f = &files[it.file];
+		if (it.type == RECORD_CREATE && it.len <= MBFLASHFS_NAME_LEN) {
+			memcpy(f->name, flash_ptr(it.addr + RECORD_HEADER_SIZE), it.len);
+			f->name[MBFLASHFS_NAME_LEN - 1] = '\0';
+			f->in_use = 1;
+		} else if (it.type == RECORD_DATA && it.file_offset + it.len > f->size) {
+			f->size = it.file_offset + it.len;
+		} else if (it.type == RECORD_DELETE) {
+			f->in_use = 0;
+			f->size = 0;
+			f->valid_from = it.pos + 1;
+		}
+		if (it.order[it.index] == head_page) {
+			head_offset = it.offset;
+		}
+	}
+
+	// appending after a torn record would hide the new records
+	if (head_page != PAGE_NONE) {
+		uint32_t addr = page_addr(head_page) + head_offset;
+		if (head_offset < MBFLASHFS_PAGE_SIZE && flash_word(addr) != ERASED_WORD) {
+			head_offset = MBFLASHFS_PAGE_SIZE;
+		}
+	}
+
+	for (i = 0; i < MBFLASHFS_MAX_FILES; i++) {
+		if (files[i].in_use) {
+			bucket_insert(i);
+		} else {
+			files[i].size = 0;
+			file_handles_clamp(i);
+		}
+	}
+
+	// normal writes never take the reserve pages, so a collection was cut short
+	while (free_page_count() < MBFLASHFS_RESERVE_PAGES && gc_page(true) == 0);
+	mounted = true;
+}
+
+static mbflashfs_handle_t* handle_get (FILE* stream) {
+	mbflashfs_handle_t* h = (mbflashfs_handle_t*) stream;
+	if (h < handles || h >= handles + MBFLASHFS_MAX_HANDLES || !h->in_use || h->file < 0) {
+		return NULL;
+	}
+	return h;
+}
+
+
+/*******************************************************************************
+ *   STDIO
+ ******************************************************************************/
+FILE* fopen (const char* restrict fname, const char* restrict flags) {
+	uint8_t mode;
+	int8_t file;
+	uint8_t i;
+
+	if (!mounted) {
+		fs_mount();
+	}
+
+	switch (flags[0]) {
+		case 'r': mode = MODE_READ; break;
+		case 'w': mode = MODE_WRITE; break;
+		case 'a': mode = MODE_WRITE | MODE_APPEND; break;
+		default: return NULL;
+	}
+	if (strchr(flags, '+')) {
+		mode |= MODE_READ | MODE_WRITE;
+	}
+
+	for (i = 0; i < MBFLASHFS_MAX_HANDLES && handles[i].in_use; i++);
+	if (i == MBFLASHFS_MAX_HANDLES) {
+		return NULL;
+	}
+
+	file = file_find(fname);
+	if (file >= 0 && flags[0] == 'w') {
+		// truncate by starting the file over
+		if (file_delete(file) != 0) {
+			return NULL;
+		}
+		file = -1;
+	}
+	if (file < 0) {
+		// Only write and append create a file
+		if (flags[0] == 'r') {
+			return NULL;
+		}
+		file = file_create(fname);
+		if (file < 0) {
+			return NULL;
+		}
+	}
+
+	handles[i].in_use = 1;
+	handles[i].file = file;
+	handles[i].mode = mode;
+	handles[i].pos = 0;
+	handles[i].buf_len = 0;
+	return (FILE*) &handles[i];
+}
+
+size_t fread (void* ptr, size_t size, size_t count, FILE* stream) {
+	mbflashfs_handle_t* h = handle_get(stream);
+	uint32_t copy_len = size*count;
+	uint32_t file_size;
+
+	if (h == NULL || !(h->mode & MODE_READ) || size == 0) {
+		return 0;
+	}
+
+	// buffered writes of every handle must be visible
+	file_flush(h->file);
+	file_size = files[h->file].size;
+
+	// Nothing to read at or past the end
+	if (h->pos >= file_size) {
+		return 0;
+	}
+	// Make sure we don't read off the end of the file
+	if (h->pos + copy_len > file_size) {
+		copy_len = file_size - h->pos;
+	}
+	// Only whole items are read
+	copy_len -= copy_len % size;
+
+	file_read(h->file, h->pos, ptr, copy_len);
+	h->pos += copy_len;
+	return copy_len / size;
+}
+
+size_t fwrite (const void* ptr, size_t size, size_t count, FILE* stream) {
+	mbflashfs_handle_t* h = handle_get(stream);
+	uint32_t write_len = size*count;
+	uint32_t done = 0;
+
+	if (h == NULL || !(h->mode & MODE_WRITE) || size == 0) {
+		return 0;
+	}
+
+	if (h->mode & MODE_APPEND) {
+		h->pos = files[h->file].size;
+	}
+
+	// the buffer only holds one contiguous run
+	if (h->buf_len > 0 && h->buf_offset + h->buf_len != h->pos) {
+		if (handle_flush(h) != 0) {
+			return 0;
+		}
+	}
+
+	while (done < write_len) {
+		uint32_t chunk;
+
+		// a full buffer becomes one record
+		if (h->buf_len == sizeof(h->buf) && handle_flush(h) != 0) {
+			break;
+		}
+		if (h->buf_len == 0) {
+			h->buf_offset = h->pos;
+		}
+
+		chunk = sizeof(h->buf) - h->buf_len;
+		if (chunk > write_len - done) {
+			chunk = write_len - done;
+		}
+		memcpy((uint8_t*) h->buf + h->buf_len, (const uint8_t*) ptr + done, chunk);
+		h->buf_len += chunk;
+		h->pos += chunk;
+		done += chunk;
+
+		if (h->pos > files[h->file].size) {
+			files[h->file].size = h->pos;
+		}
+	}
+
+	stats.app_bytes += done;
+	return done / size;
+}
+
+int fflush (FILE* stream) {
+	mbflashfs_handle_t* h;
+	uint8_t i;
+
+	if (stream == NULL) {
+		for (i = 0; i < MBFLASHFS_MAX_HANDLES; i++) {
+			if (handles[i].in_use && handles[i].file >= 0 && handle_flush(&handles[i]) != 0) {
+				return EOF;
+			}
+		}
+		return 0;
+	}
+
+	h = handle_get(stream);
+	if (h == NULL || handle_flush(h) != 0) {
+		return EOF;
+	}
+	return 0;
+}
+
+int fseek (FILE* f, long int offset, int origin) {
+	mbflashfs_handle_t* h = handle_get(f);
+	long int new_position;
+
+	if (h == NULL) {
+		return -1;
+	}
+
+	if (origin == SEEK_SET) {
+		// Offset from beginning of file
+		new_position = offset;
+	} else if (origin == SEEK_CUR) {
+		// From current position
+		new_position = offset + (long int) h->pos;
+	} else if (origin == SEEK_END) {
+		new_position = offset + (long int) files[h->file].size;
+	} else {
+		return -1;
+	}
+
+	if (new_position < 0 || new_position > (long int) files[h->file].size) {
+		// Seek too far, past the end of the file
+		return -1;
+	}
+
+	h->pos = new_position;
+	return 0;
+}
+
+long int ftell (FILE* f) {
+	mbflashfs_handle_t* h = handle_get(f);
+	if (h == NULL) {
+		return -1;
+	}
+	return h->pos;
+}
+
+void rewind (FILE* f) {
+	mbflashfs_handle_t* h = handle_get(f);
+	if (h != NULL) {
+		h->pos = 0;
+	}
+}
+
+int fclose (FILE* stream) {
+	mbflashfs_handle_t* h = (mbflashfs_handle_t*) stream;
+	int result = 0;
+
+	if (h < handles || h >= handles + MBFLASHFS_MAX_HANDLES || !h->in_use) {
+		return EOF;
+	}
+	if (h->file >= 0 && handle_flush(h) != 0) {
+		result = EOF;
+	}
+	h->in_use = 0;
+	return result;
+}
+
+int remove (const char* filename) {
+	int8_t file;
+
+	if (!mounted) {
+		fs_mount();
+	}
+
+	file = file_find(filename);
+	if (file < 0 || file_delete(file) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+
+/*******************************************************************************
+ *   MBFLASHFS
+ ******************************************************************************/
+void mbflashfs_format (void) {
+	uint8_t i;
+
+	if (!mounted) {
+		fs_mount();
+	}
+	for (i = 0; i < MBFLASHFS_PAGE_COUNT; i++) {
+		page_erase(i);
+	}
+	fs_mount();
+}
+
+void mbflashfs_stats_get (mbflashfs_stats_t* s) {
+	*s = stats;
+}
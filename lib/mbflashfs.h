@@ -0,0 +1,25 @@
+#ifndef __MBFLASHFS_H
+#define __MBFLASHFS_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *   TYPE DEFINITIONS
+ ******************************************************************************/
+typedef struct mbflashfs_stats_s {
+    uint32_t app_bytes;     // bytes accepted by fwrite
+    uint32_t flash_bytes;   // bytes programmed to flash, including record headers and garbage collection
+    uint32_t page_erases;   // pages erased by garbage collection
+} mbflashfs_stats_t;
+
+
+/*******************************************************************************
+ *   FUNCTION PROTOTYPES
+ ******************************************************************************/
+// erase all pages of the filesystem. All open handles are closed.
+void mbflashfs_format (void);
+
+// write amplification is flash_bytes / app_bytes
+void mbflashfs_stats_get (mbflashfs_stats_t* stats);
+
+#endif
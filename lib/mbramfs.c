@@ -1,81 +1,422 @@
 // Most Basic RAM Filesystem
 //
-// Supports 1 file
+// Supports multiple named files, stored in extents of blocks taken from one
+// shared block pool. Files are found by hashing their name, and every open
+// handle keeps its own position, so several files can be written at once.
+//
+// Supported modes are "r", "w", "a" and their "+" variants. Writes in append
+// mode always go to the end of the file. Files cannot be seeked past their end.
 
 
 #include "stdio.h"
 #include "stdint.h"
+#include "string.h"
+
+#ifndef MBRAMFS_BLOCK_SIZE
+#define MBRAMFS_BLOCK_SIZE 256     // bytes per block
+#endif
+#ifndef MBRAMFS_BLOCK_COUNT
+#define MBRAMFS_BLOCK_COUNT 40     // blocks in the pool, at most 255
+#endif
+#ifndef MBRAMFS_MAX_FILES
+#define MBRAMFS_MAX_FILES 8
+#endif
+#ifndef MBRAMFS_MAX_HANDLES
+#define MBRAMFS_MAX_HANDLES 8
+#endif
+#ifndef MBRAMFS_MAX_EXTENTS
+#define MBRAMFS_MAX_EXTENTS 8      // runs of contiguous blocks per file
+#endif
+#ifndef MBRAMFS_NAME_LEN
+#define MBRAMFS_NAME_LEN 16        // including the terminating null
+#endif
+#define MBRAMFS_HASH_BUCKETS 16    // must be a power of two
+
+#if MBRAMFS_BLOCK_COUNT > 255
+#error "MBRAMFS_BLOCK_COUNT must fit in a uint8_t"
+#endif
+
+#define MODE_READ   0x01
+#define MODE_WRITE  0x02
+#define MODE_APPEND 0x04
+
+// A run of contiguous blocks
+typedef struct {
+	uint8_t start;
+	uint8_t count;
+} extent_t;
+
+typedef struct {
+	char name[MBRAMFS_NAME_LEN];
+	uint32_t size;
+	int8_t next;               // next file in the same hash bucket, -1 at the end
+	uint8_t in_use;
+	uint8_t extent_count;
+	extent_t extents[MBRAMFS_MAX_EXTENTS];
+} mbramfs_file_t;
+
+// The FILE pointers given to the application point to these
+typedef struct {
+	int8_t file;               // index into files, -1 if the file was removed
+	uint8_t in_use;
+	uint8_t mode;
+	uint32_t pos;
+} mbramfs_handle_t;
+
+static uint8_t blocks[MBRAMFS_BLOCK_COUNT][MBRAMFS_BLOCK_SIZE];
+static uint8_t block_used[(MBRAMFS_BLOCK_COUNT + 7) / 8] = {0};
+static mbramfs_file_t files[MBRAMFS_MAX_FILES];
+static mbramfs_handle_t handles[MBRAMFS_MAX_HANDLES];
+static int8_t buckets[MBRAMFS_HASH_BUCKETS] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+
+// FNV-1a hash of the file name
+static uint32_t name_hash (const char* name) {
+	uint32_t hash = 2166136261u;
+	while (*name) {
+		hash = (hash ^ (uint8_t) *name++) * 16777619u;
+	}
+	return hash & (MBRAMFS_HASH_BUCKETS - 1);
+}
 
-#define MBRAMFS_FILESIZE_IN_BYTES 10000
+static int8_t file_find (const char* name) {
+	int8_t i = buckets[name_hash(name)];
+	while (i >= 0 && strcmp(files[i].name, name) != 0) {
+		i = files[i].next;
+	}
+	return i;
+}
+
+static int8_t file_create (const char* name) {
+	int8_t i;
+	uint32_t bucket;
+
+	if (strlen(name) >= MBRAMFS_NAME_LEN) {
+		return -1;
+	}
+	for (i = 0; i < MBRAMFS_MAX_FILES && files[i].in_use; i++);
+	if (i == MBRAMFS_MAX_FILES) {
+		return -1;
+	}
+
+	strcpy(files[i].name, name);
+	files[i].in_use = 1;
+	files[i].size = 0;
+	files[i].extent_count = 0;
 
-FILE onefile;
+	bucket = name_hash(name);
+	files[i].next = buckets[bucket];
+	buckets[bucket] = i;
+	return i;
+}
 
-static uint32_t fptr = 0;
-static uint8_t filebuf[MBRAMFS_FILESIZE_IN_BYTES] = {0};
+static void block_set_used (uint8_t block, uint8_t used) {
+	if (used) {
+		block_used[block / 8] |= (1 << (block % 8));
+	} else {
+		block_used[block / 8] &= ~(1 << (block % 8));
+	}
+}
+
+static uint8_t block_is_used (uint8_t block) {
+	return (block_used[block / 8] >> (block % 8)) & 1;
+}
+
+// Give all blocks of a file back to the pool. Open handles go back to the
+// start of the now empty file.
+static void file_truncate (mbramfs_file_t* f) {
+	uint8_t e, b, i;
+	for (e = 0; e < f->extent_count; e++) {
+		for (b = 0; b < f->extents[e].count; b++) {
+			block_set_used(f->extents[e].start + b, 0);
+		}
+	}
+	f->extent_count = 0;
+	f->size = 0;
+
+	for (i = 0; i < MBRAMFS_MAX_HANDLES; i++) {
+		if (handles[i].in_use && handles[i].file == f - files) {
+			handles[i].pos = 0;
+		}
+	}
+}
+
+static uint32_t file_capacity (mbramfs_file_t* f) {
+	uint32_t capacity = 0;
+	uint8_t e;
+	for (e = 0; e < f->extent_count; e++) {
+		capacity += f->extents[e].count * MBRAMFS_BLOCK_SIZE;
+	}
+	return capacity;
+}
+
+// Add one block to the end of a file. The last extent grows if the block right
+// after it is free, otherwise a new extent is started.
+static int file_grow (mbramfs_file_t* f) {
+	uint8_t block;
+
+	if (f->extent_count > 0) {
+		extent_t* last = &f->extents[f->extent_count - 1];
+		block = last->start + last->count;
+		if (block < MBRAMFS_BLOCK_COUNT && !block_is_used(block) && last->count < UINT8_MAX) {
+			block_set_used(block, 1);
+			last->count++;
+			return 0;
+		}
+	}
+
+	if (f->extent_count == MBRAMFS_MAX_EXTENTS) {
+		return -1;
+	}
+	for (block = 0; block < MBRAMFS_BLOCK_COUNT && block_is_used(block); block++);
+	if (block == MBRAMFS_BLOCK_COUNT) {
+		return -1;
+	}
+
+	block_set_used(block, 1);
+	f->extents[f->extent_count].start = block;
+	f->extents[f->extent_count].count = 1;
+	f->extent_count++;
+	return 0;
+}
+
+// Find where a file offset is stored, and how many bytes are contiguous from
+// there. The offset must be below the file capacity.
+static uint8_t* file_span (mbramfs_file_t* f, uint32_t offset, uint32_t* len) {
+	uint8_t e;
+	for (e = 0; e < f->extent_count; e++) {
+		uint32_t extent_len = f->extents[e].count * MBRAMFS_BLOCK_SIZE;
+		if (offset < extent_len) {
+			*len = extent_len - offset;
+			return blocks[f->extents[e].start] + offset;
+		}
+		offset -= extent_len;
+	}
+	*len = 0;
+	return NULL;
+}
+
+static mbramfs_handle_t* handle_get (FILE* stream) {
+	mbramfs_handle_t* h = (mbramfs_handle_t*) stream;
+	if (h < handles || h >= handles + MBRAMFS_MAX_HANDLES || !h->in_use || h->file < 0) {
+		return NULL;
+	}
+	return h;
+}
 
 
 FILE* fopen (const char* restrict fname, const char* restrict flags) {
-	return &onefile;
+	uint8_t mode;
+	int8_t file;
+	uint8_t i;
+
+	switch (flags[0]) {
+		case 'r': mode = MODE_READ; break;
+		case 'w': mode = MODE_WRITE; break;
+		case 'a': mode = MODE_WRITE | MODE_APPEND; break;
+		default: return NULL;
+	}
+	if (strchr(flags, '+')) {
+		mode |= MODE_READ | MODE_WRITE;
+	}
+
+	for (i = 0; i < MBRAMFS_MAX_HANDLES && handles[i].in_use; i++);
+	if (i == MBRAMFS_MAX_HANDLES) {
+		return NULL;
+	}
+
+	file = file_find(fname);
+	if (file < 0) {
+		// Only write and append create a file
+		if (flags[0] == 'r') {
+			return NULL;
+		}
+		file = file_create(fname);
+		if (file < 0) {
+			return NULL;
+		}
+	} else if (flags[0] == 'w') {
+		file_truncate(&files[file]);
+	}
+
+	handles[i].in_use = 1;
+	handles[i].file = file;
+	handles[i].mode = mode;
+	handles[i].pos = 0;
+	return (FILE*) &handles[i];
 }
 
 size_t fread (void* ptr, size_t size, size_t count, FILE* stream) {
+	mbramfs_handle_t* h = handle_get(stream);
+	mbramfs_file_t* f;
 	uint32_t copy_len = size*count;
+	uint32_t done = 0;
 
-	// Make sure we don't read off the end of the array
-	if (fptr + copy_len > MBRAMFS_FILESIZE_IN_BYTES) {
-		copy_len = MBRAMFS_FILESIZE_IN_BYTES - fptr;
+	if (h == NULL || !(h->mode & MODE_READ) || size == 0) {
+		return 0;
 	}
+	f = &files[h->file];
 
-	// memcpy the "file" to the user buffer and return how much we copied
-	memcpy(ptr, filebuf+fptr, copy_len);
-	fptr += copy_len;
-	return copy_len;
+	// Nothing to read at or past the end
+	if (h->pos >= f->size) {
+		return 0;
+	}
+	// Make sure we don't read off the end of the file
+	if (h->pos + copy_len > f->size) {
+		copy_len = f->size - h->pos;
+	}
+	// Only whole items are read
+	copy_len -= copy_len % size;
+
+	while (done < copy_len) {
+		uint32_t span;
+		uint8_t* src = file_span(f, h->pos, &span);
+		if (span > copy_len - done) {
+			span = copy_len - done;
+		}
+		memcpy((uint8_t*) ptr + done, src, span);
+		done += span;
+		h->pos += span;
+	}
+	return done / size;
 }
 
 size_t fwrite (const void* ptr, size_t size, size_t count, FILE* stream) {
+	mbramfs_handle_t* h = handle_get(stream);
+	mbramfs_file_t* f;
 	uint32_t write_len = size*count;
+	uint32_t done = 0;
+
+	if (h == NULL || !(h->mode & MODE_WRITE) || size == 0) {
+		return 0;
+	}
+	f = &files[h->file];
+
+	if (h->mode & MODE_APPEND) {
+		h->pos = f->size;
+	}
+
+	// Grow the file until the data fits or the pool runs out
+	while (file_capacity(f) < h->pos + write_len) {
+		if (file_grow(f) != 0) {
+			write_len = (file_capacity(f) > h->pos) ? file_capacity(f) - h->pos : 0;
+			write_len -= write_len % size;
+			break;
+		}
+	}
+	if (write_len == 0) {
+		return 0;
+	}
 
-	// Make sure we don't read off the end of the array
-	if (fptr + write_len > MBRAMFS_FILESIZE_IN_BYTES) {
-		write_len = MBRAMFS_FILESIZE_IN_BYTES - fptr;
+	// A gap between the end of the file and the write reads as zeros, not as
+	// whatever the blocks held before
+	while (f->size < h->pos) {
+		uint32_t span;
+		uint8_t* dst = file_span(f, f->size, &span);
+		if (span > h->pos - f->size) {
+			span = h->pos - f->size;
+		}
+		memset(dst, 0, span);
+		f->size += span;
 	}
 
-	memcpy(filebuf+fptr, ptr, write_len);
-	fptr += write_len;
-	return write_len;
+	while (done < write_len) {
+		uint32_t span;
+		uint8_t* dst = file_span(f, h->pos, &span);
+		if (span > write_len - done) {
+			span = write_len - done;
+		}
+		memcpy(dst, (const uint8_t*) ptr + done, span);
+		done += span;
+		h->pos += span;
+	}
+
+	if (h->pos > f->size) {
+		f->size = h->pos;
+	}
+	return done / size;
 }
 
 int fseek (FILE* f, long int offset, int origin) {
-	uint32_t new_position = 0;
+	mbramfs_handle_t* h = handle_get(f);
+	long int new_position;
+
+	if (h == NULL) {
+		return -1;
+	}
+
 	if (origin == SEEK_SET) {
 		// Offset from beginning of file
 		new_position = offset;
 	} else if (origin == SEEK_CUR) {
 		// From current position
-		new_position = offset + fptr;
+		new_position = offset + (long int) h->pos;
+	} else if (origin == SEEK_END) {
+		new_position = offset + (long int) files[h->file].size;
+	} else {
+		return -1;
 	}
 
-	if (new_position > MBRAMFS_FILESIZE_IN_BYTES) {
-		// Seek too far, past the end of the "file"
+	if (new_position < 0 || new_position > (long int) files[h->file].size) {
+		// Seek too far, past the end of the file
 		return -1;
 	}
 
-	// Update internal pointer
-	fptr = new_position;
+	// Update this handle's position
+	h->pos = new_position;
 	return 0;
 }
 
+long int ftell (FILE* f) {
+	mbramfs_handle_t* h = handle_get(f);
+	if (h == NULL) {
+		return -1;
+	}
+	return h->pos;
+}
+
 void rewind (FILE* f) {
-	// Just need to reset our array index into the file buffer
-	fptr = 0;
+	mbramfs_handle_t* h = handle_get(f);
+	if (h != NULL) {
+		h->pos = 0;
+	}
 }
 
 int fclose (FILE* stream) {
+	mbramfs_handle_t* h = (mbramfs_handle_t*) stream;
+	if (h < handles || h >= handles + MBRAMFS_MAX_HANDLES || !h->in_use) {
+		return EOF;
+	}
+	h->in_use = 0;
 	return 0;
 }
 
-// "delete" file by clearing it
+// Delete a file and give its blocks back to the pool. Handles that still have
+// it open fail from now on.
 int remove (const char* filename) {
-	memset(filebuf, 0, MBRAMFS_FILESIZE_IN_BYTES);
-	fptr = 0;
+	int8_t file = file_find(filename);
+	int8_t* link;
+	uint8_t i;
+
+	if (file < 0) {
+		return -1;
+	}
+
+	link = &buckets[name_hash(filename)];
+	while (*link != file) {
+		link = &files[*link].next;
+	}
+	*link = files[file].next;
+
+	file_truncate(&files[file]);
+	files[file].in_use = 0;
+
+	for (i = 0; i < MBRAMFS_MAX_HANDLES; i++) {
+		if (handles[i].in_use && handles[i].file == file) {
+			handles[i].file = -1;
+		}
+	}
+	return 0;
 }
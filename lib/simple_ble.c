@@ -26,6 +26,7 @@
 #include "ble_hrs_c.h"
 #include "ble_bas_c.h"
 #include "app_util.h"
+#include "app_util_platform.h"
 #include "app_timer.h"
 
 // Configurations
@@ -37,6 +38,10 @@
  ******************************************************************************/
 static const simple_ble_config_t* ble_config;
 
+// Softdevice transmit buffers. The pool is shared by all links.
+static uint8_t tx_buffer_count;
+static uint8_t tx_free;
+
 simple_ble_app_t app;
 ble_gap_adv_params_t m_adv_params;
 ble_gap_sec_params_t m_sec_params = {
@@ -119,31 +124,281 @@ static void on_conn_params_evt(ble_conn_params_evt_t * p_evt) {
     }
 }
 
+// Connection handle an event is for. BLE_CONN_HANDLE_INVALID for events
+// that are not about a connection.
+static uint16_t evt_conn_handle_get(ble_evt_t * p_ble_evt) {
+    uint16_t evt_id = p_ble_evt->header.evt_id;
+
+    if (evt_id >= BLE_GAP_EVT_BASE && evt_id <= BLE_GAP_EVT_LAST) {
+        return p_ble_evt->evt.gap_evt.conn_handle;
+    } else if (evt_id >= BLE_GATTS_EVT_BASE && evt_id <= BLE_GATTS_EVT_LAST) {
+        return p_ble_evt->evt.gatts_evt.conn_handle;
+    } else if (evt_id >= BLE_GATTC_EVT_BASE && evt_id <= BLE_GATTC_EVT_LAST) {
+        return p_ble_evt->evt.gattc_evt.conn_handle;
+    } else if (evt_id >= BLE_L2CAP_EVT_BASE && evt_id <= BLE_L2CAP_EVT_LAST) {
+        return p_ble_evt->evt.l2cap_evt.conn_handle;
+    } else if (evt_id >= BLE_EVT_BASE && evt_id <= BLE_EVT_LAST) {
+        return p_ble_evt->evt.common_evt.conn_handle;
+    }
+
+    return BLE_CONN_HANDLE_INVALID;
+}
+
+// The softdevice hands out connection handles counting up from 0, so a
+// connection is almost always in its home slot and found on the first try.
+// Entries are looked for past the home slot, and past free ones, in case of
+// a collision.
+simple_ble_conn_t* simple_ble_conn_get(uint16_t conn_handle) {
+    uint8_t index = conn_handle % SIMPLE_BLE_MAX_CONNECTIONS;
+    uint8_t i;
+
+    if (conn_handle == BLE_CONN_HANDLE_INVALID) {
+        return NULL;
+    }
+
+    for (i = 0; i < SIMPLE_BLE_MAX_CONNECTIONS; i++) {
+        if (app.conns[index].conn_handle == conn_handle) {
+            return &app.conns[index];
+        }
+        index++;
+        if (index == SIMPLE_BLE_MAX_CONNECTIONS) {
+            index = 0;
+        }
+    }
+
+    return NULL;
+}
+
+static simple_ble_conn_t* conn_add(uint16_t conn_handle) {
+    uint8_t index = conn_handle % SIMPLE_BLE_MAX_CONNECTIONS;
+    uint8_t i;
+
+    for (i = 0; i < SIMPLE_BLE_MAX_CONNECTIONS; i++) {
+        if (app.conns[index].conn_handle == BLE_CONN_HANDLE_INVALID) {
+            app.conns[index].conn_handle = conn_handle;
+            app.conns[index].context = NULL;
+            app.conns[index].notify_head = 0;
+            app.conns[index].notify_count = 0;
+            app.conns[index].tx_used = 0;
+            app.conn_count++;
+            return &app.conns[index];
+        }
+        index++;
+        if (index == SIMPLE_BLE_MAX_CONNECTIONS) {
+            index = 0;
+        }
+    }
+
+    return NULL;
+}
+
+// Give transmit buffers back to the pool, and take them off the link that
+// used them
+static void tx_buffers_release(simple_ble_conn_t* conn, uint8_t count) {
+    CRITICAL_REGION_ENTER();
+    if (conn != NULL) {
+        conn->tx_used -= MIN(count, conn->tx_used);
+    }
+    tx_free = MIN(tx_free + count, tx_buffer_count);
+    CRITICAL_REGION_EXIT();
+}
+
+static void conn_remove(simple_ble_conn_t* conn) {
+    uint16_t conn_handle = conn->conn_handle;
+    uint8_t i;
+
+    conn->conn_handle = BLE_CONN_HANDLE_INVALID;
+    app.conn_count--;
+
+    // The buffers of a closed link come back without BLE_EVT_TX_COMPLETE
+    tx_buffers_release(conn, conn->tx_used);
+
+    // app.conn_handle moves to one of the remaining connections
+    if (app.conn_handle == conn_handle) {
+        app.conn_handle = BLE_CONN_HANDLE_INVALID;
+        for (i = 0; i < SIMPLE_BLE_MAX_CONNECTIONS; i++) {
+            if (app.conns[i].conn_handle != BLE_CONN_HANDLE_INVALID) {
+                app.conn_handle = app.conns[i].conn_handle;
+                break;
+            }
+        }
+    }
+}
+
+// Take a transmit buffer from the pool for a link. Must be called inside a
+// critical region.
+static bool tx_buffer_take(simple_ble_conn_t* conn) {
+    if (tx_free == 0) {
+        return false;
+    }
+    tx_free--;
+    conn->tx_used++;
+    return true;
+}
+
+// Send a notification on a buffer taken with tx_buffer_take(). The buffer
+// goes back to the pool if the softdevice refuses the notification.
+static uint32_t notify_send(simple_ble_conn_t* conn,
+                            uint16_t value_handle,
+                            const uint8_t* data,
+                            uint16_t len) {
+    uint32_t err_code;
+    ble_gatts_hvx_params_t hvx_params;
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.offset = 0;
+    hvx_params.p_len  = &len;
+    hvx_params.p_data = (uint8_t*)data;
+
+    err_code = sd_ble_gatts_hvx(conn->conn_handle, &hvx_params);
+    if (err_code != NRF_SUCCESS) {
+        CRITICAL_REGION_ENTER();
+        conn->tx_used--;
+        if (err_code == BLE_ERROR_NO_TX_BUFFERS) {
+            // Buffers used by something else, wait for BLE_EVT_TX_COMPLETE
+            tx_free = 0;
+        } else {
+            tx_free++;
+        }
+        CRITICAL_REGION_EXIT();
+    }
+
+    return err_code;
+}
+
+// Send queued notifications of a link until the transmit buffers are used
+// up. A notification the softdevice rejects, for example because the
+// central turned notifications off, is dropped. The oldest entry is copied
+// out, so the softdevice is called outside the critical region.
+static void notify_queue_drain(simple_ble_conn_t* conn) {
+    simple_ble_notify_t notify;
+    uint32_t err_code;
+    bool sending;
+    bool done;
+
+    while (true) {
+        CRITICAL_REGION_ENTER();
+        sending = (conn->notify_count > 0 && tx_buffer_take(conn));
+        if (sending) {
+            notify = conn->notify_queue[conn->notify_head];
+        }
+        CRITICAL_REGION_EXIT();
+
+        if (!sending) {
+            break;
+        }
+
+        err_code = notify_send(conn, notify.value_handle, notify.data, notify.len);
+        if (err_code == BLE_ERROR_NO_TX_BUFFERS) {
+            break;
+        }
+
+        CRITICAL_REGION_ENTER();
+        done = true;
+#ifdef SIMPLE_BLE_NOTIFY_COLLAPSE
+        // A newer value may have replaced the entry while it was sent. It
+        // then stays at the head and goes out next.
+        if (err_code == NRF_SUCCESS) {
+            simple_ble_notify_t* head = &conn->notify_queue[conn->notify_head];
+            done = (head->len == notify.len &&
+                    memcmp(head->data, notify.data, notify.len) == 0);
+        }
+#endif
+        if (done) {
+            conn->notify_head++;
+            if (conn->notify_head == SIMPLE_BLE_NOTIFY_QUEUE_SIZE) {
+                conn->notify_head = 0;
+            }
+            conn->notify_count--;
+        }
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+// Freed buffers may let any link's queue move. The links after the given one
+// go first, so they take turns at the buffers.
+static void notify_queues_drain(simple_ble_conn_t* conn) {
+    uint8_t index = (conn != NULL) ? (conn - app.conns) + 1 : 0;
+    uint8_t i;
+
+    for (i = 0; i < SIMPLE_BLE_MAX_CONNECTIONS; i++) {
+        if (index >= SIMPLE_BLE_MAX_CONNECTIONS) {
+            index = 0;
+        }
+        if (app.conns[index].conn_handle != BLE_CONN_HANDLE_INVALID) {
+            notify_queue_drain(&app.conns[index]);
+        }
+        index++;
+    }
+}
+
 static void on_ble_evt(ble_evt_t * p_ble_evt) {
     uint32_t err_code;
+    uint16_t conn_handle = evt_conn_handle_get(p_ble_evt);
+    simple_ble_conn_t* conn;
+    bool was_full;
+
+    if (p_ble_evt->header.evt_id == BLE_GAP_EVT_CONNECTED) {
+        conn = conn_add(conn_handle);
+    } else {
+        conn = simple_ble_conn_get(conn_handle);
+    }
+
+    // callback for user. Weak reference, so check validity first
+    if (conn != NULL && ble_evt_connection) {
+        ble_evt_connection(conn, p_ble_evt);
+    }
 
     switch (p_ble_evt->header.evt_id) {
         case BLE_GAP_EVT_CONNECTED:
-            app.conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+            if (conn == NULL) {
+                // No room. Only central links can get here, as advertising
+                // is nonconnectable while the table is full
+                err_code = sd_ble_gap_disconnect(conn_handle,
+                        BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+                APP_ERROR_CHECK(err_code);
+                break;
+            }
+            app.conn_handle = conn_handle;
             // callback for user. Weak reference, so check validity first
             if (ble_evt_connected) {
                 ble_evt_connected(p_ble_evt);
             }
-            // continue advertising, but nonconnectably
-            m_adv_params.type = BLE_GAP_ADV_TYPE_ADV_NONCONN_IND;
+            // continue advertising, but nonconnectably once there is no
+            // room for another connection
+            if (app.conn_count < SIMPLE_BLE_MAX_CONNECTIONS) {
+                m_adv_params.type = BLE_GAP_ADV_TYPE_ADV_IND;
+            } else {
+                m_adv_params.type = BLE_GAP_ADV_TYPE_ADV_NONCONN_IND;
+            }
             advertising_start();
             break;
 
         case BLE_GAP_EVT_DISCONNECTED:
-            app.conn_handle = BLE_CONN_HANDLE_INVALID;
+            if (conn == NULL) {
+                break;
+            }
+            was_full = (app.conn_count == SIMPLE_BLE_MAX_CONNECTIONS);
+            conn_remove(conn);
+            notify_queues_drain(conn);
             // callback for user. Weak reference, so check validity first
             if (ble_evt_disconnected) {
                 ble_evt_disconnected(p_ble_evt);
             }
-            // go back to advertising connectably
-            advertising_stop();
-            m_adv_params.type = BLE_GAP_ADV_TYPE_ADV_IND;
-            advertising_start();
+            // go back to advertising connectably. When there was room,
+            // connectable advertising never stopped
+            if (was_full) {
+                advertising_stop();
+                m_adv_params.type = BLE_GAP_ADV_TYPE_ADV_IND;
+                advertising_start();
+            }
+            break;
+
+        case BLE_EVT_TX_COMPLETE:
+            tx_buffers_release(conn, p_ble_evt->evt.common_evt.params.tx_complete.count);
+            notify_queues_drain(conn);
             break;
 
         case BLE_GATTS_EVT_WRITE:
@@ -154,13 +409,13 @@ static void on_ble_evt(ble_evt_t * p_ble_evt) {
             break;
 
         case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
-            err_code = sd_ble_gap_sec_params_reply(app.conn_handle,
+            err_code = sd_ble_gap_sec_params_reply(conn_handle,
                     BLE_GAP_SEC_STATUS_SUCCESS, &m_sec_params, NULL);
             APP_ERROR_CHECK(err_code);
             break;
 
         case BLE_GATTS_EVT_SYS_ATTR_MISSING:
-            err_code = sd_ble_gatts_sys_attr_set(app.conn_handle, NULL, 0, 0);
+            err_code = sd_ble_gatts_sys_attr_set(conn_handle, NULL, 0, 0);
             APP_ERROR_CHECK(err_code);
             break;
 
@@ -169,7 +424,7 @@ static void on_ble_evt(ble_evt_t * p_ble_evt) {
 
         case BLE_GAP_EVT_SEC_INFO_REQUEST:
             // No keys found for this device.
-            err_code = sd_ble_gap_sec_info_reply(app.conn_handle, NULL, NULL, NULL);
+            err_code = sd_ble_gap_sec_info_reply(conn_handle, NULL, NULL, NULL);
             APP_ERROR_CHECK(err_code);
             break;
 
@@ -185,7 +440,6 @@ static void on_ble_evt(ble_evt_t * p_ble_evt) {
     }
 }
 
-
 /*******************************************************************************
  *   INIT FUNCTIONS
  ******************************************************************************/
@@ -307,20 +561,114 @@ void __attribute__((weak)) power_manage(void) {
  ******************************************************************************/
 
 simple_ble_app_t* simple_ble_init(const simple_ble_config_t* conf) {
+    uint32_t err_code;
+    uint8_t i;
+
     ble_config = conf;
 
+    // No connections yet
+    app.conn_handle = BLE_CONN_HANDLE_INVALID;
+    app.conn_count = 0;
+    for (i = 0; i < SIMPLE_BLE_MAX_CONNECTIONS; i++) {
+        app.conns[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+    }
+
     // Setup BLE and services
     ble_stack_init();
+
+    // All transmit buffers are free before the first connection
+    err_code = sd_ble_tx_buffer_count_get(&tx_buffer_count);
+    APP_ERROR_CHECK(err_code);
+    tx_free = tx_buffer_count;
+
     gap_params_init();
     advertising_init();
     services_init();
     conn_params_init();
 
     // Return a reference to the application state so that the user of this
-    // module has a pointer to the connection handle.
+    // module has a pointer to the connection handles.
     return &app;
 }
 
+// Notifications are sent as soon as there is a free transmit buffer, and
+// queued in order otherwise. Built with SIMPLE_BLE_NOTIFY_COLLAPSE, a queued
+// notification for the same characteristic is replaced instead, so only the
+// latest value is sent.
+uint32_t simple_ble_notify(uint16_t conn_handle,
+                           uint16_t value_handle,
+                           const uint8_t* data,
+                           uint16_t len) {
+    uint32_t err_code = NRF_SUCCESS;
+    simple_ble_conn_t* conn;
+    simple_ble_notify_t* notify = NULL;
+    uint8_t index;
+    bool sending = false;
+
+    if (len > SIMPLE_BLE_NOTIFY_MAX_LEN) {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    // The queue is also drained from the BLE event handler. Send straight
+    // away when nothing is waiting, which keeps the order
+    CRITICAL_REGION_ENTER();
+    conn = simple_ble_conn_get(conn_handle);
+    if (conn != NULL) {
+        sending = (conn->notify_count == 0 && tx_buffer_take(conn));
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (conn == NULL) {
+        return BLE_ERROR_INVALID_CONN_HANDLE;
+    }
+    if (sending) {
+        err_code = notify_send(conn, value_handle, data, len);
+        if (err_code != BLE_ERROR_NO_TX_BUFFERS) {
+            return err_code;
+        }
+        err_code = NRF_SUCCESS;
+    }
+
+    CRITICAL_REGION_ENTER();
+
+    if (conn->conn_handle != conn_handle) {
+        // Disconnected meanwhile
+        err_code = BLE_ERROR_INVALID_CONN_HANDLE;
+
+    } else {
+#ifdef SIMPLE_BLE_NOTIFY_COLLAPSE
+        uint8_t i;
+        for (i = 0; i < conn->notify_count; i++) {
+            index = (conn->notify_head + i) % SIMPLE_BLE_NOTIFY_QUEUE_SIZE;
+            if (conn->notify_queue[index].value_handle == value_handle) {
+                notify = &conn->notify_queue[index];
+                break;
+            }
+        }
+#endif
+
+        if (notify == NULL) {
+            if (conn->notify_count == SIMPLE_BLE_NOTIFY_QUEUE_SIZE) {
+                err_code = NRF_ERROR_NO_MEM;
+            } else {
+                index = (conn->notify_head + conn->notify_count) % SIMPLE_BLE_NOTIFY_QUEUE_SIZE;
+                notify = &conn->notify_queue[index];
+                notify->value_handle = value_handle;
+                conn->notify_count++;
+            }
+        }
+
+        if (notify != NULL) {
+            memcpy(notify->data, data, len);
+            notify->len = len;
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
 uint16_t simple_ble_add_service (const ble_uuid128_t* uuid128,
                                  ble_uuid_t* uuid,
                                  uint16_t short_uuid) {
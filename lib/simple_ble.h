@@ -4,8 +4,43 @@
 /*******************************************************************************
  *   TYPE DEFINITIONS
  ******************************************************************************/
+// Number of simultaneous connections. Advertising stays connectable until
+// this many centrals are connected. More than one needs a softdevice that
+// allows concurrent peripheral links.
+#ifndef SIMPLE_BLE_MAX_CONNECTIONS
+#define SIMPLE_BLE_MAX_CONNECTIONS 1
+#endif
+
+// Number of notifications each connection holds while the softdevice has no
+// free transmit buffers
+#ifndef SIMPLE_BLE_NOTIFY_QUEUE_SIZE
+#define SIMPLE_BLE_NOTIFY_QUEUE_SIZE 8
+#endif
+
+// Longest notification with the default MTU
+#define SIMPLE_BLE_NOTIFY_MAX_LEN (GATT_MTU_SIZE_DEFAULT - 3)
+
+typedef struct simple_ble_notify_s {
+    uint16_t    value_handle;
+    uint16_t    len;
+    uint8_t     data[SIMPLE_BLE_NOTIFY_MAX_LEN];
+} simple_ble_notify_t;
+
+typedef struct simple_ble_conn_s {
+    uint16_t    conn_handle; // BLE_CONN_HANDLE_INVALID when the entry is free
+    void*       context;     // for the user, NULL when the connection is made
+
+    // Notifications waiting for a transmit buffer, oldest at notify_head
+    simple_ble_notify_t notify_queue[SIMPLE_BLE_NOTIFY_QUEUE_SIZE];
+    uint8_t     notify_head;
+    uint8_t     notify_count;
+    uint8_t     tx_used;     // softdevice transmit buffers holding this link's notifications
+} simple_ble_conn_t;
+
 typedef struct simple_ble_app_s {
-    uint16_t    conn_handle; // Handle of the current connection. This will be BLE_CONN_HANDLE_INVALID when not in a connection.
+    uint16_t    conn_handle; // Handle of the newest connection. This will be BLE_CONN_HANDLE_INVALID when not in a connection.
+    uint8_t     conn_count;  // Number of open connections
+    simple_ble_conn_t conns[SIMPLE_BLE_MAX_CONNECTIONS];
 } simple_ble_app_t;
 
 typedef struct simple_ble_config_s {
@@ -26,6 +61,8 @@ extern void __attribute__((weak)) ble_evt_connected(ble_evt_t* p_ble_evt);
 extern void __attribute__((weak)) ble_evt_disconnected(ble_evt_t* p_ble_evt);
 extern void __attribute__((weak)) ble_evt_write(ble_evt_t* p_ble_evt);
 extern void __attribute__((weak)) ble_error(uint32_t error_code);
+// called with every event for an open connection
+extern void __attribute__((weak)) ble_evt_connection(simple_ble_conn_t* conn, ble_evt_t* p_ble_evt);
 
 // overwrite to change functionality
 void __attribute__((weak)) ble_stack_init (void);
@@ -40,6 +77,15 @@ void __attribute__((weak)) power_manage(void);
 // call to initialize
 simple_ble_app_t* simple_ble_init(const simple_ble_config_t* conf);
 
+// connection table entry for a handle, NULL if it is not open
+simple_ble_conn_t* simple_ble_conn_get(uint16_t conn_handle);
+
+// send a notification, or queue it until a transmit buffer is free
+uint32_t simple_ble_notify(uint16_t conn_handle,
+                           uint16_t value_handle,
+                           const uint8_t* data,
+                           uint16_t len);
+
 uint16_t simple_ble_add_service (const ble_uuid128_t* uuid128,
                                  ble_uuid_t* uuid,
                                  uint16_t short_uuid);
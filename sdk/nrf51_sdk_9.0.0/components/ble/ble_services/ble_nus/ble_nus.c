@@ -14,6 +14,9 @@
 #include <string.h>
 #include "nordic_common.h"
 #include "ble_srv_common.h"
+#ifdef BLE_NUS_STREAM
+#include "app_util_platform.h"
+#endif
 
 #define BLE_UUID_NUS_TX_CHARACTERISTIC 0x0002                      /**< The UUID of the TX Characteristic. */
 #define BLE_UUID_NUS_RX_CHARACTERISTIC 0x0003                      /**< The UUID of the RX Characteristic. */
@@ -23,6 +26,171 @@
 
 #define NUS_BASE_UUID                  {{0x9E, 0xCA, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0, 0x93, 0xF3, 0xA3, 0xB5, 0x00, 0x00, 0x40, 0x6E}} /**< Used vendor specific UUID. */
 
+#ifdef BLE_NUS_STREAM
+/**@brief Function for sending one packet of the stream as an RX characteristic notification.
+ *
+ * @param[in] p_nus     Nordic UART Service structure.
+ * @param[in] p_data    Packet data.
+ * @param[in] length    Packet length, at most @ref BLE_NUS_MAX_DATA_LEN.
+ *
+ * @return Result of @ref sd_ble_gatts_hvx.
+ */
+static uint32_t stream_packet_send(ble_nus_t * p_nus, uint8_t * p_data, uint16_t length)
+{
+    ble_gatts_hvx_params_t hvx_params;
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+
+    hvx_params.handle = p_nus->rx_handles.value_handle;
+    hvx_params.p_data = p_data;
+    hvx_params.p_len  = &length;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+
+    return sd_ble_gatts_hvx(p_nus->conn_handle, &hvx_params);
+}
+
+
+/**@brief Function for sending data from the transmit FIFO while there are free transmit buffers.
+ *
+ * @details Packets are sent straight from the FIFO buffer. A packet that would cross the wrap
+ *          point of the FIFO is copied to tx_packet first, and kept there until the SoftDevice
+ *          takes it. Short packets are only sent when the FIFO holds no more data, so packets
+ *          fill up as soon as the link is busy.
+ *
+ * @param[in] p_nus     Nordic UART Service structure.
+ */
+static void stream_tx_pump(ble_nus_t * p_nus)
+{
+    uint32_t  err_code;
+    uint8_t * p_span;
+    uint32_t  span_length;
+    uint32_t  fifo_length;
+    uint16_t  length;
+
+    if ((p_nus->conn_handle == BLE_CONN_HANDLE_INVALID) || (!p_nus->is_notification_enabled))
+    {
+        return;
+    }
+
+    // Also called from the BLE event handler on TX complete.
+    CRITICAL_REGION_ENTER();
+
+    while (p_nus->tx_free > 0)
+    {
+        if (p_nus->tx_packet_len > 0)
+        {
+            err_code = stream_packet_send(p_nus, p_nus->tx_packet, p_nus->tx_packet_len);
+            if (err_code == NRF_SUCCESS)
+            {
+                p_nus->tx_packet_len = 0;
+            }
+        }
+        else
+        {
+            if (app_fifo_read_peek(&p_nus->tx_fifo, &p_span, &span_length) != NRF_SUCCESS)
+            {
+                break;
+            }
+            (void)app_fifo_read(&p_nus->tx_fifo, NULL, &fifo_length);
+
+            if ((span_length < BLE_NUS_MAX_DATA_LEN) && (span_length < fifo_length))
+            {
+                fifo_length = BLE_NUS_MAX_DATA_LEN;
+                (void)app_fifo_read(&p_nus->tx_fifo, p_nus->tx_packet, &fifo_length);
+                p_nus->tx_packet_len = fifo_length;
+                continue;
+            }
+
+            length   = MIN(span_length, BLE_NUS_MAX_DATA_LEN);
+            err_code = stream_packet_send(p_nus, p_span, length);
+            if (err_code == NRF_SUCCESS)
+            {
+                (void)app_fifo_read_commit(&p_nus->tx_fifo, length);
+            }
+        }
+
+        if (err_code != NRF_SUCCESS)
+        {
+            if (err_code == BLE_ERROR_NO_TX_BUFFERS)
+            {
+                // Buffers taken by other users of the link, wait for them to be released.
+                p_nus->tx_free = 0;
+            }
+            // Otherwise the data is kept and sending is retried with the next write.
+            break;
+        }
+
+        p_nus->tx_free--;
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+
+/**@brief Function for sending from the transmit FIFO and asking the application to refill it.
+ *
+ * @param[in] p_nus     Nordic UART Service structure.
+ */
+static void stream_tx_refill(ble_nus_t * p_nus)
+{
+    uint32_t free_length;
+
+    stream_tx_pump(p_nus);
+
+    if (
+        (p_nus->tx_handler != NULL)
+        &&
+        (app_fifo_write(&p_nus->tx_fifo, NULL, &free_length) == NRF_SUCCESS)
+       )
+    {
+        p_nus->tx_handler(p_nus);
+    }
+}
+
+
+/**@brief Function for adding received data to the receive FIFO.
+ *
+ * @details The application is only told when data arrives in an empty FIFO, so all the writes
+ *          received before it gets to read the FIFO are handled at once.
+ *
+ * @param[in] p_nus     Nordic UART Service structure.
+ * @param[in] p_data    Received data.
+ * @param[in] length    Length of the received data.
+ */
+static void stream_rx(ble_nus_t * p_nus, uint8_t * p_data, uint16_t length)
+{
+    uint32_t fifo_length;
+    uint32_t written  = length;
+    bool     is_empty = (app_fifo_read(&p_nus->rx_fifo, NULL, &fifo_length) == NRF_ERROR_NOT_FOUND);
+
+    (void)app_fifo_write(&p_nus->rx_fifo, p_data, &written);
+    p_nus->rx_dropped += length - written;
+
+    if (is_empty && (written > 0) && (p_nus->rx_handler != NULL))
+    {
+        p_nus->rx_handler(p_nus);
+    }
+}
+
+
+/**@brief Function for handling the @ref BLE_EVT_TX_COMPLETE event from the S110 SoftDevice.
+ *
+ * @param[in] p_nus     Nordic UART Service structure.
+ * @param[in] p_ble_evt Pointer to the event received from BLE stack.
+ */
+static void on_tx_complete(ble_nus_t * p_nus, ble_evt_t * p_ble_evt)
+{
+    if (p_ble_evt->evt.common_evt.conn_handle != p_nus->conn_handle)
+    {
+        return;
+    }
+
+    p_nus->tx_free += p_ble_evt->evt.common_evt.params.tx_complete.count;
+    stream_tx_refill(p_nus);
+}
+#endif // BLE_NUS_STREAM
+
+
 /**@brief Function for handling the @ref BLE_GAP_EVT_CONNECTED event from the S110 SoftDevice.
  *
  * @param[in] p_nus     Nordic UART Service structure.
@@ -31,6 +199,11 @@
 static void on_connect(ble_nus_t * p_nus, ble_evt_t * p_ble_evt)
 {
     p_nus->conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+
+#ifdef BLE_NUS_STREAM
+    // All transmit buffers of a new link are free.
+    (void)sd_ble_tx_buffer_count_get(&p_nus->tx_free);
+#endif
 }
 
 
@@ -43,6 +216,12 @@ static void on_disconnect(ble_nus_t * p_nus, ble_evt_t * p_ble_evt)
 {
     UNUSED_PARAMETER(p_ble_evt);
     p_nus->conn_handle = BLE_CONN_HANDLE_INVALID;
+
+#ifdef BLE_NUS_STREAM
+    // Unsent data was meant for this connection.
+    (void)app_fifo_flush(&p_nus->tx_fifo);
+    p_nus->tx_packet_len = 0;
+#endif
 }
 
 
@@ -64,12 +243,25 @@ static void on_write(ble_nus_t * p_nus, ble_evt_t * p_ble_evt)
         if (ble_srv_is_notification_enabled(p_evt_write->data))
         {
             p_nus->is_notification_enabled = true;
+#ifdef BLE_NUS_STREAM
+            stream_tx_refill(p_nus);
+#endif
         }
         else
         {
             p_nus->is_notification_enabled = false;
         }
     }
+#ifdef BLE_NUS_STREAM
+    else if (
+             (p_evt_write->handle == p_nus->tx_handles.value_handle)
+             &&
+             (p_nus->rx_fifo.p_buf != NULL)
+            )
+    {
+        stream_rx(p_nus, p_evt_write->data, p_evt_write->len);
+    }
+#endif
     else if (
              (p_evt_write->handle == p_nus->tx_handles.value_handle)
              &&
@@ -219,6 +411,12 @@ void ble_nus_on_ble_evt(ble_nus_t * p_nus, ble_evt_t * p_ble_evt)
             on_write(p_nus, p_ble_evt);
             break;
 
+#ifdef BLE_NUS_STREAM
+        case BLE_EVT_TX_COMPLETE:
+            on_tx_complete(p_nus, p_ble_evt);
+            break;
+#endif
+
         default:
             // No implementation needed.
             break;
@@ -242,6 +440,30 @@ uint32_t ble_nus_init(ble_nus_t * p_nus, const ble_nus_init_t * p_nus_init)
     p_nus->data_handler            = p_nus_init->data_handler;
     p_nus->is_notification_enabled = false;
 
+#ifdef BLE_NUS_STREAM
+    p_nus->tx_free       = 0;
+    p_nus->tx_packet_len = 0;
+    p_nus->tx_handler    = p_nus_init->tx_handler;
+    p_nus->rx_handler    = p_nus_init->rx_handler;
+    p_nus->rx_dropped    = 0;
+
+    err_code = app_fifo_init(&p_nus->tx_fifo, p_nus_init->p_tx_buf, p_nus_init->tx_buf_size);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    memset(&p_nus->rx_fifo, 0, sizeof(p_nus->rx_fifo));
+    if (p_nus_init->p_rx_buf != NULL)
+    {
+        err_code = app_fifo_init(&p_nus->rx_fifo, p_nus_init->p_rx_buf, p_nus_init->rx_buf_size);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+#endif
+
     /**@snippet [Adding proprietary Service to S110 SoftDevice] */
     // Add a custom base UUID.
     err_code = sd_ble_uuid_vs_add(&nus_base_uuid, &p_nus->uuid_type);
@@ -311,3 +533,42 @@ uint32_t ble_nus_string_send(ble_nus_t * p_nus, uint8_t * p_string, uint16_t len
 }
 
 
+#ifdef BLE_NUS_STREAM
+uint32_t ble_nus_stream_write(ble_nus_t * p_nus, uint8_t const * p_data, uint32_t * p_length)
+{
+    uint32_t err_code;
+
+    if ((p_nus == NULL) || (p_data == NULL) || (p_length == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if ((p_nus->conn_handle == BLE_CONN_HANDLE_INVALID) || (!p_nus->is_notification_enabled))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    err_code = app_fifo_write(&p_nus->tx_fifo, p_data, p_length);
+
+    stream_tx_pump(p_nus);
+
+    return err_code;
+}
+
+
+uint32_t ble_nus_stream_read(ble_nus_t * p_nus, uint8_t * p_data, uint32_t * p_length)
+{
+    if ((p_nus == NULL) || (p_data == NULL) || (p_length == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_nus->rx_fifo.p_buf == NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    return app_fifo_read(&p_nus->rx_fifo, p_data, p_length);
+}
+#endif // BLE_NUS_STREAM
+
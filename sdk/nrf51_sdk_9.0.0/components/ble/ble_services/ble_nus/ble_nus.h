@@ -27,6 +27,14 @@
  *
  * @note The application must propagate S110 SoftDevice events to the Nordic UART Service module
  *       by calling the ble_nus_on_ble_evt() function from the ble_stack_handler callback.
+ *
+ * @details When built with BLE_NUS_STREAM, the service can also carry byte streams of any length.
+ *          Data written with @ref ble_nus_stream_write is buffered in a FIFO and sent as
+ *          notifications of @ref BLE_NUS_MAX_DATA_LEN bytes, as many as the SoftDevice has transmit
+ *          buffers for. The FIFO is refilled on @ref BLE_EVT_TX_COMPLETE, from the FIFO and then
+ *          from the application's transmit handler. Received data can be collected in a second
+ *          FIFO and read with @ref ble_nus_stream_read, instead of being passed to the data handler
+ *          one write at a time.
  */
 
 #ifndef BLE_NUS_H__
@@ -36,6 +44,9 @@
 #include "ble_srv_common.h"
 #include <stdint.h>
 #include <stdbool.h>
+#ifdef BLE_NUS_STREAM
+#include "app_fifo.h"
+#endif
 
 #define BLE_UUID_NUS_SERVICE 0x0001                      /**< The UUID of the Nordic UART Service. */
 #define BLE_NUS_MAX_DATA_LEN (GATT_MTU_SIZE_DEFAULT - 3) /**< Maximum length of data (in bytes) that can be transmitted to the peer by the Nordic UART service module. */
@@ -46,6 +57,11 @@ typedef struct ble_nus_s ble_nus_t;
 /**@brief Nordic UART Service event handler type. */
 typedef void (*ble_nus_data_handler_t) (ble_nus_t * p_nus, uint8_t * p_data, uint16_t length);
 
+#ifdef BLE_NUS_STREAM
+/**@brief Nordic UART Service stream event handler type. */
+typedef void (*ble_nus_stream_handler_t) (ble_nus_t * p_nus);
+#endif
+
 /**@brief Nordic UART Service initialization structure.
  *
  * @details This structure contains the initialization information for the service. The application
@@ -55,6 +71,14 @@ typedef void (*ble_nus_data_handler_t) (ble_nus_t * p_nus, uint8_t * p_data, uin
 typedef struct
 {
     ble_nus_data_handler_t data_handler; /**< Event handler to be called for handling received data. */
+#ifdef BLE_NUS_STREAM
+    uint8_t *                p_tx_buf;    /**< Transmit FIFO buffer. The size must be a power of two. */
+    uint16_t                 tx_buf_size; /**< Size of the transmit FIFO buffer. */
+    uint8_t *                p_rx_buf;    /**< Receive FIFO buffer, or NULL to pass received data to the data handler. The size must be a power of two. */
+    uint16_t                 rx_buf_size; /**< Size of the receive FIFO buffer. */
+    ble_nus_stream_handler_t tx_handler;  /**< Called when there is room in the transmit FIFO after data was sent, or NULL. */
+    ble_nus_stream_handler_t rx_handler;  /**< Called when data arrives in the empty receive FIFO, or NULL. */
+#endif
 } ble_nus_init_t;
 
 /**@brief Nordic UART Service structure.
@@ -70,6 +94,16 @@ struct ble_nus_s
     uint16_t                 conn_handle;             /**< Handle of the current connection (as provided by the S110 SoftDevice). BLE_CONN_HANDLE_INVALID if not in a connection. */
     bool                     is_notification_enabled; /**< Variable to indicate if the peer has enabled notification of the RX characteristic.*/
     ble_nus_data_handler_t   data_handler;            /**< Event handler to be called for handling received data. */
+#ifdef BLE_NUS_STREAM
+    app_fifo_t               tx_fifo;                 /**< Data waiting to be sent. */
+    app_fifo_t               rx_fifo;                 /**< Received data not yet read by the application. */
+    uint8_t                  tx_packet[BLE_NUS_MAX_DATA_LEN]; /**< Packet taken from across the wrap point of the transmit FIFO, not sent yet. */
+    uint16_t                 tx_packet_len;           /**< Length of the packet in tx_packet, 0 if there is none. */
+    uint8_t                  tx_free;                 /**< Number of SoftDevice transmit buffers not in use. */
+    ble_nus_stream_handler_t tx_handler;              /**< Called when there is room in the transmit FIFO after data was sent. */
+    ble_nus_stream_handler_t rx_handler;              /**< Called when data arrives in the empty receive FIFO. */
+    uint32_t                 rx_dropped;              /**< Number of received bytes dropped because the receive FIFO was full. */
+#endif
 };
 
 /**@brief Function for initializing the Nordic UART Service.
@@ -109,6 +143,42 @@ void ble_nus_on_ble_evt(ble_nus_t * p_nus, ble_evt_t * p_ble_evt);
  */
 uint32_t ble_nus_string_send(ble_nus_t * p_nus, uint8_t * p_string, uint16_t length);
 
+#ifdef BLE_NUS_STREAM
+/**@brief Function for sending a byte stream to the peer.
+ *
+ * @details The data is added to the transmit FIFO and sent as notifications of up to
+ *          @ref BLE_NUS_MAX_DATA_LEN bytes while the SoftDevice has free transmit buffers. The rest
+ *          is sent as buffers are released. Data sent with @ref ble_nus_string_send does not wait
+ *          for the FIFO, so the two should not be mixed.
+ *
+ * @param[in]    p_nus     Pointer to the Nordic UART Service structure.
+ * @param[in]    p_data    Data to be sent.
+ * @param[inout] p_length  Number of bytes to send. Overwritten with the number of bytes added to
+ *                         the transmit FIFO.
+ *
+ * @retval NRF_SUCCESS              If data was added to the transmit FIFO. Fewer bytes than
+ *                                  requested are added when the FIFO fills up.
+ * @retval NRF_ERROR_NO_MEM         If the transmit FIFO is full.
+ * @retval NRF_ERROR_INVALID_STATE  If there is no connection or notifications are not enabled.
+ */
+uint32_t ble_nus_stream_write(ble_nus_t * p_nus, uint8_t const * p_data, uint32_t * p_length);
+
+/**@brief Function for reading data received from the peer.
+ *
+ * @details The receive handler is only called again once the receive FIFO has been empty, so the
+ *          application should read until NRF_ERROR_NOT_FOUND is returned.
+ *
+ * @param[in]    p_nus     Pointer to the Nordic UART Service structure.
+ * @param[out]   p_data    Buffer for the data.
+ * @param[inout] p_length  Size of the buffer. Overwritten with the number of bytes read.
+ *
+ * @retval NRF_SUCCESS              If data was read.
+ * @retval NRF_ERROR_NOT_FOUND      If the receive FIFO is empty.
+ * @retval NRF_ERROR_INVALID_STATE  If the service was initialized without a receive FIFO.
+ */
+uint32_t ble_nus_stream_read(ble_nus_t * p_nus, uint8_t * p_data, uint32_t * p_length);
+#endif
+
 #endif // BLE_NUS_H__
 
 /** @} */
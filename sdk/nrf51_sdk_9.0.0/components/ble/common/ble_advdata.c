@@ -532,15 +532,17 @@ static uint32_t srdata_check(const ble_advdata_t * p_srdata)
 }
 
 
-uint32_t ble_advdata_set(const ble_advdata_t * p_advdata, const ble_advdata_t * p_srdata)
+uint32_t ble_advdata_encode(const ble_advdata_t * p_advdata,
+                            const ble_advdata_t * p_srdata,
+                            uint8_t             * p_encoded_advdata,
+                            uint8_t             * p_advdata_len,
+                            uint8_t             * p_encoded_srdata,
+                            uint8_t             * p_srdata_len)
 {
-    uint32_t  err_code;
-    uint8_t   len_advdata = 0;
-    uint8_t   len_srdata  = 0;
-    uint8_t   encoded_advdata[BLE_GAP_ADV_MAX_SIZE];
-    uint8_t   encoded_srdata[BLE_GAP_ADV_MAX_SIZE];
-    uint8_t * p_encoded_advdata;
-    uint8_t * p_encoded_srdata;
+    uint32_t err_code;
+
+    *p_advdata_len = 0;
+    *p_srdata_len  = 0;
 
     // Encode advertising data (if supplied).
     if (p_advdata != NULL)
@@ -551,16 +553,11 @@ uint32_t ble_advdata_set(const ble_advdata_t * p_advdata, const ble_advdata_t *
             return err_code;
         }
 
-        err_code = adv_data_encode(p_advdata, encoded_advdata, &len_advdata);
+        err_code = adv_data_encode(p_advdata, p_encoded_advdata, p_advdata_len);
         if (err_code != NRF_SUCCESS)
         {
             return err_code;
         }
-        p_encoded_advdata = encoded_advdata;
-    }
-    else
-    {
-        p_encoded_advdata = NULL;
     }
 
     // Encode scan response data (if supplied).
@@ -572,18 +569,39 @@ uint32_t ble_advdata_set(const ble_advdata_t * p_advdata, const ble_advdata_t *
             return err_code;
         }
 
-        err_code = adv_data_encode(p_srdata, encoded_srdata, &len_srdata);
+        err_code = adv_data_encode(p_srdata, p_encoded_srdata, p_srdata_len);
         if (err_code != NRF_SUCCESS)
         {
             return err_code;
         }
-        p_encoded_srdata = encoded_srdata;
     }
-    else
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_advdata_set(const ble_advdata_t * p_advdata, const ble_advdata_t * p_srdata)
+{
+    uint32_t  err_code;
+    uint8_t   len_advdata = 0;
+    uint8_t   len_srdata  = 0;
+    uint8_t   encoded_advdata[BLE_GAP_ADV_MAX_SIZE];
+    uint8_t   encoded_srdata[BLE_GAP_ADV_MAX_SIZE];
+
+    err_code = ble_advdata_encode(p_advdata,
+                                  p_srdata,
+                                  encoded_advdata,
+                                  &len_advdata,
+                                  encoded_srdata,
+                                  &len_srdata);
+    if (err_code != NRF_SUCCESS)
     {
-        p_encoded_srdata = NULL;
+        return err_code;
     }
 
     // Pass encoded advertising data and/or scan response data to the stack.
-    return sd_ble_gap_adv_data_set(p_encoded_advdata, len_advdata, p_encoded_srdata, len_srdata);
+    return sd_ble_gap_adv_data_set((p_advdata != NULL) ? encoded_advdata : NULL,
+                                   len_advdata,
+                                   (p_srdata != NULL) ? encoded_srdata : NULL,
+                                   len_srdata);
 }
@@ -108,6 +108,35 @@ typedef struct
  */
 uint32_t ble_advdata_set(const ble_advdata_t * p_advdata, const ble_advdata_t * p_srdata);
 
+/**@brief Function for encoding the advertising data and/or scan response data.
+ *
+ * @details This function encodes the data in the same way as @ref ble_advdata_set, but returns it
+ *          instead of passing it to the stack. The encoded data can be kept and given to
+ *          sd_ble_gap_adv_data_set later, to switch between advertising payloads without encoding
+ *          them again.
+ *
+ * @param[in]   p_advdata          Structure for specifying the content of the advertising data.
+ *                                 Set to NULL if advertising data is not to be encoded.
+ * @param[in]   p_srdata           Structure for specifying the content of the scan response data.
+ *                                 Set to NULL if scan response data is not to be encoded.
+ * @param[out]  p_encoded_advdata  Buffer of @ref BLE_GAP_ADV_MAX_SIZE bytes for the encoded
+ *                                 advertising data.
+ * @param[out]  p_advdata_len      Length of the encoded advertising data.
+ * @param[out]  p_encoded_srdata   Buffer of @ref BLE_GAP_ADV_MAX_SIZE bytes for the encoded scan
+ *                                 response data.
+ * @param[out]  p_srdata_len       Length of the encoded scan response data.
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_PARAM if the flags are not valid for the
+ *              data, NRF_ERROR_DATA_SIZE if not all the requested data could fit into the
+ *              advertising packet.
+ */
+uint32_t ble_advdata_encode(const ble_advdata_t * p_advdata,
+                            const ble_advdata_t * p_srdata,
+                            uint8_t             * p_encoded_advdata,
+                            uint8_t             * p_advdata_len,
+                            uint8_t             * p_encoded_srdata,
+                            uint8_t             * p_srdata_len);
+
 #endif // BLE_ADVDATA_H__
 
 /** @} */
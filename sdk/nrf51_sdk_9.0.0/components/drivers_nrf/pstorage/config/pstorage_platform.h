@@ -51,6 +51,10 @@ static __INLINE uint32_t pstorage_flash_page_end()
 #define PSTORAGE_MAX_BLOCK_SIZE     PSTORAGE_FLASH_PAGE_SIZE                                    /**< Maximum size of block that can be registered with the module. Should be configured based on system requirements. And should be greater than or equal to the minimum size. */
 #define PSTORAGE_CMD_QUEUE_SIZE     10                                                          /**< Maximum number of flash access commands that can be maintained by the module for all applications. Configurable. */
 
+#define PSTORAGE_CACHE_SLOT_COUNT   2                                                           /**< Number of blocks held by the write-back cache of pstorage_update, when PSTORAGE_CACHE_ENABLE is defined. */
+#define PSTORAGE_CACHE_BLOCK_SIZE   64                                                          /**< Largest block size that is cached. Updates of larger blocks are queued directly. Must be word aligned. */
+#define PSTORAGE_CACHE_IDLE_COUNT   3                                                           /**< Number of pstorage_cache_idle_process calls without an update after which a cached block is flushed. */
+
 
 /** Abstracts persistently memory block identifier. */
 typedef uint32_t pstorage_block_t;
@@ -180,6 +180,29 @@ typedef struct
 #endif // PSTORAGE_RAW_MODE_ENABLE
 
 
+#ifdef PSTORAGE_CACHE_ENABLE
+/**@brief Write-back cache slot states. */
+typedef enum
+{
+    CACHE_SLOT_FREE,                                                   /**< Slot does not hold a block. */
+    CACHE_SLOT_DIRTY,                                                  /**< Slot holds updates that are not queued for flash yet. */
+    CACHE_SLOT_FLUSHING                                                /**< Slot is being written to flash, its data must not change. */
+} cache_slot_state_t;
+
+/**@brief Write-back cache slot, holding the latest contents of one block. */
+typedef struct
+{
+    uint32_t          data[PSTORAGE_CACHE_BLOCK_SIZE / sizeof(uint32_t)]; /**< Block contents, word aligned for the flash API. */
+    pstorage_handle_t block;                                           /**< Module and address of the cached block. */
+    uint32_t          last_update;                                     /**< Value of the update counter at the last update, used to pick the slot to evict. */
+    uint8_t           state;                                           /**< Slot state, see @ref cache_slot_state_t. */
+    uint8_t           idle_count;                                      /**< Number of idle process calls since the last update. */
+} cache_slot_t;
+
+STATIC_ASSERT((PSTORAGE_CACHE_BLOCK_SIZE % sizeof(uint32_t)) == 0);
+#endif // PSTORAGE_CACHE_ENABLE
+
+
 /**@brief Defines command queue element.
  *
  * @details Defines command queue element. Each element encapsulates needed information to process
@@ -192,6 +215,7 @@ typedef struct
     pstorage_size_t   offset;                                          /**< Offset requested by the application for the access operation. */
     pstorage_handle_t storage_addr;                                    /**< Address/Identifier for persistent memory. */
     uint8_t *         p_data_addr;                                     /**< Address/Identifier for data memory. This is assumed to be resident memory. */
+    uint8_t           request_count;                                   /**< Number of equally sized requests merged into this command. Each one is notified on completion. */
 } cmd_queue_element_t;
 
 
@@ -228,6 +252,19 @@ static uint32_t                m_flags = 0;                            /**< Stor
 static pstorage_raw_module_table_t m_raw_app_table;                    /**< Registered application information table for raw mode. */
 #endif // PSTORAGE_RAW_MODE_ENABLE
 
+#ifdef PSTORAGE_STATS_ENABLE
+static pstorage_stats_t        m_stats;                                /**< Flash access statistics. */
+static uint32_t                m_cmd_flash_op_count;                   /**< Number of flash API calls accepted for the command in progress. */
+#define STATS_ADD(FIELD, VALUE) (m_stats.FIELD += (VALUE))             /**< Adds to a statistics counter. */
+#else
+#define STATS_ADD(FIELD, VALUE)                                        /**< Statistics are disabled. */
+#endif // PSTORAGE_STATS_ENABLE
+
+#ifdef PSTORAGE_CACHE_ENABLE
+static cache_slot_t m_cache[PSTORAGE_CACHE_SLOT_COUNT];                /**< Write-back cache of pstorage_update. */
+static uint32_t     m_cache_update_count;                              /**< Number of updates absorbed by the cache. */
+#endif // PSTORAGE_CACHE_ENABLE
+
 // Required forward declarations.
 static void cmd_process(void);
 static void store_operation_execute(void);
@@ -236,6 +273,10 @@ static void cmd_queue_element_init(uint32_t index);
 static void cmd_queue_dequeue(void);
 static void sm_state_change(pstorage_state_t new_state);
 static void swap_sub_state_state_change(flash_swap_sub_state_t new_state); 
+#ifdef PSTORAGE_CACHE_ENABLE
+static cache_slot_t * cache_slot_of_data_get(uint8_t const * p_data);
+static void cache_flush_complete(cache_slot_t * p_slot, uint32_t result, cmd_queue_element_t * p_elem);
+#endif // PSTORAGE_CACHE_ENABLE
 
 /**@brief Function for consuming a command queue element.
  *
@@ -263,6 +304,11 @@ static void command_queue_element_consume(void)
  */
 static void command_end_procedure_run(void)
 {    
+#ifdef PSTORAGE_STATS_ENABLE
+    m_stats.cmd_count++;
+    m_stats.cmd_flash_op_max = MAX(m_stats.cmd_flash_op_max, m_cmd_flash_op_count);
+#endif // PSTORAGE_STATS_ENABLE
+
     app_notify(NRF_SUCCESS, &m_cmd_queue.cmd[m_cmd_queue.rp]);
     
     command_queue_element_consume();
@@ -307,12 +353,17 @@ static void flash_api_err_code_process(uint32_t err_code)
     switch (err_code)
     {
         case NRF_SUCCESS:
+            STATS_ADD(flash_op_count, 1);
+#ifdef PSTORAGE_STATS_ENABLE
+            m_cmd_flash_op_count++;
+#endif // PSTORAGE_STATS_ENABLE
             break;
             
         case NRF_ERROR_BUSY:
             // Flash access operation was not accepted and must be reissued upon flash operation 
             // complete event.
             m_flags |= MASK_FLASH_API_ERR_BUSY;        
+            STATS_ADD(busy_count, 1);
             break;
             
         default:
@@ -332,7 +383,13 @@ static void flash_write(uint32_t * const       p_dst,
                         uint32_t const * const p_src, 
                         uint32_t               size_in_words)
 {
-    flash_api_err_code_process(sd_flash_write(p_dst, p_src, size_in_words));    
+    const uint32_t err_code = sd_flash_write(p_dst, p_src, size_in_words);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        STATS_ADD(words_written, size_in_words);
+    }
+    flash_api_err_code_process(err_code);    
 }
 
 
@@ -428,7 +485,13 @@ static void state_data_erase_swap_entry_run(void)
  */
 static void flash_page_erase(uint32_t page_number)
 {
-    flash_api_err_code_process(sd_flash_page_erase(page_number));
+    const uint32_t err_code = sd_flash_page_erase(page_number);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        STATS_ADD(pages_erased, 1);
+    }
+    flash_api_err_code_process(err_code);
 }
 
 
@@ -593,6 +656,7 @@ static void cmd_queue_element_init(uint32_t index)
     m_cmd_queue.cmd[index].storage_addr.block_id  = 0;
     m_cmd_queue.cmd[index].p_data_addr            = NULL;
     m_cmd_queue.cmd[index].offset                 = 0;
+    m_cmd_queue.cmd[index].request_count          = 0;
 }
 
 
@@ -610,6 +674,84 @@ static void cmd_queue_init(void)
 }
 
 
+/**@brief Function for merging a flash access operation into the last queued command.
+ *
+ * @details Store requests of whole blocks, and clear requests of the same size, are merged when 
+ *          they continue the last queued command of the same module, in flash and for stores in 
+ *          data memory. The merged command is executed as one, so a run of blocks is written with 
+ *          one flash API call per page and takes one queue element. The command in progress is 
+ *          never extended.
+ *
+ * @param[in] opcode         Identifies the operation requested to be enqueued.
+ * @param[in] p_storage_addr Identifies the module and flash address on which the operation is 
+ *                           requested.
+ * @param[in] p_data_addr    Identifies the data address for flash access.
+ * @param[in] size           Size in bytes of data requested for the access operation.
+ * @param[in] offset         Offset within the flash memory block at which operation is requested.
+ *
+ * @retval    true  If the operation was merged.
+ * @retval    false If the operation needs its own queue element.
+ */
+static bool cmd_queue_merge(uint8_t             opcode,
+                            pstorage_handle_t * p_storage_addr,
+                            uint8_t           * p_data_addr,
+                            pstorage_size_t     size,
+                            pstorage_size_t     offset)
+{
+    uint32_t              last_index;
+    cmd_queue_element_t * p_last;
+
+    if ((m_cmd_queue.count < 2)                                    ||
+        (p_storage_addr->module_id >= PSTORAGE_NUM_OF_PAGES)       ||
+        (offset != 0))
+    {
+        return false;
+    }
+
+    last_index = m_cmd_queue.rp + m_cmd_queue.count - 1;
+    if (last_index >= PSTORAGE_CMD_QUEUE_SIZE) 
+    {
+        last_index -= PSTORAGE_CMD_QUEUE_SIZE;
+    }
+    p_last = &m_cmd_queue.cmd[last_index];
+
+    if ((p_last->op_code != opcode)                                                    ||
+        (p_last->storage_addr.module_id != p_storage_addr->module_id)                  ||
+        (p_last->offset != 0)                                                          ||
+        (p_last->request_count == UINT8_MAX)                                           ||
+        ((uint32_t)p_last->size + size > UINT16_MAX)                                   ||
+        (p_last->size / p_last->request_count != size)                                 ||
+        (p_last->storage_addr.block_id + p_last->size != p_storage_addr->block_id))
+    {
+        return false;
+    }
+
+    if (opcode == PSTORAGE_STORE_OP_CODE)
+    {
+        if ((size != MODULE_BLOCK_SIZE(p_storage_addr)) ||
+            (p_last->p_data_addr + p_last->size != p_data_addr))
+        {
+            return false;
+        }
+#ifdef PSTORAGE_CACHE_ENABLE
+        if (cache_slot_of_data_get(p_last->p_data_addr) != NULL)
+        {
+            return false;
+        }
+#endif // PSTORAGE_CACHE_ENABLE
+    }
+    else if (opcode != PSTORAGE_CLEAR_OP_CODE)
+    {
+        return false;
+    }
+
+    p_last->size += size;
+    p_last->request_count++;
+
+    return true;
+}
+
+
 /**@brief Function for enqueuing, and possibly dispatching, a flash access operation.
  *
  * @param[in] opcode         Identifies the operation requested to be enqueued.
@@ -630,7 +772,12 @@ static uint32_t cmd_queue_enqueue(uint8_t             opcode,
 {
     uint32_t err_code;
 
-    if (m_cmd_queue.count != PSTORAGE_CMD_QUEUE_SIZE)
+    if (cmd_queue_merge(opcode, p_storage_addr, p_data_addr, size, offset))
+    {
+        STATS_ADD(merge_count, 1);
+        err_code = NRF_SUCCESS;
+    }
+    else if (m_cmd_queue.count != PSTORAGE_CMD_QUEUE_SIZE)
     {
         // Enqueue the command if it the queue is not full.
         uint32_t write_index = m_cmd_queue.rp + m_cmd_queue.count;
@@ -643,10 +790,15 @@ static uint32_t cmd_queue_enqueue(uint8_t             opcode,
         m_cmd_queue.cmd[write_index].op_code      = opcode;
         m_cmd_queue.cmd[write_index].p_data_addr  = p_data_addr;
         m_cmd_queue.cmd[write_index].storage_addr = (*p_storage_addr);
-        m_cmd_queue.cmd[write_index].size         = size;
-        m_cmd_queue.cmd[write_index].offset       = offset;
+        m_cmd_queue.cmd[write_index].size          = size;
+        m_cmd_queue.cmd[write_index].offset        = offset;
+        m_cmd_queue.cmd[write_index].request_count = 1;
                
         m_cmd_queue.count++;
+
+#ifdef PSTORAGE_STATS_ENABLE
+        m_stats.queue_high_water = MAX(m_stats.queue_high_water, m_cmd_queue.count);
+#endif // PSTORAGE_STATS_ENABLE
                                 
         if (m_state == STATE_IDLE)
         {
@@ -685,6 +837,16 @@ static void app_notify(uint32_t result, cmd_queue_element_t * p_elem)
     pstorage_ntf_cb_t ntf_cb;
     const uint8_t     op_code = p_elem->op_code;
 
+#ifdef PSTORAGE_CACHE_ENABLE
+    // Flushes of the cache are not requested by the application.
+    cache_slot_t * p_slot = cache_slot_of_data_get(p_elem->p_data_addr);
+    if (p_slot != NULL)
+    {
+        cache_flush_complete(p_slot, result, p_elem);
+        return;
+    }
+#endif // PSTORAGE_CACHE_ENABLE
+
 #ifdef PSTORAGE_RAW_MODE_ENABLE
     if (p_elem->storage_addr.module_id == RAW_MODE_APP_ID)
     {
@@ -696,7 +858,28 @@ static void app_notify(uint32_t result, cmd_queue_element_t * p_elem)
         ntf_cb = m_app_table[p_elem->storage_addr.module_id].cb;
     }
 
-    ntf_cb(&p_elem->storage_addr, op_code, result, p_elem->p_data_addr, m_app_data_size);
+    if (p_elem->request_count > 1)
+    {
+        // Notify each of the merged requests as if it was executed on its own.
+        const uint32_t    request_size = m_app_data_size / p_elem->request_count;
+        pstorage_handle_t block        = p_elem->storage_addr;
+        uint8_t *         p_data       = p_elem->p_data_addr;
+
+        for (uint32_t index = 0; index < p_elem->request_count; index++)
+        {
+            ntf_cb(&block, op_code, result, p_data, request_size);
+
+            block.block_id += request_size;
+            if (p_data != NULL)
+            {
+                p_data += request_size;
+            }
+        }
+    }
+    else
+    {
+        ntf_cb(&p_elem->storage_addr, op_code, result, p_elem->p_data_addr, m_app_data_size);
+    }
 }
 
 
@@ -1240,11 +1423,44 @@ static void store_operation_execute(void)
 }
  
 
+/**@brief Function for checking if an update can be written without erasing.
+ *
+ * @details Writing flash can only clear bits. If the new data sets no bit that is cleared in 
+ *          flash, the update is done as a store, and the swap and erase steps are skipped.
+ *
+ * @retval    true  If the update only clears bits.
+ * @retval    false If the update needs an erase.
+ */
+static bool is_update_without_erase(void)
+{
+    const cmd_queue_element_t * p_cmd   = &m_cmd_queue.cmd[m_cmd_queue.rp];
+    const uint32_t            * p_flash = (uint32_t *)(p_cmd->storage_addr.block_id + p_cmd->offset);
+    const uint32_t            * p_data  = (uint32_t *)p_cmd->p_data_addr;
+
+    for (uint32_t index = 0; index < (p_cmd->size / sizeof(uint32_t)); index++)
+    {
+        if ((p_flash[index] & p_data[index]) != p_data[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 /**@brief Function for executing the update operation.
  */ 
 static void update_operation_execute(void)
 {
-    clear_operation_execute();
+    if (is_update_without_erase())
+    {
+        store_operation_execute();
+    }
+    else
+    {
+        clear_operation_execute();
+    }
 }
 
 
@@ -1255,6 +1471,10 @@ static void cmd_process(void)
     const cmd_queue_element_t * p_cmd = &m_cmd_queue.cmd[m_cmd_queue.rp];
     m_app_data_size                   = p_cmd->size;
 
+#ifdef PSTORAGE_STATS_ENABLE
+    m_cmd_flash_op_count = 0;
+#endif // PSTORAGE_STATS_ENABLE
+
     switch (p_cmd->op_code)
     {
         case PSTORAGE_STORE_OP_CODE:                   
@@ -1276,6 +1496,311 @@ static void cmd_process(void)
 }
 
 
+#ifdef PSTORAGE_CACHE_ENABLE
+/**@brief Function for finding the cache slot holding a block.
+ *
+ * @param[in] block_id Address of the block.
+ *
+ * @return    Pointer to the slot, or NULL if the block is not cached.
+ */
+static cache_slot_t * cache_slot_get(pstorage_block_t block_id)
+{
+    for (uint32_t index = 0; index < PSTORAGE_CACHE_SLOT_COUNT; index++)
+    {
+        if ((m_cache[index].state != CACHE_SLOT_FREE) && (m_cache[index].block.block_id == block_id))
+        {
+            return &m_cache[index];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**@brief Function for finding the cache slot a flush command writes from.
+ *
+ * @param[in] p_data Data address of a queued command.
+ *
+ * @return    Pointer to the slot, or NULL if the data is not in the cache.
+ */
+static cache_slot_t * cache_slot_of_data_get(uint8_t const * p_data)
+{
+    for (uint32_t index = 0; index < PSTORAGE_CACHE_SLOT_COUNT; index++)
+    {
+        if ((p_data >= (uint8_t *)m_cache[index].data) &&
+            (p_data <  (uint8_t *)m_cache[index].data + sizeof(m_cache[index].data)))
+        {
+            return &m_cache[index];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**@brief Function for checking if a queued command accesses a flash area.
+ *
+ * @param[in] start Start address of the area.
+ * @param[in] size  Size of the area in bytes.
+ *
+ * @retval    true  If a queued command overlaps the area.
+ * @retval    false If no queued command overlaps the area.
+ */
+static bool cmd_queue_area_pending(uint32_t start, uint32_t size)
+{
+    uint32_t index = m_cmd_queue.rp;
+
+    for (uint32_t count = 0; count < m_cmd_queue.count; count++)
+    {
+        const cmd_queue_element_t * p_cmd     = &m_cmd_queue.cmd[index];
+        const uint32_t              cmd_start = p_cmd->storage_addr.block_id + p_cmd->offset;
+
+        if ((cmd_start < start + size) && (start < cmd_start + p_cmd->size))
+        {
+            return true;
+        }
+
+        if (++index == PSTORAGE_CMD_QUEUE_SIZE)
+        {
+            index = 0;
+        }
+    }
+
+    return false;
+}
+
+
+/**@brief Function for queuing the write of a cache slot to flash.
+ *
+ * @details Only the words that differ from flash are written. If no differing word needs a bit 
+ *          set, the words are stored without erasing the page, otherwise the block is updated 
+ *          through the swap page. A slot that matches flash is released right away.
+ *
+ * @param[in] p_slot Dirty slot to flush.
+ *
+ * @retval    NRF_SUCCESS      If the slot is queued or released.
+ * @retval    NRF_ERROR_NO_MEM If the command queue is full. The slot stays dirty.
+ */
+static uint32_t cache_slot_flush(cache_slot_t * p_slot)
+{
+    const uint32_t * p_flash    = (uint32_t *)p_slot->block.block_id;
+    const uint32_t   word_count = MODULE_BLOCK_SIZE(&p_slot->block) / sizeof(uint32_t);
+    uint32_t         first      = word_count;
+    uint32_t         last       = 0;
+    bool             erase      = false;
+    uint32_t         err_code;
+
+    for (uint32_t index = 0; index < word_count; index++)
+    {
+        if (p_flash[index] != p_slot->data[index])
+        {
+            if (first == word_count)
+            {
+                first = index;
+            }
+            last = index;
+
+            if ((p_flash[index] & p_slot->data[index]) != p_slot->data[index])
+            {
+                erase = true;
+            }
+        }
+    }
+
+    if (first == word_count)
+    {
+        p_slot->state = CACHE_SLOT_FREE;
+        return NRF_SUCCESS;
+    }
+
+    // The slot is marked before queuing, as a failing flash API call completes the command 
+    // right away.
+    p_slot->state = CACHE_SLOT_FLUSHING;
+
+    if (erase)
+    {
+        err_code = cmd_queue_enqueue(PSTORAGE_UPDATE_OP_CODE,
+                                     &p_slot->block,
+                                     (uint8_t *)p_slot->data,
+                                     word_count * sizeof(uint32_t),
+                                     0);
+    }
+    else
+    {
+        err_code = cmd_queue_enqueue(PSTORAGE_STORE_OP_CODE,
+                                     &p_slot->block,
+                                     (uint8_t *)&p_slot->data[first],
+                                     (last - first + 1) * sizeof(uint32_t),
+                                     first * sizeof(uint32_t));
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        p_slot->state = CACHE_SLOT_DIRTY;
+    }
+
+    return err_code;
+}
+
+
+/**@brief Function for handling the completion of a cache flush.
+ *
+ * @param[in] p_slot Slot that was flushed.
+ * @param[in] result Result code of the flush.
+ * @param[in] p_elem Command queue element of the flush.
+ */
+static void cache_flush_complete(cache_slot_t * p_slot, uint32_t result, cmd_queue_element_t * p_elem)
+{
+    p_slot->state = CACHE_SLOT_FREE;
+
+    if (result != NRF_SUCCESS)
+    {
+        m_app_table[p_elem->storage_addr.module_id].cb(&p_elem->storage_addr,
+                                                       PSTORAGE_UPDATE_OP_CODE,
+                                                       result,
+                                                       NULL,
+                                                       0);
+    }
+}
+
+
+/**@brief Function for taking a free cache slot.
+ *
+ * @details When all slots are in use, the least recently updated dirty slot is flushed, so it is 
+ *          free for a later update.
+ *
+ * @return    Pointer to a free slot, or NULL if none is free.
+ */
+static cache_slot_t * cache_slot_alloc(void)
+{
+    cache_slot_t * p_oldest = NULL;
+
+    for (uint32_t index = 0; index < PSTORAGE_CACHE_SLOT_COUNT; index++)
+    {
+        cache_slot_t * p_slot = &m_cache[index];
+
+        if (p_slot->state == CACHE_SLOT_FREE)
+        {
+            return p_slot;
+        }
+        if ((p_slot->state == CACHE_SLOT_DIRTY) &&
+            ((p_oldest == NULL) || (p_slot->last_update < p_oldest->last_update)))
+        {
+            p_oldest = p_slot;
+        }
+    }
+
+    if (p_oldest != NULL)
+    {
+        UNUSED_VARIABLE(cache_slot_flush(p_oldest));
+    }
+
+    return NULL;
+}
+
+
+/**@brief Function for merging an update into the cache.
+ *
+ * @details The block is loaded into a slot at its first update. Blocks that are larger than the 
+ *          cache slots, are being flushed or have queued commands are not cached, so the update is 
+ *          queued behind the earlier commands.
+ *
+ * @param[in] p_dest Block to update.
+ * @param[in] p_src  Data to write.
+ * @param[in] size   Size of the data in bytes.
+ * @param[in] offset Offset in the block.
+ *
+ * @retval    true  If the update was merged into the cache and the application notified.
+ * @retval    false If the update must be queued.
+ */
+static bool cache_update(pstorage_handle_t * p_dest,
+                         uint8_t           * p_src,
+                         pstorage_size_t     size,
+                         pstorage_size_t     offset)
+{
+    const pstorage_size_t block_size = MODULE_BLOCK_SIZE(p_dest);
+    cache_slot_t *        p_slot;
+
+    if ((block_size > PSTORAGE_CACHE_BLOCK_SIZE) ||
+        (((p_dest->block_id - m_app_table[p_dest->module_id].base_id) % block_size) != 0))
+    {
+        return false;
+    }
+
+    p_slot = cache_slot_get(p_dest->block_id);
+    if (p_slot == NULL)
+    {
+        if (cmd_queue_area_pending(p_dest->block_id, block_size))
+        {
+            return false;
+        }
+
+        p_slot = cache_slot_alloc();
+        if (p_slot == NULL)
+        {
+            return false;
+        }
+
+        p_slot->block = (*p_dest);
+        p_slot->state = CACHE_SLOT_DIRTY;
+        memcpy(p_slot->data, (uint8_t *)p_dest->block_id, block_size);
+    }
+    else if (p_slot->state != CACHE_SLOT_DIRTY)
+    {
+        return false;
+    }
+
+    memcpy((uint8_t *)p_slot->data + offset, p_src, size);
+    p_slot->idle_count  = 0;
+    p_slot->last_update = ++m_cache_update_count;
+
+    // The data is copied, so the application may reuse its buffer.
+    m_app_table[p_dest->module_id].cb(p_dest, PSTORAGE_UPDATE_OP_CODE, NRF_SUCCESS, p_src, size);
+
+    return true;
+}
+
+
+/**@brief Function for preparing the cache for a store or clear command on a flash area.
+ *
+ * @details Dirty blocks in the area are flushed first, so the command is applied on top of them. 
+ *          When the area is cleared, the dirty blocks are dropped instead.
+ *
+ * @param[in] start Start address of the area.
+ * @param[in] size  Size of the area in bytes.
+ * @param[in] clear True if the area is cleared.
+ *
+ * @retval    NRF_SUCCESS      If the command can be queued.
+ * @retval    NRF_ERROR_NO_MEM If a dirty block could not be queued.
+ */
+static uint32_t cache_area_sync(uint32_t start, uint32_t size, bool clear)
+{
+    for (uint32_t index = 0; index < PSTORAGE_CACHE_SLOT_COUNT; index++)
+    {
+        cache_slot_t * p_slot      = &m_cache[index];
+        const uint32_t block_start = p_slot->block.block_id;
+
+        if ((p_slot->state == CACHE_SLOT_DIRTY) &&
+            (block_start < start + size) &&
+            (start < block_start + MODULE_BLOCK_SIZE(&p_slot->block)))
+        {
+            if (clear)
+            {
+                // Clear commands cover whole blocks.
+                p_slot->state = CACHE_SLOT_FREE;
+            }
+            else if (cache_slot_flush(p_slot) != NRF_SUCCESS)
+            {
+                return NRF_ERROR_NO_MEM;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+#endif // PSTORAGE_CACHE_ENABLE
+
+
 uint32_t pstorage_init(void)
 {
     cmd_queue_init();
@@ -1295,6 +1820,15 @@ uint32_t pstorage_init(void)
     m_raw_app_table.cb           = NULL;
 #endif //PSTORAGE_RAW_MODE_ENABLE
 
+#ifdef PSTORAGE_STATS_ENABLE
+    memset(&m_stats, 0, sizeof(m_stats));
+#endif // PSTORAGE_STATS_ENABLE
+
+#ifdef PSTORAGE_CACHE_ENABLE
+    memset(m_cache, 0, sizeof(m_cache));
+    m_cache_update_count = 0;
+#endif // PSTORAGE_CACHE_ENABLE
+
     m_state                     = STATE_IDLE;
     m_num_of_command_retries    = 0;
     m_flags                     = 0;
@@ -1386,6 +1920,13 @@ uint32_t pstorage_store(pstorage_handle_t * p_dest,
         return NRF_ERROR_INVALID_ADDR;
     }
 
+#ifdef PSTORAGE_CACHE_ENABLE
+    if (cache_area_sync(p_dest->block_id + offset, size, false) != NRF_SUCCESS)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+#endif // PSTORAGE_CACHE_ENABLE
+
     return cmd_queue_enqueue(PSTORAGE_STORE_OP_CODE, p_dest, p_src, size, offset);
 }
 
@@ -1410,6 +1951,13 @@ uint32_t pstorage_update(pstorage_handle_t * p_dest,
         return NRF_ERROR_INVALID_ADDR;
     }
 
+#ifdef PSTORAGE_CACHE_ENABLE
+    if (cache_update(p_dest, p_src, size, offset))
+    {
+        return NRF_SUCCESS;
+    }
+#endif // PSTORAGE_CACHE_ENABLE
+
     return cmd_queue_enqueue(PSTORAGE_UPDATE_OP_CODE, p_dest, p_src, size, offset);
 }
 
@@ -1434,7 +1982,18 @@ uint32_t pstorage_load(uint8_t           * p_dest,
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    memcpy(p_dest, (((uint8_t *)p_src->block_id) + offset), size);
+#ifdef PSTORAGE_CACHE_ENABLE
+    // Cached updates are newer than flash.
+    const cache_slot_t * p_slot = cache_slot_get(p_src->block_id);
+    if (p_slot != NULL)
+    {
+        memcpy(p_dest, ((uint8_t *)p_slot->data) + offset, size);
+    }
+    else
+#endif // PSTORAGE_CACHE_ENABLE
+    {
+        memcpy(p_dest, (((uint8_t *)p_src->block_id) + offset), size);
+    }
 
     m_app_table[p_src->module_id].cb(p_src, PSTORAGE_LOAD_OP_CODE, NRF_SUCCESS, p_dest, size);
 
@@ -1482,6 +2041,10 @@ uint32_t pstorage_clear(pstorage_handle_t * p_dest, pstorage_size_t size)
     {        
         return NRF_ERROR_INVALID_PARAM;            
     }
+
+#ifdef PSTORAGE_CACHE_ENABLE
+    UNUSED_VARIABLE(cache_area_sync(p_dest->block_id, size, true));
+#endif // PSTORAGE_CACHE_ENABLE
     
     return cmd_queue_enqueue(PSTORAGE_CLEAR_OP_CODE, p_dest, NULL, size, 0);
 }
@@ -1497,6 +2060,65 @@ uint32_t pstorage_access_status_get(uint32_t * p_count)
     return NRF_SUCCESS;
 }
 
+#ifdef PSTORAGE_STATS_ENABLE
+
+uint32_t pstorage_stats_get(pstorage_stats_t * p_stats)
+{
+    VERIFY_MODULE_INITIALIZED();
+    NULL_PARAM_CHECK(p_stats);
+
+    (*p_stats) = m_stats;
+
+    return NRF_SUCCESS;
+}
+
+#endif // PSTORAGE_STATS_ENABLE
+
+#ifdef PSTORAGE_CACHE_ENABLE
+
+uint32_t pstorage_cache_flush(void)
+{
+    VERIFY_MODULE_INITIALIZED();
+
+    for (uint32_t index = 0; index < PSTORAGE_CACHE_SLOT_COUNT; index++)
+    {
+        if (m_cache[index].state == CACHE_SLOT_DIRTY)
+        {
+            uint32_t err_code = cache_slot_flush(&m_cache[index]);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t pstorage_cache_idle_process(void)
+{
+    VERIFY_MODULE_INITIALIZED();
+
+    for (uint32_t index = 0; index < PSTORAGE_CACHE_SLOT_COUNT; index++)
+    {
+        cache_slot_t * p_slot = &m_cache[index];
+
+        if ((p_slot->state == CACHE_SLOT_DIRTY) && (++p_slot->idle_count >= PSTORAGE_CACHE_IDLE_COUNT))
+        {
+            uint32_t err_code = cache_slot_flush(p_slot);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+#endif // PSTORAGE_CACHE_ENABLE
+
 #ifdef PSTORAGE_RAW_MODE_ENABLE
 
 uint32_t pstorage_raw_register(pstorage_module_param_t * p_module_param,
@@ -91,6 +91,21 @@ typedef struct
     pstorage_size_t   block_count;    /** Number of blocks requested by the module; minimum values is 1. */
 } pstorage_module_param_t;
 
+#ifdef PSTORAGE_STATS_ENABLE
+/**@brief Flash access statistics, available when PSTORAGE_STATS_ENABLE is defined. */
+typedef struct
+{
+    uint32_t cmd_count;                /**< Number of commands completed. */
+    uint32_t merge_count;              /**< Number of store and clear requests merged into a queued command. */
+    uint32_t flash_op_count;           /**< Number of flash write and erase calls accepted by the SoftDevice. */
+    uint32_t busy_count;               /**< Number of flash calls rejected as busy and issued again. */
+    uint32_t words_written;            /**< Number of words written to flash. */
+    uint32_t pages_erased;             /**< Number of flash pages erased. */
+    uint32_t cmd_flash_op_max;         /**< Largest number of flash calls needed by one command, the latency of the slowest command in flash operations. */
+    uint32_t queue_high_water;         /**< Largest number of commands queued at the same time. */
+} pstorage_stats_t;
+#endif // PSTORAGE_STATS_ENABLE
+
 /**@} */
 
 /**@defgroup pstorage_routines Persistent Storage Access Routines
@@ -189,6 +204,11 @@ uint32_t pstorage_block_identifier_get(pstorage_handle_t * p_base_id,
  * @retval     NRF_ERROR_INVALID_ADDR  Operation failure. Parameter is not aligned.
  * @retval     NRF_ERROR_NO_MEM        Operation failure. No storage space available.
  *
+ * @note       A store of a whole block that follows the last queued store of the module, both in 
+ *             flash and in data memory, is merged into it. Storing a table block by block from one 
+ *             array therefore takes one queue element and one flash call per page. Each block is 
+ *             still notified separately.
+ *
  * @warning    No copy of the data is made, meaning memory provided for the data source that is to 
  *             be written to flash cannot be freed or reused by the application until this procedure
  *             is complete. The application is notified when the procedure is finished using the
@@ -293,6 +313,61 @@ uint32_t pstorage_clear(pstorage_handle_t * p_base_id, pstorage_size_t size);
  */
 uint32_t pstorage_access_status_get(uint32_t * p_count);
 
+#ifdef PSTORAGE_STATS_ENABLE
+
+/**@brief Function for getting the flash access statistics.
+ *
+ * @details Throughput can be computed from words_written and pages_erased over a time window, and 
+ *          flash_op_count / cmd_count gives the average number of flash calls per command.
+ *
+ * @param[out] p_stats Statistics since @ref pstorage_init.
+ *
+ * @retval     NRF_SUCCESS             Operation success.
+ * @retval     NRF_ERROR_INVALID_STATE Operation failure. API is called without module 
+ *                                     initialization.
+ * @retval     NRF_ERROR_NULL          Operation failure. NULL parameter has been passed.
+ */
+uint32_t pstorage_stats_get(pstorage_stats_t * p_stats);
+
+#endif // PSTORAGE_STATS_ENABLE
+
+#ifdef PSTORAGE_CACHE_ENABLE
+
+/**@brief Function for writing all cached updates to flash.
+ *
+ * @details With PSTORAGE_CACHE_ENABLE defined, @ref pstorage_update copies the data of blocks up 
+ *          to PSTORAGE_CACHE_BLOCK_SIZE bytes into a RAM cache and notifies the application right 
+ *          away. Later updates of the same block are merged in RAM, and the block is written to 
+ *          flash only when it is flushed. A flush that only clears bits is written without erasing 
+ *          the page. Cached updates are not counted by @ref pstorage_access_status_get until they 
+ *          are flushed, so call this function before a reset or system off.
+ *
+ * @note       A flush error is reported to the module with the PSTORAGE_UPDATE_OP_CODE op code and 
+ *             a NULL data pointer.
+ *
+ * @retval     NRF_SUCCESS             Operation success. All cached updates are queued.
+ * @retval     NRF_ERROR_INVALID_STATE Operation failure. API is called without module 
+ *                                     initialization.
+ * @retval     NRF_ERROR_NO_MEM        Operation failure. The command queue is full, the remaining 
+ *                                     updates stay cached.
+ */
+uint32_t pstorage_cache_flush(void);
+
+/**@brief Function for flushing cached blocks that have not been updated for a while.
+ *
+ * @details Call this function periodically, for example from an application timer. A cached block 
+ *          is flushed when it has not been updated for PSTORAGE_CACHE_IDLE_COUNT calls.
+ *
+ * @retval     NRF_SUCCESS             Operation success.
+ * @retval     NRF_ERROR_INVALID_STATE Operation failure. API is called without module 
+ *                                     initialization.
+ * @retval     NRF_ERROR_NO_MEM        Operation failure. The command queue is full, the remaining 
+ *                                     updates stay cached.
+ */
+uint32_t pstorage_cache_idle_process(void);
+
+#endif // PSTORAGE_CACHE_ENABLE
+
 #ifdef PSTORAGE_RAW_MODE_ENABLE
 
 /**@brief Function for registering with the persistent storage interface.
@@ -461,6 +461,30 @@ uint32_t app_uart_put(uint8_t byte)
 }
 
 
+uint32_t app_uart_write_reserve(uint8_t ** pp_span, uint32_t * p_size)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+uint32_t app_uart_write_commit(uint32_t size)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+uint32_t app_uart_read_peek(uint8_t ** pp_span, uint32_t * p_size)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+uint32_t app_uart_read_commit(uint32_t size)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
 uint32_t app_uart_flush(void)
 {
     return NRF_SUCCESS;
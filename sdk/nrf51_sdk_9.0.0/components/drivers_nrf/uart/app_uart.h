@@ -233,6 +233,57 @@ uint32_t app_uart_get(uint8_t * p_byte);
  */
 uint32_t app_uart_put(uint8_t byte);
 
+/**@brief Function for reserving a contiguous span of free space in the TX buffer.
+ *
+ * @details Lets a producer that generates data in blocks, for example an encoder, write straight
+ *          to the TX buffer instead of calling @ref app_uart_put for every byte. Fill the span and
+ *          start its transmission with @ref app_uart_write_commit. Only valid if FIFO is used.
+ *
+ * @param[out] pp_span  Start of the contiguous free span.
+ * @param[out] p_size   Number of bytes available in the span.
+ *
+ * @retval NRF_SUCCESS              If a span was returned.
+ * @retval NRF_ERROR_NO_MEM         If the TX buffer is full.
+ * @retval NRF_ERROR_NOT_SUPPORTED  If the app_uart module is used without FIFO.
+ */
+uint32_t app_uart_write_reserve(uint8_t ** pp_span, uint32_t * p_size);
+
+/**@brief Function for transmitting the bytes written after @ref app_uart_write_reserve.
+ *
+ * @param[in] size  Number of bytes written to the reserved span.
+ *
+ * @retval NRF_SUCCESS               If the bytes were put on the TX buffer for transmission.
+ * @retval NRF_ERROR_INVALID_LENGTH  If size is larger than the free space in the TX buffer.
+ * @retval NRF_ERROR_NOT_SUPPORTED   If the app_uart module is used without FIFO.
+ */
+uint32_t app_uart_write_commit(uint32_t size);
+
+/**@brief Function for peeking at the contiguous span of received bytes at the head of the RX buffer.
+ *
+ * @details Lets a consumer process received data in place instead of calling @ref app_uart_get
+ *          for every byte. Release the processed bytes with @ref app_uart_read_commit. As with
+ *          @ref app_uart_get, APP_UART_DATA_READY is generated again only when a byte is received
+ *          while the RX buffer is empty. Only valid if FIFO is used.
+ *
+ * @param[out] pp_span  Start of the contiguous data span.
+ * @param[out] p_size   Number of bytes available in the span.
+ *
+ * @retval NRF_SUCCESS              If a span was returned.
+ * @retval NRF_ERROR_NOT_FOUND      If no byte is available in the RX buffer.
+ * @retval NRF_ERROR_NOT_SUPPORTED  If the app_uart module is used without FIFO.
+ */
+uint32_t app_uart_read_peek(uint8_t ** pp_span, uint32_t * p_size);
+
+/**@brief Function for releasing bytes processed after @ref app_uart_read_peek.
+ *
+ * @param[in] size  Number of bytes to remove from the head of the RX buffer.
+ *
+ * @retval NRF_SUCCESS               If the bytes were removed.
+ * @retval NRF_ERROR_INVALID_LENGTH  If size is larger than the number of bytes in the RX buffer.
+ * @retval NRF_ERROR_NOT_SUPPORTED   If the app_uart module is used without FIFO.
+ */
+uint32_t app_uart_read_commit(uint32_t size);
+
 /**@brief Function for getting the current state of the UART.
  *
  * @details If flow control is disabled, the state is assumed to always be APP_UART_CONNECTED.
@@ -510,6 +510,36 @@ uint32_t app_uart_put(uint8_t byte)
 }
 
 
+uint32_t app_uart_write_reserve(uint8_t ** pp_span, uint32_t * p_size)
+{
+    return app_fifo_write_reserve(&m_tx_fifo, pp_span, p_size);
+}
+
+
+uint32_t app_uart_write_commit(uint32_t size)
+{
+    uint32_t err_code;
+
+    err_code = app_fifo_write_commit(&m_tx_fifo, size);
+
+    on_uart_event(ON_UART_PUT);
+
+    return err_code;
+}
+
+
+uint32_t app_uart_read_peek(uint8_t ** pp_span, uint32_t * p_size)
+{
+    return app_fifo_read_peek(&m_rx_fifo, pp_span, p_size);
+}
+
+
+uint32_t app_uart_read_commit(uint32_t size)
+{
+    return app_fifo_read_commit(&m_rx_fifo, size);
+}
+
+
 uint32_t app_uart_flush(void)
 {
     uint32_t err_code;
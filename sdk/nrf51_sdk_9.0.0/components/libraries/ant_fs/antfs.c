@@ -128,6 +128,11 @@ All rights reserved.
 #define ANTFS_EVENT_QUEUE_SIZE             0x04u                         /**< ANT-FS event queue size. */
 #define SAVE_DISTANCE                       256u                         /**< Save distance required because of nRF buffer to line up data offset on retry. */
 
+#ifdef ANTFS_DOWNLOAD_SOURCE
+#define DOWNLOAD_BLOCK_SIZE                (ANTFS_BURST_BLOCK_SIZE * BURST_PACKET_SIZE) /**< Size of a block read from the download source. */
+#define DOWNLOAD_RING_SIZE                 2u                            /**< Number of blocks read from the download source, one on air and one prefetched. */
+#endif // ANTFS_DOWNLOAD_SOURCE
+
 // Buffer Indices.
 #define BUFFER_INDEX_MESG_SIZE             0x00u                         /**< ANT message buffer index length offset. */
 #define BUFFER_INDEX_MESG_ID               0x01u                         /**< ANT message buffer index ID offset. */
@@ -209,6 +214,17 @@ static antfs_event_queue_t m_event_queue;                                 /**< E
 
 static antfs_burst_wait_handler_t m_burst_wait_handler = NULL;            /**< Burst wait handler */
 
+#ifdef ANTFS_DOWNLOAD_SOURCE
+// Download source.
+static antfs_download_source_t m_download_source = NULL;                  /**< Download source, NULL if data is requested with events. */
+static uint8_t  m_download_ring[DOWNLOAD_RING_SIZE][DOWNLOAD_BLOCK_SIZE]; /**< Blocks read from the download source. */
+static uint32_t m_download_ring_offset[DOWNLOAD_RING_SIZE];               /**< File offset of each block. */
+static uint32_t m_download_ring_bytes[DOWNLOAD_RING_SIZE];                /**< Number of bytes in each block, 0 if empty. */
+static bool     m_is_source_request_pending;                              /**< Next block is to be read from the download source. */
+static bool     m_is_source_running;                                      /**< Blocks are being sent from the download source. */
+static bool     m_is_source_stopped;                                      /**< Burst failed, no more blocks are read until the next download. */
+#endif // ANTFS_DOWNLOAD_SOURCE
+
 
 const char * antfs_hostname_get(void)
 {
@@ -657,6 +673,121 @@ static void download_request_response_transmit(uint8_t response)
 }
 
 
+/**@brief Function for requesting the next block of download data.
+ *
+ * The block is read from the download source if one is set, otherwise it is requested from the
+ * application with an event.
+ */
+static void download_data_request(void)
+{
+#ifdef ANTFS_DOWNLOAD_SOURCE
+    if (m_download_source != NULL)
+    {
+        // Read by download_source_run when the current block has been handed to the burst handler.
+        m_is_source_request_pending = true;
+        return;
+    }
+#endif // ANTFS_DOWNLOAD_SOURCE
+
+    event_queue_write(ANTFS_EVENT_DOWNLOAD_REQUEST_DATA);
+}
+
+
+#ifdef ANTFS_DOWNLOAD_SOURCE
+/**@brief Function for getting a block of download data, reading it from the download source if it
+ *        has not been prefetched.
+ *
+ * @param[in] offset           File offset of the block.
+ * @param[in] num_bytes        Size of the block.
+ * @param[in] p_busy           Block held by the burst handler, which must not be overwritten.
+ *
+ * @return Pointer to the block, or NULL if the download source did not provide the data.
+ */
+static const uint8_t * download_block_get(uint32_t offset,
+                                          uint32_t num_bytes,
+                                          const uint8_t * p_busy)
+{
+    uint32_t i;
+
+    for (i = 0; i < DOWNLOAD_RING_SIZE; i++)
+    {
+        if ((m_download_ring_bytes[i] == num_bytes) && (m_download_ring_offset[i] == offset))
+        {
+            return m_download_ring[i];
+        }
+    }
+
+    // Read into the block that is not on air.
+    i = (p_busy == m_download_ring[0]) ? 1u : 0u;
+
+    m_download_ring_bytes[i] = 0;
+
+    if (m_download_source(m_file_index.data, offset, m_download_ring[i], num_bytes) < num_bytes)
+    {
+        return NULL;
+    }
+
+    m_download_ring_offset[i] = offset;
+    m_download_ring_bytes[i]  = num_bytes;
+
+    return m_download_ring[i];
+}
+
+
+/**@brief Function for sending blocks from the download source until the download is complete, or
+ *        a block has to be requested from the application.
+ */
+static void download_source_run(void)
+{
+    if ((m_download_source == NULL) || m_is_source_running)
+    {
+        // Blocks are requested with events, or this is called while sending a block.
+        return;
+    }
+
+    m_is_source_running = true;
+
+    while (m_is_source_request_pending && !m_is_source_stopped)
+    {
+        uint32_t        num_bytes = m_bytes_remaining.data;
+        const uint8_t * p_block;
+
+        m_is_source_request_pending = false;
+
+        if (num_bytes > DOWNLOAD_BLOCK_SIZE)
+        {
+            num_bytes = DOWNLOAD_BLOCK_SIZE;
+        }
+
+        p_block = download_block_get(m_link_burst_index.data, num_bytes, NULL);
+
+        if (p_block != NULL)
+        {
+            (void)antfs_input_data_download(m_file_index.data,
+                                            m_link_burst_index.data,
+                                            num_bytes,
+                                            p_block);
+        }
+        else
+        {
+            // Let the application provide the block.
+            event_queue_write(ANTFS_EVENT_DOWNLOAD_REQUEST_DATA);
+        }
+    }
+
+    m_is_source_running = false;
+}
+
+
+void antfs_download_source_set(antfs_download_source_t download_source)
+{
+    m_download_source = download_source;
+
+    memset(m_download_ring_bytes, 0, sizeof(m_download_ring_bytes));
+}
+#endif // ANTFS_DOWNLOAD_SOURCE
+
+
 void antfs_download_req_resp_prepare(uint8_t response,
                                      const antfs_request_info_t * const p_request_info)
 {
@@ -747,10 +878,20 @@ void antfs_download_req_resp_prepare(uint8_t response,
 
         m_is_data_request_pending = true;
 
-        // Request data from application.
-        event_queue_write(ANTFS_EVENT_DOWNLOAD_REQUEST_DATA);
+#ifdef ANTFS_DOWNLOAD_SOURCE
+        // The file may have changed since the last download.
+        memset(m_download_ring_bytes, 0, sizeof(m_download_ring_bytes));
+        m_is_source_stopped = false;
+#endif // ANTFS_DOWNLOAD_SOURCE
+
+        // Request data from application or download source.
+        download_data_request();
 
         m_current_state.sub_state.trans_sub_state = ANTFS_TRANS_SUBSTATE_VERIFY_CRC;
+
+#ifdef ANTFS_DOWNLOAD_SOURCE
+        download_source_run();
+#endif // ANTFS_DOWNLOAD_SOURCE
     }
 }
 
@@ -859,7 +1000,7 @@ uint32_t antfs_input_data_download(uint16_t index,
                 m_transfer_crc = crc_crc16_update(m_transfer_crc, p_message, num_bytes);
 
                 // Request more data.
-                event_queue_write(ANTFS_EVENT_DOWNLOAD_REQUEST_DATA);
+                download_data_request();
             }
         }
 
@@ -886,6 +1027,33 @@ uint32_t antfs_input_data_download(uint16_t index,
                 // The message processing will send client back to correct state
                 APP_ERROR_CHECK(err_code);
             }
+#ifdef ANTFS_DOWNLOAD_SOURCE
+            else
+            {
+                // Nothing more can be sent until the failure has been processed.
+                m_is_source_stopped = true;
+            }
+
+            if ((m_download_source != NULL) && !m_is_source_stopped &&
+                (m_bytes_remaining.data > num_bytes))
+            {
+                uint32_t next_bytes = m_bytes_remaining.data - num_bytes;
+
+                if (next_bytes > DOWNLOAD_BLOCK_SIZE)
+                {
+                    next_bytes = DOWNLOAD_BLOCK_SIZE;
+                }
+
+                // Read the next block while this one is on air. If the source cannot provide it
+                // now, it is read again when it is needed.
+                (void)download_block_get(m_link_burst_index.data + num_bytes, next_bytes, p_message);
+            }
+#endif // ANTFS_DOWNLOAD_SOURCE
+
+            // The burst handler only reads the block, so the CRC is calculated while it is on air.
+            m_transfer_crc = crc_crc16_update(m_transfer_crc,
+                                              &(p_message[block_offset]),
+                                              num_bytes);
 
             wait_burst_request_to_complete();
 
@@ -896,10 +1064,6 @@ uint32_t antfs_input_data_download(uint16_t index,
 
             m_is_data_request_pending = false;
 
-            m_transfer_crc = crc_crc16_update(m_transfer_crc,
-                                              &(p_message[block_offset]),
-                                              num_bytes);
-
             if((m_link_burst_index.data - m_temp_crc_offset) > SAVE_DISTANCE)
             {
                 // Set CRC save point
@@ -919,7 +1083,7 @@ uint32_t antfs_input_data_download(uint16_t index,
                 // If we have not finished the download.
 
                 // Request more data.
-                event_queue_write(ANTFS_EVENT_DOWNLOAD_REQUEST_DATA);
+                download_data_request();
 
                 m_is_data_request_pending = true;
             }
@@ -955,11 +1119,20 @@ uint32_t antfs_input_data_download(uint16_t index,
                 m_max_transfer_index.data = 0;
             }
 
+#ifdef ANTFS_DOWNLOAD_SOURCE
+            // Continue from the download source if the application provided this block.
+            download_source_run();
+#endif // ANTFS_DOWNLOAD_SOURCE
+
             // Return the number of bytes we accepted.
             return num_bytes;
         }
     }
 
+#ifdef ANTFS_DOWNLOAD_SOURCE
+    download_source_run();
+#endif // ANTFS_DOWNLOAD_SOURCE
+
     // No bytes were accepted.
     return 0;
 }
@@ -242,6 +242,24 @@ typedef struct
  * executed while waiting for the burst busy flag. */
 typedef void(*antfs_burst_wait_handler_t)(void);
 
+#ifdef ANTFS_DOWNLOAD_SOURCE
+/**@brief The download source can be configured by the application to let ANT-FS read download
+ * data from the file itself, instead of requesting it with ANTFS_EVENT_DOWNLOAD_REQUEST_DATA events.
+ *
+ * @param[in]  index              Index of the file downloaded.
+ * @param[in]  offset             Offset of the requested data within the file.
+ * @param[out] p_buffer           Buffer for the data.
+ * @param[in]  num_bytes          Number of bytes requested.
+ *
+ * @return Number of bytes copied to p_buffer. If less than num_bytes, the data is requested with an
+ *         ANTFS_EVENT_DOWNLOAD_REQUEST_DATA event instead.
+ */
+typedef uint32_t(*antfs_download_source_t)(uint16_t index,
+                                           uint32_t offset,
+                                           uint8_t * p_buffer,
+                                           uint32_t num_bytes);
+#endif // ANTFS_DOWNLOAD_SOURCE
+
 /**@brief Function for setting initial ANT-FS configuration parameters.
  *
  * @param[in] p_params                 The initial ANT-FS configuration parameters.
@@ -292,6 +310,19 @@ uint32_t antfs_input_data_download(uint16_t index,
                                    uint32_t num_bytes,
                                    const uint8_t * const p_message);
 
+#ifdef ANTFS_DOWNLOAD_SOURCE
+/**@brief Function for setting the download source.
+ *
+ * While a download source is set, an accepted download is sent from within
+ * antfs_download_req_resp_prepare. The next burst block is read from the source while the current
+ * one is on air, so the burst handler is given new data as soon as it releases the last block.
+ * The burst wait handler is called while waiting, as for any other burst transmission.
+ *
+ * @param[in] download_source     The download source, or NULL to request data with events.
+ */
+void antfs_download_source_set(antfs_download_source_t download_source);
+#endif // ANTFS_DOWNLOAD_SOURCE
+
 /**@brief Function for transmitting upload request response to a upload request command by ANT-FS
  *        host.
  *
@@ -26,6 +26,7 @@ All rights reserved.
  * Feed each consecutive data block into this function, along with the current value of current_crc
  * as returned by the previous call of this function. The first call of this function should pass
  * the initial value (usually 0) of the crc in current_crc.
+ * This is a wrapper around crc16_update() with CRC16_POLY_ARC, so crc16.c must be built as well.
 
  * @param[in] current_crc The current calculated CRC-16 value.
  * @param[in] p_data      The input data block for computation.
@@ -30,7 +30,9 @@
  *
  * @param[in] packet  Packet type for which this callback is related. START_PACKET, DATA_PACKET.
  * @param[in] result  Operation result code. NRF_SUCCESS when a queued operation was successful.
- * @param[in] p_data  Pointer to the data to which the operation is related.
+ * @param[in] p_data  Pointer to the data to which the operation is related. NULL for a
+ *                    DATA_PACKET when a page buffer has been written with DFU_PAGE_BUFFERED, a
+ *                    data packet refused with NRF_ERROR_BUSY can be given again then.
  */
 typedef void (*dfu_callback_t)(uint32_t packet, uint32_t  result, uint8_t * p_data);
 
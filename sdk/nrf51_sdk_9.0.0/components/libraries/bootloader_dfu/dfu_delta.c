@@ -0,0 +1,332 @@
+/* Copyright (c) 2015 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "dfu_delta.h"
+#include <stddef.h>
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_util.h"
+#include "crc16.h"
+
+#define VARINT_SHIFT_MAX             28                            /**< Shift of the last byte of a 32 bit LEB128 varint. */
+#define PADDING_MAX                  3                             /**< Largest number of padding bytes after the last command. */
+
+/**@brief Decoder states. */
+typedef enum
+{
+    DFU_DELTA_STATE_HEADER,                                        /**< Receiving the patch header. */
+    DFU_DELTA_STATE_SOURCE_CHECK,                                  /**< Checking the source image against the patch header. */
+    DFU_DELTA_STATE_COMMAND,                                       /**< Receiving the varint starting a command. */
+    DFU_DELTA_STATE_OFFSET,                                        /**< Receiving the source offset of a copy command. */
+    DFU_DELTA_STATE_LITERAL,                                       /**< Writing literal bytes from the patch. */
+    DFU_DELTA_STATE_COPY,                                          /**< Writing a run of bytes from the source. */
+    DFU_DELTA_STATE_DONE,                                          /**< Target complete, only padding may follow. */
+    DFU_DELTA_STATE_ERROR                                          /**< Patch rejected. */
+} dfu_delta_state_t;
+
+static dfu_delta_state_t    m_state;                               /**< Current decoder state. */
+static dfu_delta_write_t    m_write_handler;                       /**< Function receiving the target image. */
+static uint8_t const      * mp_source;                             /**< Source image. */
+static uint32_t             m_source_size_max;                     /**< Number of bytes available at mp_source. */
+static uint32_t             m_target_size_max;                     /**< Largest target image accepted. */
+
+static uint8_t              m_header[DFU_DELTA_HEADER_SIZE];       /**< Patch header, collected over one or more calls. */
+static uint32_t             m_header_length;                       /**< Number of header bytes received. */
+static uint32_t             m_source_size;                         /**< Number of source bytes the patch was made for. */
+static uint16_t             m_source_crc;                          /**< CRC-16 of the source bytes the patch was made for. */
+static uint32_t             m_target_size;                         /**< Target image size. */
+static uint16_t             m_target_crc;                          /**< CRC-16 of the target image. */
+
+static uint32_t             m_source_checked;                      /**< Number of source bytes checked against m_source_crc. */
+static uint16_t             m_source_check_crc;                    /**< CRC-16 of the source bytes checked so far. */
+
+static uint32_t             m_varint;                              /**< Varint being received. */
+static uint32_t             m_varint_shift;                        /**< Bit position of the next varint byte. */
+static uint32_t             m_source_pos;                          /**< Source position of the next copy. */
+static uint32_t             m_target_pos;                          /**< Number of target bytes written. */
+static uint32_t             m_run_length;                          /**< Bytes left of the current literal or copy run. */
+static uint32_t             m_padding;                             /**< Number of padding bytes received after the last command. */
+
+
+/**@brief Function for adding a byte to the varint being received.
+ *
+ * @return true when the varint is complete and stored in m_varint.
+ */
+static bool varint_add(uint8_t byte)
+{
+    if (m_varint_shift == 0)
+    {
+        m_varint = 0;
+    }
+
+    m_varint |= (uint32_t)(byte & 0x7F) << m_varint_shift;
+
+    if ((byte & 0x80) == 0)
+    {
+        m_varint_shift = 0;
+        return true;
+    }
+
+    m_varint_shift += 7;
+    return false;
+}
+
+
+/**@brief Function for checking the received patch header against the image limits.
+ *
+ * @details The source image is checked against the header CRC afterwards, by
+ *          \ref dfu_delta_source_check.
+ */
+static uint32_t header_check(void)
+{
+    if (uint32_decode(&m_header[0]) != DFU_DELTA_MAGIC)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    m_target_size = uint32_decode(&m_header[4]);
+    m_source_size = uint32_decode(&m_header[8]);
+    m_source_crc  = uint16_decode(&m_header[12]);
+    m_target_crc  = uint16_decode(&m_header[14]);
+
+    if ((m_target_size > m_target_size_max) || (m_source_size > m_source_size_max))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    // The target is written to flash in words, the last page could not be stored otherwise.
+    if ((m_target_size & (sizeof(uint32_t) - 1)) != 0)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    m_source_checked   = 0;
+    m_source_check_crc = 0xFFFF;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for starting a run when the command varint is complete.
+ */
+static uint32_t command_start(void)
+{
+    m_run_length = (m_varint >> 1) + 1;
+
+    if (m_run_length > (m_target_size - m_target_pos))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    m_state = (m_varint & 1) ? DFU_DELTA_STATE_OFFSET : DFU_DELTA_STATE_LITERAL;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for moving the source position when the offset varint is complete.
+ */
+static uint32_t copy_start(void)
+{
+    // Zigzag decoding, small negative and positive offsets both become small varints.
+    m_source_pos += (m_varint >> 1) ^ (0 - (m_varint & 1));
+
+    if ((m_source_pos > m_source_size) || (m_run_length > (m_source_size - m_source_pos)))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    m_state = DFU_DELTA_STATE_COPY;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for writing the next part of the current run.
+ *
+ * @param[in] p_data  Pointer to the run data.
+ * @param[in] length  Number of run bytes available.
+ *
+ * @return Number of bytes accepted by the write handler.
+ */
+static uint32_t run_write(uint8_t const * p_data, uint32_t length)
+{
+    uint32_t written = m_write_handler(p_data, length);
+
+    m_run_length -= written;
+    m_target_pos += written;
+
+    if (m_run_length == 0)
+    {
+        m_state = (m_target_pos == m_target_size) ? DFU_DELTA_STATE_DONE : DFU_DELTA_STATE_COMMAND;
+    }
+
+    return written;
+}
+
+
+void dfu_delta_init(uint8_t const  * p_source,
+                    uint32_t         source_size_max,
+                    uint32_t         target_size_max,
+                    dfu_delta_write_t write_handler)
+{
+    m_state           = DFU_DELTA_STATE_HEADER;
+    m_write_handler   = write_handler;
+    mp_source         = p_source;
+    m_source_size_max = source_size_max;
+    m_target_size_max = target_size_max;
+    m_header_length   = 0;
+    m_varint_shift    = 0;
+    m_source_pos      = 0;
+    m_target_pos      = 0;
+    m_run_length      = 0;
+    m_padding         = 0;
+}
+
+
+uint32_t dfu_delta_decode(uint8_t const * p_patch, uint32_t length, uint32_t * p_consumed)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    uint32_t index    = 0;
+    uint32_t count;
+    uint32_t written;
+
+    while ((err_code == NRF_SUCCESS) && ((index < length) || (m_state == DFU_DELTA_STATE_COPY)))
+    {
+        switch (m_state)
+        {
+            case DFU_DELTA_STATE_HEADER:
+                count = MIN(DFU_DELTA_HEADER_SIZE - m_header_length, length - index);
+                memcpy(&m_header[m_header_length], &p_patch[index], count);
+                m_header_length += count;
+                index           += count;
+
+                if (m_header_length == DFU_DELTA_HEADER_SIZE)
+                {
+                    err_code = header_check();
+                    if (err_code == NRF_SUCCESS)
+                    {
+                        m_state = DFU_DELTA_STATE_SOURCE_CHECK;
+                    }
+                }
+                break;
+
+            case DFU_DELTA_STATE_SOURCE_CHECK:
+                // Continued when dfu_delta_source_check has finished.
+                err_code = NRF_ERROR_BUSY;
+                break;
+
+            case DFU_DELTA_STATE_COMMAND:
+            case DFU_DELTA_STATE_OFFSET:
+                if ((m_varint_shift == VARINT_SHIFT_MAX) && (p_patch[index] & 0x80))
+                {
+                    // Longer than a 32 bit varint.
+                    err_code = NRF_ERROR_INVALID_DATA;
+                    break;
+                }
+
+                if (varint_add(p_patch[index++]))
+                {
+                    err_code = (m_state == DFU_DELTA_STATE_COMMAND) ? command_start() : copy_start();
+                }
+                break;
+
+            case DFU_DELTA_STATE_LITERAL:
+                count   = MIN(m_run_length, length - index);
+                written = run_write(&p_patch[index], count);
+                index  += written;
+                if (written < count)
+                {
+                    err_code = NRF_ERROR_BUSY;
+                }
+                break;
+
+            case DFU_DELTA_STATE_COPY:
+                count         = m_run_length;
+                written       = run_write(&mp_source[m_source_pos], count);
+                m_source_pos += written;
+                if (written < count)
+                {
+                    err_code = NRF_ERROR_BUSY;
+                }
+                break;
+
+            case DFU_DELTA_STATE_DONE:
+                m_padding += length - index;
+                index      = length;
+                if (m_padding > PADDING_MAX)
+                {
+                    err_code = NRF_ERROR_INVALID_DATA;
+                }
+                break;
+
+            default:
+                err_code = NRF_ERROR_INVALID_DATA;
+                break;
+        }
+    }
+
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
+    {
+        m_state = DFU_DELTA_STATE_ERROR;
+    }
+
+    *p_consumed = index;
+    return err_code;
+}
+
+
+uint32_t dfu_delta_source_check(uint32_t length)
+{
+    if (m_state != DFU_DELTA_STATE_SOURCE_CHECK)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    length             = MIN(length, m_source_size - m_source_checked);
+    m_source_check_crc = crc16_compute(&mp_source[m_source_checked], length, &m_source_check_crc);
+    m_source_checked  += length;
+
+    if (m_source_checked < m_source_size)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    // The patch must have been made for the image the copy commands read from.
+    if (m_source_check_crc != m_source_crc)
+    {
+        m_state = DFU_DELTA_STATE_ERROR;
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    m_state = (m_target_size == 0) ? DFU_DELTA_STATE_DONE : DFU_DELTA_STATE_COMMAND;
+    return NRF_SUCCESS;
+}
+
+
+bool dfu_delta_is_complete(void)
+{
+    return (m_state == DFU_DELTA_STATE_DONE);
+}
+
+
+uint32_t dfu_delta_target_get(uint32_t * p_size, uint16_t * p_crc)
+{
+    if ((m_state == DFU_DELTA_STATE_HEADER) || (m_state == DFU_DELTA_STATE_ERROR))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    *p_size = m_target_size;
+    *p_crc  = m_target_crc;
+
+    return NRF_SUCCESS;
+}
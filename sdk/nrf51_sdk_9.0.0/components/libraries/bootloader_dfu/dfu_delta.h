@@ -0,0 +1,125 @@
+/* Copyright (c) 2015 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @defgroup dfu_delta Delta image decoder
+ * @{
+ * @ingroup dfu_bootloader_api
+ *
+ * @brief    Streaming decoder for application images sent as a patch against the current image.
+ *
+ * @details  A patch is a header followed by a list of commands that build the new image (the
+ *           target) from the application currently in bank 0 (the source). A literal command
+ *           carries new bytes, a copy command takes a run of bytes from the source. Copy offsets
+ *           are relative to the end of the previous copy, so code that has only moved a little
+ *           costs a few bytes per run.
+ *
+ *           All fields are little endian:
+ *
+ *           | Offset | Size | Field                                          |
+ *           |--------|------|------------------------------------------------|
+ *           | 0      | 4    | \ref DFU_DELTA_MAGIC                           |
+ *           | 4      | 4    | Target image size, a multiple of 4.            |
+ *           | 8      | 4    | Number of source bytes the patch was made for. |
+ *           | 12     | 2    | CRC-16 of those source bytes.                  |
+ *           | 14     | 2    | CRC-16 of the target image.                    |
+ *
+ *           Each command starts with a LEB128 varint v. The run length is (v >> 1) + 1. When bit 0
+ *           of v is clear, the run length literal bytes follow. When it is set, a zigzag encoded
+ *           varint follows, which is added to the source position before the run is copied. The
+ *           patch ends when the target is complete. Up to 3 bytes of padding may follow to make
+ *           the patch word sized.
+ *
+ *           The first word of an image is the initial stack pointer, which is never equal to
+ *           \ref DFU_DELTA_MAGIC, so a patch can be told from a full image by its first word.
+ *           After the header, the source image is checked against the header CRC with
+ *           \ref dfu_delta_source_check, which can be split over several calls so a large image
+ *           does not keep the caller busy. Commands are decoded when the check is complete.
+ *           The decoder keeps its state between calls, so commands can be split over any number of
+ *           data packets, and output can be stopped and resumed when the flash is busy.
+ */
+
+#ifndef DFU_DELTA_H__
+#define DFU_DELTA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DFU_DELTA_MAGIC              0x01544C44                    /**< First word of a patch, "DLT" followed by format version 1. */
+#define DFU_DELTA_HEADER_SIZE        16                            /**< Size of the patch header. */
+
+/**@brief Function for writing decoded target data.
+ *
+ * @param[in] p_data  Pointer to the next target bytes.
+ * @param[in] length  Number of bytes available.
+ *
+ * @return Number of bytes accepted. When less than length, decoding stops and is resumed by the
+ *         next call to \ref dfu_delta_decode.
+ */
+typedef uint32_t (*dfu_delta_write_t)(uint8_t const * p_data, uint32_t length);
+
+/**@brief Function for starting to decode a new patch.
+ *
+ * @param[in] p_source         Pointer to the source image.
+ * @param[in] source_size_max  Number of bytes available at p_source.
+ * @param[in] target_size_max  Largest target image accepted.
+ * @param[in] write_handler    Function receiving the target image.
+ */
+void dfu_delta_init(uint8_t const  * p_source,
+                    uint32_t         source_size_max,
+                    uint32_t         target_size_max,
+                    dfu_delta_write_t write_handler);
+
+/**@brief Function for decoding the next part of a patch.
+ *
+ * @param[in]  p_patch     Pointer to the patch data.
+ * @param[in]  length      Length of the patch data. May be 0 to resume a stopped copy.
+ * @param[out] p_consumed  Number of patch bytes used. The rest must be given again on the next
+ *                         call.
+ *
+ * @retval NRF_SUCCESS               If all the patch data was used.
+ * @retval NRF_ERROR_BUSY            If the write handler did not accept all the data, or the
+ *                                   source image has not been checked yet.
+ * @retval NRF_ERROR_INVALID_LENGTH  If the target image size is not a multiple of 4.
+ * @retval NRF_ERROR_INVALID_DATA    If the patch is malformed or too large.
+ */
+uint32_t dfu_delta_decode(uint8_t const * p_patch, uint32_t length, uint32_t * p_consumed);
+
+/**@brief Function for checking the next part of the source image against the patch header.
+ *
+ * @param[in] length  Largest number of source bytes to check in this call.
+ *
+ * @retval NRF_SUCCESS              If the whole source image matches the patch header.
+ * @retval NRF_ERROR_BUSY           If part of the source image is left to check.
+ * @retval NRF_ERROR_INVALID_DATA   If the patch was made for a different source image.
+ * @retval NRF_ERROR_INVALID_STATE  If no source check is in progress.
+ */
+uint32_t dfu_delta_source_check(uint32_t length);
+
+/**@brief Function for checking if the complete target image has been written.
+ */
+bool dfu_delta_is_complete(void);
+
+/**@brief Function for getting the size and CRC-16 of the target image from the patch header.
+ *
+ * @param[out] p_size  Target image size.
+ * @param[out] p_crc   CRC-16 of the target image.
+ *
+ * @retval NRF_SUCCESS              If the header has been decoded.
+ * @retval NRF_ERROR_INVALID_STATE  If the header has not been received yet.
+ */
+uint32_t dfu_delta_target_get(uint32_t * p_size, uint16_t * p_crc);
+
+#endif // DFU_DELTA_H__
+
+/** @} */
@@ -31,6 +31,11 @@
 #include "pstorage.h"
 #include "nrf_mbr.h"
 #include "dfu_init.h"
+#ifdef DFU_DELTA
+#include "dfu_delta.h"
+#include "crc16.h"
+#include "app_scheduler.h"
+#endif // DFU_DELTA
 
 static dfu_state_t                  m_dfu_state;                /**< Current DFU state. */
 static uint32_t                     m_image_size;               /**< Size of the image that will be transmitted. */
@@ -50,6 +55,93 @@ static pstorage_handle_t          * mp_storage_handle_active;   /**< Pointer to
 static dfu_callback_t               m_data_pkt_cb;              /**< Callback from DFU Bank module for notification of asynchronous operation such as flash prepare. */
 static dfu_bank_func_t              m_functions;                /**< Structure holding operations for the selected update process. */
 
+#ifdef DFU_PAGE_BUFFERED
+#define DFU_PAGE_BUFFER_COUNT           2                                                                 /**< Number of page buffers. One is filled while the other is written to flash. */
+
+static uint32_t                     m_page_buffer[DFU_PAGE_BUFFER_COUNT][CODE_PAGE_SIZE / sizeof(uint32_t)]; /**< Buffers collecting received data packets into whole pages before they are written to flash. */
+static uint32_t                     m_page_fill;                /**< Number of bytes in the active page buffer. */
+static uint8_t                      m_page_active;              /**< Index of the page buffer that received data is copied to. */
+static uint8_t                      m_pages_in_flight;          /**< Number of page buffers queued in pstorage and not yet written. */
+static uint8_t                    * mp_final_packet;            /**< Final data packet. Reported to the transport when all page buffers have been written. */
+#endif // DFU_PAGE_BUFFERED
+
+#ifdef DFU_DELTA
+#ifndef DFU_PAGE_BUFFERED
+#error "DFU_DELTA requires DFU_PAGE_BUFFERED."
+#endif
+
+#define DFU_DELTA_PKT_QUEUE_SIZE        8                                                                 /**< Number of data packets that can wait for the patch decoder. Must not be less than the number of RX buffers of the transport. */
+#define DFU_DELTA_SOURCE_CHECK_SIZE     CODE_PAGE_SIZE                                                    /**< Number of bank 0 bytes checked against the patch header per scheduler event. */
+
+/**@brief Data packet waiting for the patch decoder. */
+typedef struct
+{
+    uint8_t  * p_data;                                          /**< Packet data, owned by the transport until the packet is reported as handled. */
+    uint16_t   length;                                          /**< Packet length. */
+    uint16_t   offset;                                          /**< Number of bytes given to the decoder. */
+} dfu_delta_pkt_t;
+
+static bool                         m_delta_image;              /**< True when the received image is a patch against the application in bank 0. */
+static bool                         m_delta_input_complete;     /**< True when the last data packet of the patch has been queued. */
+static uint32_t                     m_delta_target_offset;      /**< Offset in the active bank of the next decoded byte. */
+static uint32_t                     m_delta_err_code;           /**< Error from writing a page buffer while decoding. */
+static dfu_delta_pkt_t              m_delta_pkt_queue[DFU_DELTA_PKT_QUEUE_SIZE]; /**< Data packets waiting for the patch decoder. */
+static uint8_t                      m_delta_pkt_head;           /**< Index of the oldest packet in m_delta_pkt_queue. */
+static uint8_t                      m_delta_pkt_count;          /**< Number of packets in m_delta_pkt_queue. */
+static bool                         m_delta_check_scheduled;    /**< True when dfu_delta_source_check_handler is in the scheduler queue. */
+
+static uint32_t dfu_delta_process(void);
+#endif // DFU_DELTA
+
+
+#ifdef DFU_PAGE_BUFFERED
+/**@brief Function for handling a completed write of a page buffer.
+ *
+ * @details Data packets are reported to the transport when they have been copied, so only errors
+ *          and the final data packet are reported when the page buffers reach flash. Otherwise
+ *          the free page buffer is reported with a NULL packet, so the transport can give again a
+ *          packet that was refused with NRF_ERROR_BUSY.
+ */
+static void dfu_page_stored(uint32_t result, uint8_t * p_page)
+{
+    m_pages_in_flight--;
+
+    if (m_data_pkt_cb == NULL)
+    {
+        return;
+    }
+
+    if (result != NRF_SUCCESS)
+    {
+        m_data_pkt_cb(DATA_PACKET, result, p_page);
+        return;
+    }
+
+#ifdef DFU_DELTA
+    if (m_delta_image)
+    {
+        // A page buffer is free, continue decoding.
+        uint32_t err_code = dfu_delta_process();
+        if (err_code != NRF_SUCCESS)
+        {
+            m_data_pkt_cb(DATA_PACKET, err_code, NULL);
+            return;
+        }
+    }
+#endif // DFU_DELTA
+
+    if (mp_final_packet == NULL)
+    {
+        m_data_pkt_cb(DATA_PACKET, NRF_SUCCESS, NULL);
+    }
+    else if (m_pages_in_flight == 0)
+    {
+        m_data_pkt_cb(DATA_PACKET, NRF_SUCCESS, mp_final_packet);
+        mp_final_packet = NULL;
+    }
+}
+#endif // DFU_PAGE_BUFFERED
+
 
 /**@brief Function for handling callbacks from pstorage module.
  *
@@ -65,6 +157,14 @@ static void pstorage_callback_handler(pstorage_handle_t * p_handle,
     switch (op_code)
     {
         case PSTORAGE_STORE_OP_CODE:
+#ifdef DFU_PAGE_BUFFERED
+            if ((p_data >= (uint8_t *)m_page_buffer) &&
+                (p_data < ((uint8_t *)m_page_buffer + sizeof(m_page_buffer))))
+            {
+                dfu_page_stored(result, p_data);
+                break;
+            }
+#endif // DFU_PAGE_BUFFERED
             if ((m_dfu_state == DFU_STATE_RX_DATA_PKT) && (m_data_pkt_cb != NULL))
             {
                 m_data_pkt_cb(DATA_PACKET, result, p_data);
@@ -299,6 +399,389 @@ static uint32_t dfu_activate_bl(void)
 }
 
 
+#ifdef DFU_PAGE_BUFFERED
+/**@brief   Function for writing the active page buffer to flash.
+ *
+ * @param[in] end_offset  Offset in the active bank of the end of the data in the page buffer.
+ *
+ * @return NRF_SUCCESS on success, otherwise the error code from \ref pstorage_store.
+ */
+static uint32_t dfu_page_flush(uint32_t end_offset)
+{
+    uint32_t err_code = pstorage_store(mp_storage_handle_active,
+                                       (uint8_t *)m_page_buffer[m_page_active],
+                                       m_page_fill,
+                                       end_offset - m_page_fill);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    m_pages_in_flight++;
+    m_page_active = (m_page_active + 1) % DFU_PAGE_BUFFER_COUNT;
+    m_page_fill   = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief   Function for copying a data packet into the page buffers.
+ *
+ * @details Full page buffers are written to flash, and the last, partly filled, page buffer is
+ *          written when the final data packet is received. When the whole packet has been copied,
+ *          it is given to \ref dfu_init_postvalidate_update. Except for the final one, the packet
+ *          is reported to the transport as handled before returning, so the transport can reuse
+ *          its buffer. A packet refused with NRF_ERROR_BUSY has not changed any state and can be
+ *          given again when a page buffer has been written.
+ *
+ * @param[in] p_data       Pointer to the data packet.
+ * @param[in] data_length  Length of the data packet.
+ *
+ * @retval NRF_SUCCESS      If the packet has been copied.
+ * @retval NRF_ERROR_BUSY   If the page buffers the packet needs are still being written to flash.
+ * @return Otherwise the error code from \ref dfu_page_flush. The transfer cannot continue then.
+ */
+static uint32_t dfu_data_pkt_buffer(uint8_t * p_data, uint32_t data_length)
+{
+    uint32_t   err_code;
+    uint32_t   packet_length = data_length;
+    uint32_t   offset        = m_data_received;
+    bool       final_packet  = ((m_data_received + data_length) == m_image_size);
+    uint32_t   end_fill      = m_page_fill + data_length;
+    uint32_t   buffers       = (end_fill + CODE_PAGE_SIZE - 1) / CODE_PAGE_SIZE;
+    uint8_t  * p_packet      = p_data;
+
+    if (buffers > (DFU_PAGE_BUFFER_COUNT - m_pages_in_flight))
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    while (data_length > 0)
+    {
+        uint32_t length = MIN(CODE_PAGE_SIZE - m_page_fill, data_length);
+
+        memcpy((uint8_t *)m_page_buffer[m_page_active] + m_page_fill, p_data, length);
+
+        m_page_fill += length;
+        offset      += length;
+        p_data      += length;
+        data_length -= length;
+
+        if ((m_page_fill == CODE_PAGE_SIZE) || (final_packet && (data_length == 0)))
+        {
+            err_code = dfu_page_flush(offset);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+
+    dfu_init_postvalidate_update(p_packet, packet_length);
+
+    if (final_packet)
+    {
+        mp_final_packet = p_packet;
+    }
+    else if (m_data_pkt_cb != NULL)
+    {
+        m_data_pkt_cb(DATA_PACKET, NRF_SUCCESS, p_packet);
+    }
+
+    return NRF_SUCCESS;
+}
+#endif // DFU_PAGE_BUFFERED
+
+
+#ifdef DFU_DELTA
+/**@brief   Function for writing decoded image data into the page buffers.
+ *
+ * @details A full page buffer is written to flash when more data follows, so the last page of the
+ *          image is always written by \ref dfu_delta_process together with the final packet.
+ *          The decoded data is also given to \ref dfu_init_postvalidate_update, so the init packet
+ *          is checked against the rebuilt image, as it is when the image is checked in flash.
+ *          See \ref dfu_delta_write_t for the parameters.
+ */
+static uint32_t dfu_delta_page_write(uint8_t const * p_data, uint32_t length)
+{
+    uint32_t written = 0;
+
+    while ((written < length) && (m_delta_err_code == NRF_SUCCESS))
+    {
+        if (m_page_fill == CODE_PAGE_SIZE)
+        {
+            if (m_pages_in_flight == (DFU_PAGE_BUFFER_COUNT - 1))
+            {
+                // The next page buffer is still being written.
+                break;
+            }
+            m_delta_err_code = dfu_page_flush(m_delta_target_offset);
+            continue;
+        }
+
+        uint32_t count = MIN(CODE_PAGE_SIZE - m_page_fill, length - written);
+
+        memcpy((uint8_t *)m_page_buffer[m_page_active] + m_page_fill, &p_data[written], count);
+        dfu_init_postvalidate_update(&p_data[written], count);
+
+        m_page_fill           += count;
+        m_delta_target_offset += count;
+        written               += count;
+    }
+
+    return written;
+}
+
+
+/**@brief   Function for decoding the queued data packets of a patch.
+ *
+ * @details Decoding stops when no page buffer is free, and is resumed when a page buffer has been
+ *          written. It starts when bank 0 has been checked against the patch header. Packets are
+ *          reported to the transport as handled when they have been decoded.
+ */
+static uint32_t dfu_delta_process(void)
+{
+    uint32_t          err_code;
+    uint32_t          consumed;
+    dfu_delta_pkt_t * p_pkt;
+
+    while (m_delta_pkt_count > 0)
+    {
+        p_pkt    = &m_delta_pkt_queue[m_delta_pkt_head];
+        err_code = dfu_delta_decode(&p_pkt->p_data[p_pkt->offset],
+                                    p_pkt->length - p_pkt->offset,
+                                    &consumed);
+        p_pkt->offset += consumed;
+
+        if (m_delta_err_code != NRF_SUCCESS)
+        {
+            return m_delta_err_code;
+        }
+        if (err_code == NRF_ERROR_BUSY)
+        {
+            // Continued when a page buffer has been written, or bank 0 has been checked.
+            return NRF_SUCCESS;
+        }
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+
+        m_delta_pkt_head = (m_delta_pkt_head + 1) % DFU_DELTA_PKT_QUEUE_SIZE;
+        m_delta_pkt_count--;
+
+        if (m_delta_input_complete && (m_delta_pkt_count == 0))
+        {
+            if (!dfu_delta_is_complete() || (m_page_fill == 0))
+            {
+                // The patch ended before the image was complete.
+                return NRF_ERROR_INVALID_DATA;
+            }
+
+            err_code = dfu_page_flush(m_delta_target_offset);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+
+            mp_final_packet = p_pkt->p_data;
+        }
+        else if (m_data_pkt_cb != NULL)
+        {
+            m_data_pkt_cb(DATA_PACKET, NRF_SUCCESS, p_pkt->p_data);
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief   Function for queueing a data packet of a patch for the decoder.
+ *
+ * @param[in] p_data       Pointer to the data packet.
+ * @param[in] data_length  Length of the data packet.
+ * @param[in] offset       Number of bytes at the start of the packet already given to the decoder.
+ *
+ * @retval NRF_SUCCESS             If the packet has been queued.
+ * @retval NRF_ERROR_BUSY          If the queue is full. The packet can be given again when a page
+ *                                 buffer has been written.
+ * @retval NRF_ERROR_INVALID_DATA  If the patch is malformed.
+ */
+static uint32_t dfu_delta_pkt_queue(uint8_t * p_data, uint32_t data_length, uint32_t offset)
+{
+    dfu_delta_pkt_t * p_pkt;
+
+    if (m_delta_pkt_count == DFU_DELTA_PKT_QUEUE_SIZE)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    p_pkt         = &m_delta_pkt_queue[(m_delta_pkt_head + m_delta_pkt_count) % DFU_DELTA_PKT_QUEUE_SIZE];
+    p_pkt->p_data = p_data;
+    p_pkt->length = data_length;
+    p_pkt->offset = offset;
+    m_delta_pkt_count++;
+
+    m_delta_input_complete = ((m_data_received + data_length) == m_image_size);
+
+    return dfu_delta_process();
+}
+
+
+static uint32_t dfu_delta_source_check_schedule(void);
+
+
+/**@brief   Function for checking the next page of bank 0 against the patch header.
+ *
+ * @details Bank 0 is checked one page per scheduler event, so a large application does not hold
+ *          up the BLE events. Data packets wait in the queue until the check is complete, and are
+ *          then decoded. See \ref app_sched_event_handler_t for the parameters.
+ */
+static void dfu_delta_source_check_handler(void * p_event_data, uint16_t event_size)
+{
+    uint32_t err_code;
+
+    UNUSED_PARAMETER(p_event_data);
+    UNUSED_PARAMETER(event_size);
+
+    m_delta_check_scheduled = false;
+
+    if (!m_delta_image)
+    {
+        // The transfer has been reset.
+        return;
+    }
+
+    err_code = dfu_delta_source_check(DFU_DELTA_SOURCE_CHECK_SIZE);
+    if (err_code == NRF_ERROR_BUSY)
+    {
+        err_code = dfu_delta_source_check_schedule();
+    }
+    else if (err_code == NRF_SUCCESS)
+    {
+        err_code = dfu_delta_process();
+        if ((err_code == NRF_SUCCESS) && (m_data_pkt_cb != NULL))
+        {
+            // The transport can give again the packets refused while the queue was full.
+            m_data_pkt_cb(DATA_PACKET, NRF_SUCCESS, NULL);
+        }
+    }
+
+    if ((err_code != NRF_SUCCESS) && (m_data_pkt_cb != NULL))
+    {
+        m_data_pkt_cb(DATA_PACKET, err_code, NULL);
+    }
+}
+
+
+/**@brief   Function for scheduling the next part of the bank 0 check.
+ */
+static uint32_t dfu_delta_source_check_schedule(void)
+{
+    uint32_t err_code = app_sched_event_put(NULL, 0, dfu_delta_source_check_handler);
+
+    m_delta_check_scheduled = (err_code == NRF_SUCCESS);
+
+    return err_code;
+}
+
+
+/**@brief   Function for starting a new transfer, which is decoded as a patch if it starts with
+ *          \ref DFU_DELTA_MAGIC.
+ *
+ * @details The patch header is decoded from the first data packet, and bank 0 is then checked
+ *          against it from the scheduler, so a patch that was not made for the application in
+ *          bank 0 is rejected before anything is written to the swap bank.
+ *
+ * @param[in] p_data       Pointer to the first data packet.
+ * @param[in] data_length  Length of the first data packet.
+ *
+ * @retval NRF_SUCCESS             If the transfer is a full image, or a patch with a valid header.
+ * @retval NRF_ERROR_INVALID_DATA  If the transfer is a patch and bank 0 does not hold a valid
+ *                                 application, or the header is not valid.
+ */
+static uint32_t dfu_delta_start(uint8_t const * p_data, uint32_t data_length)
+{
+    uint32_t              err_code;
+    uint32_t              consumed;
+    bootloader_settings_t bootloader_settings;
+
+    m_delta_image = (IS_UPDATING_APP(m_start_packet) &&
+                     (uint32_decode(p_data) == DFU_DELTA_MAGIC));
+
+    if (!m_delta_image)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_delta_input_complete = false;
+    m_delta_target_offset  = 0;
+    m_delta_err_code       = NRF_SUCCESS;
+    m_delta_pkt_head       = 0;
+    m_delta_pkt_count      = 0;
+
+    bootloader_settings_get(&bootloader_settings);
+
+    if ((bootloader_settings.bank_0 != BANK_VALID_APP) || (data_length < DFU_DELTA_HEADER_SIZE))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    // Copy commands can only read the application in bank 0, and the header check compares the
+    // CRC of the source bytes the patch was made for.
+    dfu_delta_init((uint8_t *)DFU_BANK_0_REGION_START,
+                   bootloader_settings.bank_0_size,
+                   DFU_IMAGE_MAX_SIZE_BANKED,
+                   dfu_delta_page_write);
+
+    // A target that is not word sized is reported as NRF_ERROR_INVALID_DATA too, as the transport
+    // takes NRF_ERROR_INVALID_LENGTH to mean that more data is expected.
+    err_code = dfu_delta_decode(p_data, DFU_DELTA_HEADER_SIZE, &consumed);
+    if (err_code != NRF_SUCCESS)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    // A check still scheduled for a reset transfer continues with this one.
+    if (!m_delta_check_scheduled)
+    {
+        return dfu_delta_source_check_schedule();
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief   Function for checking the image rebuilt from a patch.
+ *
+ * @details The CRC from the patch header is checked against the image in flash, and the image size
+ *          used for activation is changed from the patch size to the image size.
+ *
+ * @param[out] p_image_size  Size of the rebuilt image.
+ */
+static uint32_t dfu_delta_image_check(uint32_t * p_image_size)
+{
+    uint16_t image_crc;
+
+    if (!dfu_delta_is_complete() ||
+        (dfu_delta_target_get(p_image_size, &image_crc) != NRF_SUCCESS))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    if (crc16_compute((uint8_t *)mp_storage_handle_active->block_id, *p_image_size, NULL) !=
+        image_crc)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    m_start_packet.app_image_size = *p_image_size;
+
+    return NRF_SUCCESS;
+}
+#endif // DFU_DELTA
+
+
 uint32_t dfu_init(void)
 {
     uint32_t                err_code;
@@ -331,6 +814,16 @@ uint32_t dfu_init(void)
     m_data_received = 0;
     m_dfu_state     = DFU_STATE_IDLE;
 
+#ifdef DFU_PAGE_BUFFERED
+    m_page_fill       = 0;
+    m_page_active     = 0;
+    m_pages_in_flight = 0;
+    mp_final_packet   = NULL;
+#endif // DFU_PAGE_BUFFERED
+#ifdef DFU_DELTA
+    m_delta_image     = false;
+#endif // DFU_DELTA
+
     return NRF_SUCCESS;
 }
 
@@ -475,10 +968,32 @@ uint32_t dfu_data_pkt_handle(dfu_update_packet_t * p_packet)
 
             p_data = (uint32_t *)p_packet->params.data_packet.p_data_packet;
 
+#ifdef DFU_DELTA
+            if (m_data_received == 0)
+            {
+                err_code = dfu_delta_start((uint8_t *)p_data, data_length);
+                if (err_code != NRF_SUCCESS)
+                {
+                    return err_code;
+                }
+            }
+
+            if (m_delta_image)
+            {
+                err_code = dfu_delta_pkt_queue((uint8_t *)p_data,
+                                               data_length,
+                                               (m_data_received == 0) ? DFU_DELTA_HEADER_SIZE : 0);
+            }
+            else
+#endif // DFU_DELTA
+#ifdef DFU_PAGE_BUFFERED
+            err_code = dfu_data_pkt_buffer((uint8_t *)p_data, data_length);
+#else
             err_code = pstorage_store(mp_storage_handle_active,
                                           (uint8_t *)p_data,
                                           data_length,
                                           m_data_received);
+#endif // DFU_PAGE_BUFFERED
             if (err_code != NRF_SUCCESS)
             {
                 return err_code;
@@ -596,6 +1111,13 @@ uint32_t dfu_image_validate()
                 // too much data. Hence the validation should fail.
                 err_code = NRF_ERROR_INVALID_STATE;
             }
+#ifdef DFU_PAGE_BUFFERED
+            else if (m_pages_in_flight > 0)
+            {
+                // The end of the image is still being written to flash.
+                err_code = NRF_ERROR_BUSY;
+            }
+#endif // DFU_PAGE_BUFFERED
             else
             {
                 m_dfu_state = DFU_STATE_VALIDATE;
@@ -604,8 +1126,24 @@ uint32_t dfu_image_validate()
                 err_code = dfu_timer_restart();
                 if (err_code == NRF_SUCCESS)
                 {
+#ifdef DFU_PAGE_BUFFERED
+                    uint32_t image_size = m_image_size;
+#ifdef DFU_DELTA
+                    if (m_delta_image)
+                    {
+                        err_code = dfu_delta_image_check(&image_size);
+                        if (err_code != NRF_SUCCESS)
+                        {
+                            return err_code;
+                        }
+                    }
+#endif // DFU_DELTA
+                    err_code = dfu_init_postvalidate_final((uint8_t *)mp_storage_handle_active->block_id,
+                                                           image_size);
+#else
                     err_code = dfu_init_postvalidate((uint8_t *)mp_storage_handle_active->block_id,
                                                      m_image_size);
+#endif // DFU_PAGE_BUFFERED
                     if (err_code != NRF_SUCCESS)
                     {
                         return err_code;
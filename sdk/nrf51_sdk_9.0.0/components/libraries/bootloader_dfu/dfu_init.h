@@ -129,6 +129,35 @@ uint32_t dfu_init_prevalidate(uint8_t * p_init_data, uint32_t init_data_len);
  */
 uint32_t dfu_init_postvalidate(uint8_t * p_image, uint32_t image_len);
 
+/**@brief DFU postvalidate update call for feeding image data to the post-check as it is received.
+ *
+ * @details  Used instead of \ref dfu_init_postvalidate when the bank module is built with
+ *           DFU_PAGE_BUFFERED. The image data is passed in order, in chunks of any length, so that
+ *           a CRC or hash can be calculated while the image is transfered instead of reading the
+ *           image back from flash at the end. The calculation is restarted by
+ *           \ref dfu_init_prevalidate. When the bank module is also built with DFU_DELTA and the
+ *           transfer is a patch, the data is the image rebuilt from the patch, not the patch, so
+ *           the init packet describes the new image in both cases.
+ *
+ * @param[in] p_data    Pointer to the next chunk of image data.
+ * @param[in] data_len  Length of the chunk.
+ */
+void dfu_init_postvalidate_update(uint8_t const * p_data, uint32_t data_len);
+
+/**@brief DFU postvalidate final call for post-checking the image data given to
+ *        \ref dfu_init_postvalidate_update.
+ *
+ * @details  Implementations that cannot calculate their check incrementally can check the image in
+ *           flash instead, like \ref dfu_init_postvalidate.
+ *
+ * @param[in] p_image    Pointer to the received image.
+ * @param[in] image_len  Length of the image data.
+ *
+ * @retval NRF_SUCCESS             If the post-validation succeeded.
+ * @retval NRF_ERROR_INVALID_DATA  If the post-validation failed.
+ */
+uint32_t dfu_init_postvalidate_final(uint8_t * p_image, uint32_t image_len);
+
 #endif // DFU_INIT_H__
 
 /**@} */
@@ -52,6 +52,7 @@
 
 static uint8_t m_extended_packet[DFU_INIT_PACKET_EXT_LENGTH_MAX];   //< Data array for storage of the extended data received. The extended data follows the normal init data of type \ref dfu_init_packet_t. Extended data can be used for a CRC, hash, signature, or other data. */
 static uint8_t m_extended_packet_length;                            //< Length of the extended data received with init packet. */
+static uint16_t m_image_crc;                                        //< CRC of the image data given to dfu_init_postvalidate_update. */
 
 
 uint32_t dfu_init_prevalidate(uint8_t * p_init_data, uint32_t init_data_len)
@@ -87,6 +88,9 @@ uint32_t dfu_init_prevalidate(uint8_t * p_init_data, uint32_t init_data_len)
            &p_init_packet->softdevice[p_init_packet->softdevice_len],
            m_extended_packet_length);
 
+    // Restart the CRC calculated while the image is received.
+    m_image_crc = 0xFFFF;
+
 /** [DFU init application version] */
     // To support application versioning, this check should be updated.
     // This template allows for any application to be installed. However, 
@@ -153,3 +157,25 @@ uint32_t dfu_init_postvalidate(uint8_t * p_image, uint32_t image_len)
     return NRF_SUCCESS;
 }
 
+
+void dfu_init_postvalidate_update(uint8_t const * p_data, uint32_t data_len)
+{
+    m_image_crc = crc16_compute(p_data, data_len, &m_image_crc);
+}
+
+
+uint32_t dfu_init_postvalidate_final(uint8_t * p_image, uint32_t image_len)
+{
+    uint16_t received_crc;
+
+    // The image CRC has been calculated while the image was received.
+    received_crc = uint16_decode((uint8_t *)&m_extended_packet[0]);
+
+    if (m_image_crc != received_crc)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    return NRF_SUCCESS;
+}
+
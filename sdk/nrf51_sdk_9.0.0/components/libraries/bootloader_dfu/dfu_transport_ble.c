@@ -33,6 +33,9 @@
 #include "app_timer.h"
 #include "ble_conn_params.h"
 #include "hci_mem_pool.h"
+#ifdef DFU_PAGE_BUFFERED
+#include "hci_mem_pool_internal.h"
+#endif // DFU_PAGE_BUFFERED
 #include "bootloader.h"
 #include "dfu_ble_svc_internal.h"
 #include "nrf_delay.h"
@@ -112,6 +115,23 @@ static bool                 m_ble_peer_data_valid    = false;
 static uint32_t             m_direct_adv_cnt         = APP_DIRECTED_ADV_TIMEOUT;                     /**< Counter of direct advertisements. */
 static uint8_t            * mp_final_packet;                                                         /**< Pointer to final data packet received. When callback for succesful packet handling is received from dfu bank handling a transfer complete response can be sent to peer. */
 
+#ifdef DFU_PAGE_BUFFERED
+/**@brief Data packet waiting to be given to the DFU module.
+ */
+typedef struct
+{
+    uint8_t  * p_data;                                                                               /**< RX buffer holding the packet. */
+    uint32_t   length;                                                                               /**< Length of the packet. */
+} pending_pkt_t;
+
+static pending_pkt_t        m_pending_pkts[RX_BUF_QUEUE_SIZE];                                       /**< Data packets refused by the DFU module with NRF_ERROR_BUSY, and the packets received after them. Each one holds an RX buffer, so the queue cannot overflow. */
+static uint8_t              m_pending_head;                                                          /**< Index of the oldest packet in m_pending_pkts. */
+static uint8_t              m_pending_count;                                                         /**< Number of packets in m_pending_pkts. */
+static bool                 m_pending_submitting     = false;                                        /**< Variable to indicate that pending packets are being given to the DFU module. Callbacks from the DFU module meanwhile must not give them again. */
+
+static void pending_pkts_submit(ble_dfu_t * p_dfu);
+#endif // DFU_PAGE_BUFFERED
+
 
 /**@brief     Function updating Service Changed CCCD and indicate a service change to peer.
  *
@@ -213,6 +233,34 @@ static ble_dfu_resp_val_t nrf_err_code_translate(uint32_t                  err_c
 }
 
 
+/**@brief     Function for counting a handled data packet and sending a Packet Receipt Notification
+ *            when the number of packets requested by the DFU Controller has been reached.
+ *
+ * @param[in] p_dfu     DFU Service Structure.
+ */
+static void pkt_rcpt_notif_count(ble_dfu_t * p_dfu)
+{
+    uint32_t err_code;
+
+    // Check if a packet receipt notification is needed to be sent.
+    if (m_pkt_rcpt_notif_enabled)
+    {
+        // Decrement the counter for the number firmware packets needed for sending the
+        // next packet receipt notification.
+        m_pkt_notif_target_cnt--;
+
+        if (m_pkt_notif_target_cnt == 0)
+        {
+            err_code = ble_dfu_pkts_rcpt_notify(p_dfu, m_num_of_firmware_bytes_rcvd);
+            APP_ERROR_CHECK(err_code);
+
+            // Reset the counter for the number of firmware packets.
+            m_pkt_notif_target_cnt = m_pkt_notif_target;
+        }
+    }
+}
+
+
 /**@brief     Function for handling the callback events from the dfu module.
  *            Callbacks are expected when \ref dfu_data_pkt_handle has been executed.
  *
@@ -238,6 +286,14 @@ static void dfu_cb_handler(uint32_t packet, uint32_t result, uint8_t * p_data)
                     APP_ERROR_CHECK(err_code);
                 }
             }
+#ifdef DFU_PAGE_BUFFERED
+            else if (p_data == NULL)
+            {
+                // A page buffer has been written to flash. Give the DFU module the packets it
+                // could not take yet.
+                pending_pkts_submit(&m_dfu);
+            }
+#endif // DFU_PAGE_BUFFERED
             else
             {
                 err_code = hci_mem_pool_rx_consume(p_data);
@@ -252,6 +308,15 @@ static void dfu_cb_handler(uint32_t packet, uint32_t result, uint8_t * p_data)
                                                      BLE_DFU_RESP_VAL_SUCCESS);
                     APP_ERROR_CHECK(err_code);
                 }
+#ifdef DFU_DELTA
+                else
+                {
+                    // Packets of a delta image can wait for flash while their RX buffers are in
+                    // use. Notifying only handled packets keeps the DFU Controller from sending
+                    // more than the RX buffers can hold.
+                    pkt_rcpt_notif_count(&m_dfu);
+                }
+#endif // DFU_DELTA
             }
             break;
 
@@ -393,6 +458,113 @@ static void init_data_process(ble_dfu_t * p_dfu, ble_dfu_evt_t * p_evt)
 }
 
 
+/**@brief     Function for giving a received firmware data packet to the DFU module.
+ *
+ * @param[in] p_dfu     DFU Service Structure.
+ * @param[in] p_data    RX buffer holding the packet.
+ * @param[in] length    Length of the packet.
+ *
+ * @retval    NRF_ERROR_BUSY if the DFU module cannot take the packet until a page buffer has been
+ *            written to flash. The RX buffer is kept for giving the packet again.
+ * @retval    NRF_SUCCESS otherwise. Errors have been reported to the DFU Controller.
+ */
+static uint32_t data_pkt_submit(ble_dfu_t * p_dfu, uint8_t * p_data, uint32_t length)
+{
+    uint32_t            err_code;
+    dfu_update_packet_t dfu_pkt;
+
+    dfu_pkt.packet_type                      = DATA_PACKET;
+    dfu_pkt.params.data_packet.packet_length = length / sizeof(uint32_t);
+    dfu_pkt.params.data_packet.p_data_packet = (uint32_t *)p_data;
+
+#ifdef DFU_DELTA
+    // The packet can be reported as handled before dfu_data_pkt_handle returns, so it is counted
+    // first.
+    m_num_of_firmware_bytes_rcvd += length;
+#endif // DFU_DELTA
+
+    err_code = dfu_data_pkt_handle(&dfu_pkt);
+
+    if (err_code == NRF_SUCCESS)
+    {
+#ifndef DFU_DELTA
+        m_num_of_firmware_bytes_rcvd += length;
+#endif // DFU_DELTA
+
+        // All the expected firmware data has been received and processed successfully.
+        // Response will be sent when flash operation for final packet is completed.
+        mp_final_packet = p_data;
+    }
+    else if (err_code == NRF_ERROR_INVALID_LENGTH)
+    {
+        // Firmware data packet was handled successfully. And more firmware data is expected.
+#ifndef DFU_DELTA
+        m_num_of_firmware_bytes_rcvd += length;
+
+        pkt_rcpt_notif_count(p_dfu);
+#endif // DFU_DELTA
+    }
+#ifdef DFU_PAGE_BUFFERED
+    else if (err_code == NRF_ERROR_BUSY)
+    {
+#ifdef DFU_DELTA
+        m_num_of_firmware_bytes_rcvd -= length;
+#endif // DFU_DELTA
+        return NRF_ERROR_BUSY;
+    }
+#endif // DFU_PAGE_BUFFERED
+    else
+    {
+        uint32_t hci_error = hci_mem_pool_rx_consume(p_data);
+        if (hci_error != NRF_SUCCESS)
+        {
+            dfu_error_notify(p_dfu, hci_error);
+        }
+
+        dfu_error_notify(p_dfu, err_code);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+#ifdef DFU_PAGE_BUFFERED
+/**@brief     Function for giving the pending firmware data packets to the DFU module, in the order
+ *            they were received.
+ *
+ * @details   Stops at the first packet the DFU module refuses with NRF_ERROR_BUSY. It is called
+ *            again when the DFU module reports that a page buffer has been written to flash.
+ *
+ * @param[in] p_dfu     DFU Service Structure.
+ */
+static void pending_pkts_submit(ble_dfu_t * p_dfu)
+{
+    if (m_pending_submitting)
+    {
+        // Called from a DFU module callback while giving it a packet. The loop below continues.
+        return;
+    }
+
+    m_pending_submitting = true;
+
+    while (m_pending_count > 0)
+    {
+        pending_pkt_t * p_pkt = &m_pending_pkts[m_pending_head];
+
+        if (data_pkt_submit(p_dfu, p_pkt->p_data, p_pkt->length) == NRF_ERROR_BUSY)
+        {
+            break;
+        }
+
+        m_pending_head = (m_pending_head + 1) % RX_BUF_QUEUE_SIZE;
+        m_pending_count--;
+    }
+
+    m_pending_submitting = false;
+}
+#endif // DFU_PAGE_BUFFERED
+
+
 /**@brief     Function for processing application data written by the peer to the DFU Packet
  *            Characteristic.
  *
@@ -440,54 +612,17 @@ static void app_data_process(ble_dfu_t * p_dfu, ble_dfu_evt_t * p_evt)
         return;
     }
 
-    dfu_update_packet_t dfu_pkt;
-
-    dfu_pkt.packet_type                      = DATA_PACKET;
-    dfu_pkt.params.data_packet.packet_length = length / sizeof(uint32_t);
-    dfu_pkt.params.data_packet.p_data_packet = (uint32_t *)mp_rx_buffer;
-
-    err_code = dfu_data_pkt_handle(&dfu_pkt);
-
-    if (err_code == NRF_SUCCESS)
-    {
-        m_num_of_firmware_bytes_rcvd += p_evt->evt.ble_dfu_pkt_write.len;
-
-        // All the expected firmware data has been received and processed successfully.
-        // Response will be sent when flash operation for final packet is completed.
-        mp_final_packet = mp_rx_buffer;
-    }
-    else if (err_code == NRF_ERROR_INVALID_LENGTH)
-    {
-        // Firmware data packet was handled successfully. And more firmware data is expected.
-        m_num_of_firmware_bytes_rcvd += p_evt->evt.ble_dfu_pkt_write.len;
-
-        // Check if a packet receipt notification is needed to be sent.
-        if (m_pkt_rcpt_notif_enabled)
-        {
-            // Decrement the counter for the number firmware packets needed for sending the
-            // next packet receipt notification.
-            m_pkt_notif_target_cnt--;
-
-            if (m_pkt_notif_target_cnt == 0)
-            {
-                err_code = ble_dfu_pkts_rcpt_notify(p_dfu, m_num_of_firmware_bytes_rcvd);
-                APP_ERROR_CHECK(err_code);
-
-                // Reset the counter for the number of firmware packets.
-                m_pkt_notif_target_cnt = m_pkt_notif_target;
-            }
-        }
-    }
-    else
-    {
-        uint32_t hci_error = hci_mem_pool_rx_consume(mp_rx_buffer);
-        if (hci_error != NRF_SUCCESS)
-        {
-            dfu_error_notify(p_dfu, hci_error);
-        }
-
-        dfu_error_notify(p_dfu, err_code);
-    }
+#ifdef DFU_PAGE_BUFFERED
+    // Packets still waiting for flash go first, so this one is queued behind them. A packet the
+    // DFU module refuses keeps its RX buffer until a page buffer has been written.
+    m_pending_pkts[(m_pending_head + m_pending_count) % RX_BUF_QUEUE_SIZE].p_data = mp_rx_buffer;
+    m_pending_pkts[(m_pending_head + m_pending_count) % RX_BUF_QUEUE_SIZE].length = length;
+    m_pending_count++;
+
+    pending_pkts_submit(p_dfu);
+#else
+    (void)data_pkt_submit(p_dfu, mp_rx_buffer, length);
+#endif // DFU_PAGE_BUFFERED
 }
 
 
@@ -1038,6 +1173,10 @@ uint32_t dfu_transport_update_start(void)
 
     m_tear_down_in_progress = false;
     m_pkt_type              = PKT_TYPE_INVALID;
+#ifdef DFU_PAGE_BUFFERED
+    m_pending_head          = 0;
+    m_pending_count         = 0;
+#endif // DFU_PAGE_BUFFERED
 
     leds_init();
 
@@ -208,7 +208,18 @@ static void process_dfu_packet(void * p_event_data, uint16_t event_size)
                     switch (DATA_QUEUE_ELEMENT_GET_PTYPE(index))
                     {
                         case DATA_PACKET:
+#ifdef DFU_PAGE_BUFFERED
+                            if (dfu_data_pkt_handle(packet) == NRF_ERROR_BUSY)
+                            {
+                                // Both page buffers are being written to flash. Keep the packet
+                                // queued and try again on the next pass of the scheduler.
+                                retval = app_sched_event_put(NULL, 0, process_dfu_packet);
+                                APP_ERROR_CHECK(retval);
+                                return;
+                            }
+#else
                             (void)dfu_data_pkt_handle(packet);
+#endif // DFU_PAGE_BUFFERED
                             break;
 
                         case START_PACKET:
@@ -225,7 +236,17 @@ static void process_dfu_packet(void * p_event_data, uint16_t event_size)
                             break;
 
                         case STOP_DATA_PACKET:
+#ifdef DFU_PAGE_BUFFERED
+                            if (dfu_image_validate() == NRF_ERROR_BUSY)
+                            {
+                                // The last page buffer is being written to flash.
+                                retval = app_sched_event_put(NULL, 0, process_dfu_packet);
+                                APP_ERROR_CHECK(retval);
+                                return;
+                            }
+#else
                             (void)dfu_image_validate();
+#endif // DFU_PAGE_BUFFERED
                             (void)dfu_image_activate();
 
                             // Break the loop by returning.
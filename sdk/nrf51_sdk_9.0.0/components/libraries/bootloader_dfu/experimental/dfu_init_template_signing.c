@@ -208,3 +208,16 @@ uint32_t dfu_init_postvalidate(uint8_t * p_image, uint32_t image_len)
 
     return NRF_SUCCESS;
 }
+
+
+void dfu_init_postvalidate_update(uint8_t const * p_data, uint32_t data_len)
+{
+    // The SHA-256 service of the SoftDevice has no incremental interface, the image is hashed in
+    // flash by dfu_init_postvalidate_final.
+}
+
+
+uint32_t dfu_init_postvalidate_final(uint8_t * p_image, uint32_t image_len)
+{
+    return dfu_init_postvalidate(p_image, image_len);
+}
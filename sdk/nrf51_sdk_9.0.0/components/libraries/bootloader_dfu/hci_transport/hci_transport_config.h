@@ -36,6 +36,10 @@
 
 #define HCI_SLIP_UART_BAUDRATE       UART_BAUDRATE_BAUDRATE_Baud38400   /**< Defines the UART Baud rate. Default is 38400 baud. */
 
+#define HCI_SLIP_UART_RX_BUF_SIZE    64                                 /**< Size of the UART RX FIFO when HCI_SLIP_BLOCK is defined, must be a power of 2. HCI_SLIP_BLOCK makes the SLIP layer encode and decode whole spans of the UART FIFOs, which needs app_uart_fifo.c and slip.c instead of app_uart.c. */
+
+#define HCI_SLIP_UART_TX_BUF_SIZE    256                                /**< Size of the UART TX FIFO when HCI_SLIP_BLOCK is defined, must be a power of 2. */
+
 /** This section covers configurable parameters for the HCI Transport layer that are used for calculating correct value for the retransmission timer timeout. */
 #define MAX_PACKET_SIZE_IN_BITS      8000u                              /**< Maximum size of a single application packet in bits. */      
 #define USED_BAUD_RATE               38400u                             /**< The used uart baudrate. */
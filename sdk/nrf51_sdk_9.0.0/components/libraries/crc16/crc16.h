@@ -17,6 +17,12 @@
  * @ingroup hci_transport
  *
  * @brief    This module implements the CRC-16 calculation in the blocks.
+ *
+ * @details  The calculation kernel is selected at compile time by defining CRC16_KERNEL to one of
+ *           the CRC16_KERNEL_* values. The bitwise kernel needs no tables and is the default. The
+ *           table kernel uses 512 bytes of flash per polynomial and the slice-by-4 kernel 2 kB per
+ *           polynomial. The slice-by-4 kernel is meant for the serialization and host builds,
+ *           where throughput matters more than flash. All kernels give the same results.
  */
  
 #ifndef CRC16_H__
@@ -24,6 +30,21 @@
 
 #include <stdint.h>
 
+#define CRC16_KERNEL_BITWISE     0      /**< Shifts and XORs per byte, no lookup tables. */
+#define CRC16_KERNEL_TABLE       1      /**< One 256 entry lookup table per polynomial. */
+#define CRC16_KERNEL_SLICE_BY_4  2      /**< Four 256 entry lookup tables per polynomial, four bytes per iteration. */
+
+#ifndef CRC16_KERNEL
+#define CRC16_KERNEL             CRC16_KERNEL_BITWISE  /**< Selected calculation kernel. */
+#endif
+
+/**@brief Supported CRC-16 polynomials. */
+typedef enum
+{
+    CRC16_POLY_CCITT,                   /**< x^16 + x^12 + x^5 + 1 (0x1021), MSB first. Used by DFU and HCI transport. */
+    CRC16_POLY_ARC                      /**< x^16 + x^15 + x^2 + 1 (0x8005), LSB first. Used by ANT-FS. */
+} crc16_poly_t;
+
 /**@brief Function for calculating CRC-16 in blocks.
  *
  * Feed each consecutive data block into this function, along with the current value of p_crc as 
@@ -38,6 +59,21 @@
  */
 uint16_t crc16_compute(const uint8_t * p_data, uint32_t size, const uint16_t * p_crc);
 
+/**@brief Function for updating a CRC-16 value with a data block, using the given polynomial.
+ *
+ * Unlike crc16_compute(), the initial value is always passed by the caller, and no inversion is
+ * applied. crc16_compute() is equivalent to this function with CRC16_POLY_CCITT and an initial
+ * value of 0xFFFF.
+ *
+ * @param[in] poly   The polynomial to use.
+ * @param[in] crc    The current CRC-16 value.
+ * @param[in] p_data The input data block for computation.
+ * @param[in] size   The size of the input data block in bytes.
+ *
+ * @return The updated CRC-16 value, or crc unchanged if poly is not supported.
+ */
+uint16_t crc16_update(crc16_poly_t poly, uint16_t crc, const uint8_t * p_data, uint32_t size);
+
 #endif // CRC16_H__
  
 /** @} */
@@ -13,6 +13,8 @@
 #include "app_fifo.h"
 #include "nrf_error.h"
 #include "app_util.h"
+#include "nordic_common.h"
+#include <string.h>
 
 static __INLINE uint32_t fifo_length(app_fifo_t * p_fifo)
 {
@@ -23,6 +25,42 @@ static __INLINE uint32_t fifo_length(app_fifo_t * p_fifo)
 #define FIFO_LENGTH fifo_length(p_fifo)  /**< Macro for calculating the FIFO length. */
 
 
+/**@brief Copy len bytes out of the FIFO starting at read_pos, handling the wrap point.
+ *        Does not update read_pos.
+ */
+static void fifo_copy_out(app_fifo_t * p_fifo, uint8_t * p_dst, uint32_t len)
+{
+    uint32_t index = p_fifo->read_pos & p_fifo->buf_size_mask;
+    uint32_t first = p_fifo->buf_size_mask + 1 - index;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    memcpy(p_dst, &p_fifo->p_buf[index], first);
+    memcpy(p_dst + first, p_fifo->p_buf, len - first);
+}
+
+
+/**@brief Copy len bytes into the FIFO starting at write_pos, handling the wrap point.
+ *        Does not update write_pos.
+ */
+static void fifo_copy_in(app_fifo_t * p_fifo, uint8_t const * p_src, uint32_t len)
+{
+    uint32_t index = p_fifo->write_pos & p_fifo->buf_size_mask;
+    uint32_t first = p_fifo->buf_size_mask + 1 - index;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    memcpy(&p_fifo->p_buf[index], p_src, first);
+    memcpy(p_fifo->p_buf, p_src + first, len - first);
+}
+
+
 uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size)
 {
     // Check buffer for null pointer.
@@ -77,3 +115,113 @@ uint32_t app_fifo_flush(app_fifo_t * p_fifo)
     p_fifo->read_pos = p_fifo->write_pos;
     return NRF_SUCCESS;
 }
+
+
+uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p_size)
+{
+    const uint32_t byte_count = FIFO_LENGTH;
+    uint32_t       read_size;
+
+    if (byte_count == 0)
+    {
+        *p_size = 0;
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    if (p_byte_array == NULL)
+    {
+        *p_size = byte_count;
+        return NRF_SUCCESS;
+    }
+
+    read_size = MIN(*p_size, byte_count);
+    fifo_copy_out(p_fifo, p_byte_array, read_size);
+    p_fifo->read_pos += read_size;
+
+    *p_size = read_size;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size)
+{
+    const uint32_t available_count = p_fifo->buf_size_mask + 1 - FIFO_LENGTH;
+    uint32_t       write_size;
+
+    if (available_count == 0)
+    {
+        *p_size = 0;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    if (p_byte_array == NULL)
+    {
+        *p_size = available_count;
+        return NRF_SUCCESS;
+    }
+
+    write_size = MIN(*p_size, available_count);
+    fifo_copy_in(p_fifo, p_byte_array, write_size);
+    p_fifo->write_pos += write_size;
+
+    *p_size = write_size;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_write_reserve(app_fifo_t * p_fifo, uint8_t ** pp_span, uint32_t * p_size)
+{
+    const uint32_t available_count = p_fifo->buf_size_mask + 1 - FIFO_LENGTH;
+    const uint32_t index           = p_fifo->write_pos & p_fifo->buf_size_mask;
+
+    if (available_count == 0)
+    {
+        *p_size = 0;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    *pp_span = &p_fifo->p_buf[index];
+    *p_size  = MIN(available_count, p_fifo->buf_size_mask + 1 - index);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_write_commit(app_fifo_t * p_fifo, uint32_t size)
+{
+    if (size > p_fifo->buf_size_mask + 1 - FIFO_LENGTH)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->write_pos += size;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_read_peek(app_fifo_t * p_fifo, uint8_t ** pp_span, uint32_t * p_size)
+{
+    const uint32_t byte_count = FIFO_LENGTH;
+    const uint32_t index      = p_fifo->read_pos & p_fifo->buf_size_mask;
+
+    if (byte_count == 0)
+    {
+        *p_size = 0;
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *pp_span = &p_fifo->p_buf[index];
+    *p_size  = MIN(byte_count, p_fifo->buf_size_mask + 1 - index);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_read_commit(app_fifo_t * p_fifo, uint32_t size)
+{
+    if (size > FIFO_LENGTH)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->read_pos += size;
+    return NRF_SUCCESS;
+}
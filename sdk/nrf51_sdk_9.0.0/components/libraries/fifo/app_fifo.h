@@ -77,6 +77,96 @@ uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte);
  */
 uint32_t app_fifo_flush(app_fifo_t * p_fifo);
 
+/**@brief Function for reading bytes from the FIFO.
+ *
+ * This function can also be used to get the number of bytes in the FIFO. The wrap point of
+ * the buffer is handled with at most two memory copies.
+ *
+ * @param[in]    p_fifo        Pointer to the FIFO. Must not be NULL.
+ * @param[out]   p_byte_array  Memory pointer where the read bytes are fetched from the FIFO.
+ *                             Can be NULL. If NULL, the number of bytes that can be read in the
+ *                             FIFO are returned in the p_size parameter.
+ * @param[inout] p_size        Address to memory indicating the maximum number of bytes to be
+ *                             read. The provided memory is overwritten with the actual number of
+ *                             bytes read if successful, or the number of bytes available if
+ *                             p_byte_array is NULL.
+ *
+ * @retval     NRF_SUCCESS              If the procedure is successful. The actual number of bytes
+ *                                      read might be smaller than the requested maximum.
+ * @retval     NRF_ERROR_NOT_FOUND      If the FIFO is empty.
+ */
+uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p_size);
+
+/**@brief Function for writing bytes to the FIFO.
+ *
+ * This function can also be used to get the free space in the FIFO. The wrap point of the
+ * buffer is handled with at most two memory copies.
+ *
+ * @param[in]    p_fifo        Pointer to the FIFO. Must not be NULL.
+ * @param[in]    p_byte_array  Memory pointer containing the bytes to be written to the FIFO.
+ *                             Can be NULL. If NULL, the number of bytes that can be written to
+ *                             the FIFO are returned in the p_size parameter.
+ * @param[inout] p_size        Address to memory indicating the maximum number of bytes to be
+ *                             written. The provided memory is overwritten with the number of
+ *                             bytes that were actually written, or the free space if
+ *                             p_byte_array is NULL.
+ *
+ * @retval     NRF_SUCCESS              If the procedure is successful. The actual number of bytes
+ *                                      written might be smaller than the requested maximum.
+ * @retval     NRF_ERROR_NO_MEM         If the FIFO is full.
+ */
+uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size);
+
+/**@brief Function for reserving a contiguous span of free space in the FIFO.
+ *
+ * The producer can fill the returned span in place and then publish it with
+ * @ref app_fifo_write_commit. The span never crosses the wrap point of the buffer, so it can be
+ * shorter than the total free space.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO.
+ * @param[out] pp_span  Start of the contiguous free span.
+ * @param[out] p_size   Number of bytes available in the span.
+ *
+ * @retval     NRF_SUCCESS              If a span was returned.
+ * @retval     NRF_ERROR_NO_MEM         If the FIFO is full.
+ */
+uint32_t app_fifo_write_reserve(app_fifo_t * p_fifo, uint8_t ** pp_span, uint32_t * p_size);
+
+/**@brief Function for publishing bytes written in place after @ref app_fifo_write_reserve.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO.
+ * @param[in]  size     Number of bytes written to the reserved span.
+ *
+ * @retval     NRF_SUCCESS              If the bytes were added to the FIFO.
+ * @retval     NRF_ERROR_INVALID_LENGTH If size is larger than the free space in the FIFO.
+ */
+uint32_t app_fifo_write_commit(app_fifo_t * p_fifo, uint32_t size);
+
+/**@brief Function for peeking at the contiguous span of data at the head of the FIFO.
+ *
+ * The consumer can process the returned span in place and then release it with
+ * @ref app_fifo_read_commit. The span never crosses the wrap point of the buffer, so it can be
+ * shorter than the total FIFO length.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO.
+ * @param[out] pp_span  Start of the contiguous data span.
+ * @param[out] p_size   Number of bytes available in the span.
+ *
+ * @retval     NRF_SUCCESS              If a span was returned.
+ * @retval     NRF_ERROR_NOT_FOUND      If the FIFO is empty.
+ */
+uint32_t app_fifo_read_peek(app_fifo_t * p_fifo, uint8_t ** pp_span, uint32_t * p_size);
+
+/**@brief Function for releasing bytes consumed in place after @ref app_fifo_read_peek.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO.
+ * @param[in]  size     Number of bytes to remove from the head of the FIFO.
+ *
+ * @retval     NRF_SUCCESS              If the bytes were removed from the FIFO.
+ * @retval     NRF_ERROR_INVALID_LENGTH If size is larger than the FIFO length.
+ */
+uint32_t app_fifo_read_commit(app_fifo_t * p_fifo, uint32_t size);
+
 #endif // APP_FIFO_H__
 
 /** @} */
@@ -16,6 +16,9 @@
 #include "app_uart.h"
 #include "nrf51_bitfields.h"
 #include "nrf_error.h"
+#ifdef HCI_SLIP_BLOCK
+#include "slip.h"
+#endif
 
 #define APP_SLIP_END        0xC0                            /**< SLIP code for identifying the beginning and end of a packet frame.. */
 #define APP_SLIP_ESC        0xDB                            /**< SLIP escape code. This code is used to specify that the following character is specially encoded. */
@@ -43,6 +46,22 @@ static uint8_t *                mp_rx_buffer;               /** Pointer to the c
 static uint32_t                 m_rx_buffer_length;         /** Length of the current RX buffer. */
 static uint32_t                 m_rx_received_count;        /** Number of SLIP decoded bytes received and stored in mp_rx_buffer. */
 
+#ifdef HCI_SLIP_BLOCK
+/** @brief Stages of a packet transmission in block mode. In block mode the packet is encoded
+ *         straight into the UART TX FIFO, and received bytes are decoded straight from the UART
+ *         RX FIFO, a span at a time instead of one byte per UART event. */
+typedef enum
+{
+    SLIP_TX_START,                                          /**< Opening SLIP end byte not written to the UART yet. */
+    SLIP_TX_DATA,                                           /**< Encoding the TX buffer. */
+    SLIP_TX_END,                                            /**< Closing SLIP end byte not written to the UART yet. */
+    SLIP_TX_DRAIN,                                          /**< Packet written to the UART, waiting for APP_UART_TX_EMPTY. */
+} slip_tx_stage_t;
+
+static slip_tx_stage_t          m_tx_stage;                 /** Stage of the packet transmission. */
+static slip_encoder_t           m_slip_encoder;             /** Encoder for the packet in transmission. */
+static slip_decoder_t           m_slip_decoder;             /** Decoder for the packet being received to mp_rx_buffer. */
+#else
 
 /**@brief Function for parsing bytes received on the UART until a SLIP escape byte is received.
  *
@@ -90,7 +109,9 @@ static uint32_t send_tx_byte_end(void);
 /**@brief Function pointer for sending a byte through the UART module.
  */
 uint32_t (*send_tx_byte) (void) = send_tx_byte_default;
+#endif
 
+#ifndef HCI_SLIP_BLOCK
 
 static uint32_t send_tx_byte_end(void)
 {
@@ -306,6 +327,100 @@ static bool rx_buffer_overflowed(void)
 
     return false;
 }
+#else
+/** @brief Function for writing as much of the mp_tx_buffer as fits to the UART TX FIFO.
+ *         The transmission is completed on APP_UART_TX_EMPTY when the whole packet is written.
+ */
+static void transmit_buffer(void)
+{
+    uint8_t * p_span;
+    uint32_t  span_len;
+    uint32_t  out_len;
+    uint32_t  in_len;
+    uint32_t  len;
+
+    while ((m_tx_stage != SLIP_TX_DRAIN) &&
+           (app_uart_write_reserve(&p_span, &span_len) == NRF_SUCCESS))
+    {
+        out_len = 0;
+
+        if (m_tx_stage == SLIP_TX_START)
+        {
+            p_span[out_len++] = APP_SLIP_END;
+            m_tx_stage        = SLIP_TX_DATA;
+        }
+
+        if ((m_tx_stage == SLIP_TX_DATA) && (out_len < span_len))
+        {
+            in_len = m_tx_buffer_length - m_tx_buffer_index;
+            len    = span_len - out_len;
+
+            if (slip_encode(&m_slip_encoder,
+                            &mp_tx_buffer[m_tx_buffer_index],
+                            &in_len,
+                            &p_span[out_len],
+                            &len) == NRF_SUCCESS)
+            {
+                m_tx_stage = SLIP_TX_END;
+            }
+
+            m_tx_buffer_index += in_len;
+            out_len           += len;
+        }
+
+        if ((m_tx_stage == SLIP_TX_END) && (out_len < span_len))
+        {
+            p_span[out_len++] = APP_SLIP_END;
+            m_tx_stage        = SLIP_TX_DRAIN;
+        }
+
+        (void)app_uart_write_commit(out_len);
+    }
+}
+
+
+/** @brief Function for decoding all bytes in the UART RX FIFO.
+ *         A received packet is pushed up with HCI_SLIP_RX_RDY and invalidates the RX buffer, no
+ *         new bytes can be received until a new RX buffer is supplied. A packet that does not fit
+ *         in the RX buffer is dropped with HCI_SLIP_RX_OVERFLOW.
+ */
+static void handle_rx_data(void)
+{
+    uint8_t * p_span;
+    uint32_t  span_len;
+    uint32_t  err_code;
+
+    while (app_uart_read_peek(&p_span, &span_len) == NRF_SUCCESS)
+    {
+        err_code = slip_decode(&m_slip_decoder, p_span, &span_len);
+        (void)app_uart_read_commit(span_len);
+
+        if (err_code == NRF_SUCCESS)
+        {
+            hci_slip_evt_t event = {HCI_SLIP_RX_RDY, m_slip_decoder.p_buffer, m_slip_decoder.len};
+
+            mp_rx_buffer = NULL;
+            slip_decoder_buffer_set(&m_slip_decoder, NULL, 0);
+
+            if (m_slip_event_handler != NULL)
+            {
+                m_slip_event_handler(event);
+            }
+        }
+        else if (err_code == NRF_ERROR_NO_MEM)
+        {
+            hci_slip_evt_t event = {HCI_SLIP_RX_OVERFLOW, m_slip_decoder.p_buffer, m_slip_decoder.len};
+
+            slip_decoder_skip(&m_slip_decoder);
+
+            if (m_slip_event_handler != NULL)
+            {
+                m_slip_event_handler(event);
+            }
+        }
+    }
+}
+#endif
 
 
 /** @brief Function for handling the UART module event. It parses events from the UART when
@@ -315,6 +430,32 @@ static bool rx_buffer_overflowed(void)
  */
 static void slip_uart_eventhandler(app_uart_evt_t * uart_event)
 {
+#ifdef HCI_SLIP_BLOCK
+    if (uart_event->evt_type == APP_UART_TX_EMPTY && m_current_state == SLIP_TRANSMITTING)
+    {
+        if (m_tx_stage == SLIP_TX_DRAIN)
+        {
+            // Packet transmission ended. Notify higher level.
+            m_current_state = SLIP_READY;
+
+            if (m_slip_event_handler != NULL)
+            {
+                hci_slip_evt_t event = {HCI_SLIP_TX_DONE, mp_tx_buffer, m_tx_buffer_index};
+
+                m_slip_event_handler(event);
+            }
+        }
+        else
+        {
+            transmit_buffer();
+        }
+    }
+
+    if (uart_event->evt_type == APP_UART_DATA_READY)
+    {
+        handle_rx_data();
+    }
+#else
     if (uart_event->evt_type == APP_UART_TX_EMPTY && m_current_state == SLIP_TRANSMITTING)
     {
         transmit_buffer();
@@ -324,6 +465,7 @@ static void slip_uart_eventhandler(app_uart_evt_t * uart_event)
     {
         handle_rx_byte(uart_event->data.value);
     }
+#endif
 }
 
 
@@ -344,11 +486,23 @@ static uint32_t slip_uart_open(void)
         HCI_SLIP_UART_BAUDRATE
     };
 
+#ifdef HCI_SLIP_BLOCK
+    static uint8_t     rx_buf[HCI_SLIP_UART_RX_BUF_SIZE];
+    static uint8_t     tx_buf[HCI_SLIP_UART_TX_BUF_SIZE];
+    app_uart_buffers_t buffers = {rx_buf, sizeof(rx_buf), tx_buf, sizeof(tx_buf)};
+
+    err_code = app_uart_init(&comm_params,
+                             &buffers,
+                             slip_uart_eventhandler,
+                             APP_IRQ_PRIORITY_LOW,
+                             &m_uart_id);
+#else
     err_code = app_uart_init(&comm_params,
                              NULL,
                              slip_uart_eventhandler,
                              APP_IRQ_PRIORITY_LOW,
                              &m_uart_id);
+#endif
 
     if (err_code == NRF_SUCCESS)
     {
@@ -406,7 +560,12 @@ uint32_t hci_slip_write(const uint8_t * p_buffer, uint32_t length)
             m_tx_buffer_length = length;
             mp_tx_buffer       = p_buffer;
             m_current_state    = SLIP_TRANSMITTING;
+#ifdef HCI_SLIP_BLOCK
+            m_tx_stage         = SLIP_TX_START;
+            slip_encoder_init(&m_slip_encoder);
+#else
             send_tx_byte       = send_tx_byte_end;
+#endif
 
             transmit_buffer();
             return NRF_SUCCESS;
@@ -426,6 +585,11 @@ uint32_t hci_slip_rx_buffer_register(uint8_t * p_buffer, uint32_t length)
     mp_rx_buffer        = p_buffer;
     m_rx_buffer_length  = length;
     m_rx_received_count = 0;
+#ifdef HCI_SLIP_BLOCK
+    slip_decoder_buffer_set(&m_slip_decoder, p_buffer, length);
+    slip_decoder_skip(&m_slip_decoder);
+#else
     handle_rx_byte      = handle_rx_byte_wait_start;
+#endif
     return NRF_SUCCESS;
 }
@@ -14,6 +14,7 @@
 #include "sdk_common.h"
 #include "mem_manager.h"
 #include "app_trace.h"
+#include <string.h>
 
 /**
  * @defgroup mem_manager_log Module's Log Macros
@@ -99,20 +100,12 @@
 
 #endif //MEM_MANAGER_DISABLE_API_PARAM_CHECK
 
-#define BLOCK_CAT_COUNT                3                                                            /**< Block category count is 3 (small, medium and large). Having one of the block count to zero has no impact on this count. */
-#define BLOCK_CAT_SMALL                0                                                            /**< Small category identifier. */
-#define BLOCK_CAT_MEDIUM               1                                                            /**< Medium category identifier. */
-#define BLOCK_CAT_LARGE                2                                                            /**< Large category identifier. */
+#define BLOCK_CAT_COUNT                MEM_MANAGER_BLOCK_CAT_COUNT                                  /**< Block category count is 3 (small, medium and large). Having one of the block count to zero has no impact on this count. */
+#define BLOCK_CAT_SMALL                MEM_MANAGER_BLOCK_CAT_SMALL                                  /**< Small category identifier. */
+#define BLOCK_CAT_MEDIUM               MEM_MANAGER_BLOCK_CAT_MEDIUM                                 /**< Medium category identifier. */
+#define BLOCK_CAT_LARGE                MEM_MANAGER_BLOCK_CAT_LARGE                                  /**< Large category identifier. */
 
 
-/** Memory block type. */
-typedef struct
-{
-   uint8_t   * p_block;                                                                             /**< Pointer to memory region of the block. */
-   bool        is_free;                                                                             /**< Indicates whether the memory region has been assigned or is free. */
-   uint8_t     block_cat;                                                                           /**< Identifies to which category the block belongs, small, large or medium. */
-}mem_block_t;
-
 /** Based on which blocks are defined, MAX_MEM_SIZE is determined.
     Also, in case none of these are defined, a compile time error is indicated. */
 #if (MEMORY_MANAGER_LARGE_BLOCK_COUNT != 0)
@@ -138,17 +131,52 @@ typedef struct
                            (MEMORY_MANAGER_LARGE_BLOCK_COUNT  * MEMORY_MANAGER_LARGE_BLOCK_SIZE))
 
 
+/** Free blocks are chained through a pointer stored in their first bytes. */
+STATIC_ASSERT((MEMORY_MANAGER_SMALL_BLOCK_COUNT  == 0) || (MEMORY_MANAGER_SMALL_BLOCK_SIZE  >= sizeof(uint8_t *)));
+STATIC_ASSERT((MEMORY_MANAGER_MEDIUM_BLOCK_COUNT == 0) || (MEMORY_MANAGER_MEDIUM_BLOCK_SIZE >= sizeof(uint8_t *)));
+STATIC_ASSERT((MEMORY_MANAGER_LARGE_BLOCK_COUNT  == 0) || (MEMORY_MANAGER_LARGE_BLOCK_SIZE  >= sizeof(uint8_t *)));
+
+
 static uint8_t m_memory[TOTAL_MEMORY_SIZE];                                                         /**< Memory managed by the module. */
 
-static mem_block_t m_mem_pool[TOTAL_BLOCK_COUNT];                                                   /**< Pool of memory blocks managed by the module. */
+static uint8_t * m_free_list[BLOCK_CAT_COUNT];                                                      /**< Head of the list of free blocks in each category, NULL if the category is exhausted. */
+
+static uint32_t m_block_in_use[CEIL_DIV(TOTAL_BLOCK_COUNT, 32)];                                    /**< Bit field with one bit set for each assigned block, used to reject invalid frees. */
 
 static const uint32_t m_block_size[BLOCK_CAT_COUNT] =                                               /**< Lookup table used to know the max size of block */
 {
     MEMORY_MANAGER_SMALL_BLOCK_SIZE,
-	MEMORY_MANAGER_MEDIUM_BLOCK_SIZE,
-	MEMORY_MANAGER_LARGE_BLOCK_SIZE
+    MEMORY_MANAGER_MEDIUM_BLOCK_SIZE,
+    MEMORY_MANAGER_LARGE_BLOCK_SIZE
+};
+
+static const uint32_t m_block_count[BLOCK_CAT_COUNT] =                                              /**< Lookup table used to know the number of blocks in each category. */
+{
+    MEMORY_MANAGER_SMALL_BLOCK_COUNT,
+    MEMORY_MANAGER_MEDIUM_BLOCK_COUNT,
+    MEMORY_MANAGER_LARGE_BLOCK_COUNT
+};
+
+static const uint32_t m_block_first_index[BLOCK_CAT_COUNT] =                                        /**< Lookup table used to know the index of the first block of each category. */
+{
+    0,
+    MEMORY_MANAGER_SMALL_BLOCK_COUNT,
+    MEMORY_MANAGER_SMALL_BLOCK_COUNT + MEMORY_MANAGER_MEDIUM_BLOCK_COUNT
 };
 
+static const uint32_t m_block_offset[BLOCK_CAT_COUNT] =                                             /**< Lookup table used to know where each category starts in m_memory. */
+{
+    0,
+    MEMORY_MANAGER_SMALL_BLOCK_COUNT * MEMORY_MANAGER_SMALL_BLOCK_SIZE,
+    (MEMORY_MANAGER_SMALL_BLOCK_COUNT * MEMORY_MANAGER_SMALL_BLOCK_SIZE) +
+    (MEMORY_MANAGER_MEDIUM_BLOCK_COUNT * MEMORY_MANAGER_MEDIUM_BLOCK_SIZE)
+};
+
+#if (MEM_MANAGER_ENABLE_DIAGNOSTICS == 1)
+static nrf51_sdk_mem_stats_t m_stats[BLOCK_CAT_COUNT];                                              /**< Usage statistics of each category. */
+static uint16_t              m_block_requested[TOTAL_BLOCK_COUNT];                                  /**< Size requested by the application for each assigned block. */
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+
 SDK_MUTEX_DEFINE(m_mm_mutex)                                                                        /**< Mutex variable. Currently unused, this declaration does not occupy any space in RAM. */
 #if (MEM_MANAGER_DISABLE_API_PARAM_CHECK == 0)
 static bool     m_module_initialized = false;                                                       /**< State indicating if module is initialized or not. */
@@ -156,67 +184,95 @@ static bool     m_module_initialized = false;
 
 
 
-/**@brief Initializes the block by setting it to be free. */
-static __INLINE void block_init (mem_block_t * p_block)
+/**@brief Reads the link to the next free block, stored in a free block.
+ *
+ * @details Block sizes need not be multiples of the word size, so the link is copied bytewise.
+ */
+static __INLINE uint8_t * block_next_get(uint8_t * p_block)
 {
-    p_block->is_free = true;
+    uint8_t * p_next;
+
+    memcpy(&p_next, p_block, sizeof(p_next));
+    return p_next;
 }
 
 
-uint32_t nrf51_sdk_mem_init(void)
+/**@brief Initializes the block by setting it to be free, and puts it first in its free list. */
+static __INLINE void block_init(uint32_t block_cat, uint32_t index, uint8_t * p_block)
 {
-    MM_LOG("[MM]: >> nrf51_sdk_mem_init.\r\n");
-
-    SDK_MUTEX_INIT(m_mm_mutex);
-
-    MM_MUTEX_LOCK();
+    memcpy(p_block, &m_free_list[block_cat], sizeof(m_free_list[block_cat]));
+    m_free_list[block_cat]      = p_block;
+    m_block_in_use[index / 32] &= ~(1UL << (index % 32));
+}
 
-    uint32_t index = 0;
-    uint32_t pool_block_size;
-    uint8_t  * p_memory = m_memory;
-    uint32_t block_count = 0;
 
-#if (MEMORY_MANAGER_SMALL_BLOCK_COUNT != 0)
+/**@brief Finds the category and index of a block from its address.
+ *
+ * @param[in]  p_buffer     Address of the block.
+ * @param[out] p_block_cat  Category of the block.
+ * @param[out] p_index      Index of the block, counted across all categories.
+ *
+ * @retval true if p_buffer is the start of a block managed by the module, false otherwise.
+ */
+static bool block_lookup(uint8_t * p_buffer, uint32_t * p_block_cat, uint32_t * p_index)
+{
+    uint32_t block_cat;
 
-    pool_block_size = MEMORY_MANAGER_SMALL_BLOCK_SIZE;
-    block_count    += MEMORY_MANAGER_SMALL_BLOCK_COUNT;
-	
-    for(; index < block_count; index++)
+    if ((p_buffer < m_memory) || (p_buffer >= &m_memory[TOTAL_MEMORY_SIZE]))
     {
-        block_init(&m_mem_pool[index]);
-        m_mem_pool[index].p_block    = p_memory;
-        p_memory                    += pool_block_size;
-		m_mem_pool[index].block_cat  = BLOCK_CAT_SMALL;        
+        return false;
     }
-#endif // MEMORY_MANAGER_SMALL_BLOCK_COUNT
 
-#if (MEMORY_MANAGER_MEDIUM_BLOCK_COUNT != 0)
+    const uint32_t offset = p_buffer - m_memory;
 
-    pool_block_size = MEMORY_MANAGER_MEDIUM_BLOCK_SIZE;
-    block_count    += MEMORY_MANAGER_MEDIUM_BLOCK_COUNT;
-	
-    for(; index < block_count; index++)
+    for (block_cat = BLOCK_CAT_COUNT; block_cat-- > 0; )
     {
-        block_init(&m_mem_pool[index]);
-        m_mem_pool[index].p_block   = p_memory;
-        p_memory                   += pool_block_size;
-		m_mem_pool[index].block_cat = BLOCK_CAT_MEDIUM;
+        if ((m_block_count[block_cat] != 0) && (offset >= m_block_offset[block_cat]))
+        {
+            const uint32_t block_offset = offset - m_block_offset[block_cat];
+
+            if ((block_offset % m_block_size[block_cat]) != 0)
+            {
+                return false;
+            }
+
+            (*p_block_cat) = block_cat;
+            (*p_index)     = m_block_first_index[block_cat] + (block_offset / m_block_size[block_cat]);
+            return true;
+        }
     }
-#endif // MEMORY_MANAGER_MEDIUM_BLOCK_COUNT
 
-#if (MEMORY_MANAGER_LARGE_BLOCK_COUNT != 0)
+    return false;
+}
+
+
+uint32_t nrf51_sdk_mem_init(void)
+{
+    MM_LOG("[MM]: >> nrf51_sdk_mem_init.\r\n");
 
-    pool_block_size = MEMORY_MANAGER_LARGE_BLOCK_SIZE;
-    block_count    += MEMORY_MANAGER_LARGE_BLOCK_COUNT;
-	
-    for(; index <block_count; index++)
+    SDK_MUTEX_INIT(m_mm_mutex);
+
+    MM_MUTEX_LOCK();
+
+    uint32_t block_cat;
+    uint32_t index;
+
+    for (block_cat = 0; block_cat < BLOCK_CAT_COUNT; block_cat++)
     {
-        block_init(&m_mem_pool[index]);
-        m_mem_pool[index].p_block   = p_memory;
-        p_memory                   += pool_block_size;
-		m_mem_pool[index].block_cat = BLOCK_CAT_LARGE;
+        m_free_list[block_cat] = NULL;
+
+        // Put the blocks in the list from the last one, so they are assigned in address order.
+        for (index = m_block_count[block_cat]; index-- > 0; )
+        {
+            block_init(block_cat,
+                       m_block_first_index[block_cat] + index,
+                       &m_memory[m_block_offset[block_cat] + (index * m_block_size[block_cat])]);
+        }
     }
-#endif // MEMORY_MANAGER_LARGE_BLOCK_COUNT
+
+#if (MEM_MANAGER_ENABLE_DIAGNOSTICS == 1)
+    memset(m_stats, 0, sizeof(m_stats));
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
 
 #if (MEM_MANAGER_DISABLE_API_PARAM_CHECK == 0)
     m_module_initialized = true;
@@ -235,8 +291,8 @@ uint32_t nrf51_sdk_mem_alloc(uint8_t ** pp_buffer, uint32_t * p_size)
     VERIFY_MODULE_INITIALIZED();
     NULL_PARAM_CHECK(pp_buffer);
     NULL_PARAM_CHECK(p_size);
-	
-	const uint32_t requested_size = (*p_size);	
+
+    const uint32_t requested_size = (*p_size);
     VERIFY_REQUESTED_SIZE(requested_size);
 
     MM_LOG("[MM]: >> nrf51_sdk_mem_alloc, size 0x%04lX.\r\n", requested_size);
@@ -244,39 +300,75 @@ uint32_t nrf51_sdk_mem_alloc(uint8_t ** pp_buffer, uint32_t * p_size)
     MM_MUTEX_LOCK();
 
     uint32_t err_code = (NRF_ERROR_NO_MEM | MEMORY_MANAGER_ERR_BASE);
-    uint32_t index;
+    uint32_t requested_cat;
+    uint32_t block_cat;
 
     // Check which block size is best suited for requested memory size.
     if (requested_size <= MEMORY_MANAGER_SMALL_BLOCK_SIZE)
     {
-        index = 0;
+        requested_cat = BLOCK_CAT_SMALL;
     }
     else if(requested_size <= MEMORY_MANAGER_MEDIUM_BLOCK_SIZE)
     {
-       index = MEMORY_MANAGER_SMALL_BLOCK_COUNT;
+        requested_cat = BLOCK_CAT_MEDIUM;
     }
     else
     {
-       index = (MEMORY_MANAGER_SMALL_BLOCK_COUNT + MEMORY_MANAGER_MEDIUM_BLOCK_COUNT);
+        requested_cat = BLOCK_CAT_LARGE;
     }
 
-    MM_LOG("[MM]: Start index for the pool = 0x%08lX, total block count 0x%08X\r\n",
-           index, TOTAL_BLOCK_COUNT);
+    (*pp_buffer) = NULL;
 
-    for (; index < TOTAL_BLOCK_COUNT; index++)
+    // Take the first block of the best suited category, or of the next larger category that has
+    // one free if fallback is enabled.
+    for (block_cat = requested_cat; block_cat < BLOCK_CAT_COUNT; block_cat++)
     {
-        if (m_mem_pool[index].is_free == true)
+        uint8_t * p_block = m_free_list[block_cat];
+
+        if (p_block != NULL)
         {
+            const uint32_t index = m_block_first_index[block_cat] +
+                                   (p_block - &m_memory[m_block_offset[block_cat]]) / m_block_size[block_cat];
+
             MM_LOG("[MM]: Assigning block 0x%08lX\r\n", index);
-            // Found a free block of memory, assign.
-            m_mem_pool[index].is_free = false;
-            (*pp_buffer)              = m_mem_pool[index].p_block;
-            err_code                  = NRF_SUCCESS;
-			(*p_size)                 = m_block_size[m_mem_pool[index].block_cat];
+
+            m_free_list[block_cat]      = block_next_get(p_block);
+            m_block_in_use[index / 32] |= (1UL << (index % 32));
+            (*pp_buffer)                = p_block;
+            (*p_size)                   = m_block_size[block_cat];
+            err_code                    = NRF_SUCCESS;
+
+#if (MEM_MANAGER_ENABLE_DIAGNOSTICS == 1)
+            m_block_requested[index]         = requested_size;
+            m_stats[block_cat].unused_bytes += m_block_size[block_cat] - requested_size;
+            if (++m_stats[block_cat].in_use > m_stats[block_cat].peak_in_use)
+            {
+                m_stats[block_cat].peak_in_use = m_stats[block_cat].in_use;
+            }
+            if (block_cat != requested_cat)
+            {
+                m_stats[requested_cat].fallbacks++;
+            }
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
             break;
         }
+
+#if (MEM_MANAGER_DISABLE_FALLBACK == 1)
+        // Only use an exactly matching category, unless it has no blocks at all.
+        if (m_block_count[block_cat] != 0)
+        {
+            break;
+        }
+#endif // MEM_MANAGER_DISABLE_FALLBACK
     }
 
+#if (MEM_MANAGER_ENABLE_DIAGNOSTICS == 1)
+    if (err_code != NRF_SUCCESS)
+    {
+        m_stats[requested_cat].alloc_failures++;
+    }
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+
     MM_MUTEX_UNLOCK();
 
     MM_LOG("[MM]: << nrf51_sdk_mem_alloc %p, result 0x%08lX.\r\n", (*pp_buffer), err_code);
@@ -294,17 +386,23 @@ uint32_t nrf51_sdk_mem_free(uint8_t * p_buffer)
 
     MM_MUTEX_LOCK();
     uint32_t err_code = (NRF_ERROR_INVALID_ADDR | MEMORY_MANAGER_ERR_BASE);
+    uint32_t block_cat;
     uint32_t index;
 
-    for (index = 0; index < TOTAL_BLOCK_COUNT; index++)
+    // The address alone identifies the block, no search is needed.
+    if (block_lookup(p_buffer, &block_cat, &index))
     {
-        if (m_mem_pool[index].p_block == p_buffer)
+        // Freeing a block that is already free is harmless, but must not link it twice.
+        if ((m_block_in_use[index / 32] & (1UL << (index % 32))) != 0)
         {
-            // Found a free block of memory, assign.
-            block_init(&m_mem_pool[index]);
-            err_code = NRF_SUCCESS;
-            break;
+            block_init(block_cat, index, p_buffer);
+
+#if (MEM_MANAGER_ENABLE_DIAGNOSTICS == 1)
+            m_stats[block_cat].in_use--;
+            m_stats[block_cat].unused_bytes -= m_block_size[block_cat] - m_block_requested[index];
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
         }
+        err_code = NRF_SUCCESS;
     }
 
     MM_MUTEX_UNLOCK();
@@ -312,3 +410,25 @@ uint32_t nrf51_sdk_mem_free(uint8_t * p_buffer)
     MM_LOG("[MM]: << nrf51_sdk_mem_free, result 0x%08lX.\r\n", err_code);
     return err_code;
 }
+
+
+#if (MEM_MANAGER_ENABLE_DIAGNOSTICS == 1)
+uint32_t nrf51_sdk_mem_stats_get(uint8_t block_cat, nrf51_sdk_mem_stats_t * p_stats)
+{
+    VERIFY_MODULE_INITIALIZED();
+    NULL_PARAM_CHECK(p_stats);
+
+    if (block_cat >= BLOCK_CAT_COUNT)
+    {
+        return (NRF_ERROR_INVALID_PARAM | MEMORY_MANAGER_ERR_BASE);
+    }
+
+    MM_MUTEX_LOCK();
+
+    (*p_stats) = m_stats[block_cat];
+
+    MM_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
@@ -28,12 +28,34 @@
  * requirements in the configuration file @c sdk_config.h.
  * To disable any of the pools, define the block count to be zero.
  *
+ * Free blocks of each pool are kept in a list linked through the blocks
+ * themselves, so both allocation and free take constant time. A request is
+ * served from the smallest pool that fits, or from a larger pool if that one
+ * is exhausted. Define MEM_MANAGER_DISABLE_FALLBACK to 1 to fail the request
+ * instead. Define MEM_MANAGER_ENABLE_DIAGNOSTICS to 1 to collect per pool
+ * usage statistics, see @ref nrf51_sdk_mem_stats_get.
+ *
  */
 #ifndef MEM_MANAGER_H__
 #define MEM_MANAGER_H__
 
 #include "sdk_common.h"
 
+#define MEM_MANAGER_BLOCK_CAT_COUNT    3                                                            /**< Number of block categories. */
+#define MEM_MANAGER_BLOCK_CAT_SMALL    0                                                            /**< Small block category. */
+#define MEM_MANAGER_BLOCK_CAT_MEDIUM   1                                                            /**< Medium block category. */
+#define MEM_MANAGER_BLOCK_CAT_LARGE    2                                                            /**< Large block category. */
+
+/**@brief Usage statistics of a block category. */
+typedef struct
+{
+    uint16_t in_use;                                                                                /**< Number of blocks currently assigned. */
+    uint16_t peak_in_use;                                                                           /**< Largest number of blocks assigned at the same time. */
+    uint32_t alloc_failures;                                                                        /**< Number of requests best suited for this category that could not be served. */
+    uint32_t fallbacks;                                                                             /**< Number of requests best suited for this category that were served by a larger category. */
+    uint32_t unused_bytes;                                                                          /**< Bytes in assigned blocks that were not requested by the application (internal fragmentation). */
+} nrf51_sdk_mem_stats_t;
+
 
 /**@brief Initializes Memory Manager.
  *
@@ -90,5 +112,19 @@ uint32_t nrf51_sdk_mem_alloc(uint8_t ** pp_buffer, uint32_t * p_size);
 uint32_t nrf51_sdk_mem_free(uint8_t * p_buffer);
 
 
+/**@brief Reads the usage statistics of a block category.
+ *
+ * @details Only available when MEM_MANAGER_ENABLE_DIAGNOSTICS is 1. This costs
+ * two bytes of RAM per block to remember the requested sizes.
+ *
+ * @param[in]  block_cat              One of the MEM_MANAGER_BLOCK_CAT_* values.
+ * @param[out] p_stats                Statistics of the category since @ref nrf51_sdk_mem_init.
+ *
+ * @retval     NRF_SUCCESS            If the statistics were successfully read.
+ * @retval     NRF_ERROR_INVALID_PARAM If the category is not valid.
+ */
+uint32_t nrf51_sdk_mem_stats_get(uint8_t block_cat, nrf51_sdk_mem_stats_t * p_stats);
+
+
 #endif // MEM_MANAGER_H__
 /** @} */
@@ -18,21 +18,57 @@
 #include "nrf_assert.h"
 #include "app_util.h"
 #include "app_util_platform.h"
+#include "nordic_common.h"
+
+/**@brief Scheduled event states. */
+#define EVENT_STATE_ALLOCATED   0   /**< Event allocated, data is being written by the producer. */
+#define EVENT_STATE_COMMITTED   1   /**< Event ready for execution. */
+#define EVENT_STATE_WRAP        2   /**< Ring only: no event here, continue at the start of the buffer. */
 
 /**@brief Structure for holding a scheduled event header. */
 typedef struct
 {
     app_sched_event_handler_t handler;          /**< Pointer to event handler to receive the event. */
     uint16_t                  event_data_size;  /**< Size of event data. */
+    volatile uint8_t          state;            /**< Event state, see EVENT_STATE_*. */
 } event_header_t;
 
 STATIC_ASSERT(sizeof(event_header_t) <= APP_SCHED_EVENT_HEADER_SIZE);
 
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+
+static uint8_t        * m_queue_buf;            /**< Ring buffer holding the event headers and data. */
+static uint32_t         m_queue_buf_size;       /**< Size of the ring buffer. */
+static volatile uint32_t m_queue_start_offset;  /**< Offset of the first event in the ring. */
+static volatile uint32_t m_queue_end_offset;    /**< Offset of the end of the last event in the ring. */
+static uint16_t         m_queue_event_size;     /**< Maximum event size in queue. */
+
+/**@brief Function for getting the ring space used by an event.
+ *
+ * @param[in]   event_data_size   Size of event data.
+ *
+ * @return      Size of the header and word aligned data.
+ */
+static __INLINE uint32_t event_record_size(uint16_t event_data_size)
+{
+    return APP_SCHED_EVENT_HEADER_SIZE + CEIL_DIV(event_data_size, sizeof(uint32_t)) * sizeof(uint32_t);
+}
+
+
+/**@brief Function for getting the event header at a ring offset. */
+static __INLINE event_header_t * event_header_get(uint32_t offset)
+{
+    return (event_header_t *)&m_queue_buf[offset];
+}
+
+#else
+
 static event_header_t * m_queue_event_headers;  /**< Array for holding the queue event headers. */
 static uint8_t        * m_queue_event_data;     /**< Array for holding the queue event data. */
 static volatile uint8_t m_queue_start_index;    /**< Index of queue entry at the start of the queue. */
 static volatile uint8_t m_queue_end_index;      /**< Index of queue entry at the end of the queue. */
 static uint16_t         m_queue_event_size;     /**< Maximum event size in queue. */
+static uint16_t         m_queue_slot_size;      /**< Size of the data slot of each queue entry, the maximum event size rounded up to a word. */
 static uint16_t         m_queue_size;           /**< Number of queue entries. */
 
 /**@brief Function for incrementing a queue index, and handle wrap-around.
@@ -66,76 +102,188 @@ static __INLINE uint8_t app_sched_queue_empty()
 /**@brief Macro for checking if a queue is empty. */
 #define APP_SCHED_QUEUE_EMPTY() app_sched_queue_empty()
 
+#endif // APP_SCHEDULER_WITH_VARIABLE_SIZE
+
 
 uint32_t app_sched_init(uint16_t event_size, uint16_t queue_size, void * p_event_buffer)
 {
-    uint16_t data_start_index = (queue_size + 1) * sizeof(event_header_t);
-
     // Check that buffer is correctly aligned
     if (!is_word_aligned(p_event_buffer))
     {
         return NRF_ERROR_INVALID_PARAM;
     }
 
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+    m_queue_buf          = p_event_buffer;
+    m_queue_buf_size     = APP_SCHED_BUF_SIZE(event_size, queue_size);
+    m_queue_start_offset = 0;
+    m_queue_end_offset   = 0;
+    m_queue_event_size   = event_size;
+#else
+    uint16_t data_start_index = (queue_size + 1) * sizeof(event_header_t);
+
     // Initialize event scheduler
     m_queue_event_headers = p_event_buffer;
     m_queue_event_data    = &((uint8_t *)p_event_buffer)[data_start_index];
     m_queue_end_index     = 0;
     m_queue_start_index   = 0;
     m_queue_event_size    = event_size;
+    m_queue_slot_size     = CEIL_DIV(event_size, sizeof(uint32_t)) * sizeof(uint32_t);
     m_queue_size          = queue_size;
+#endif
 
     return NRF_SUCCESS;
 }
 
 
-uint32_t app_sched_event_put(void                    * p_event_data,
-                             uint16_t                  event_data_size,
-                             app_sched_event_handler_t handler)
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+/**@brief Function for reserving room for an event at the end of the ring.
+ *
+ * @details Must be called from a critical region. The end offset is never allowed to catch up
+ *          with the start offset, as that would make a full ring look empty.
+ *
+ * @param[in]   record_size   Ring space needed by the event.
+ *
+ * @return      Offset of the reserved event, or m_queue_buf_size if the ring is full.
+ */
+static uint32_t ring_reserve(uint32_t record_size)
 {
-    uint32_t err_code;
+    uint32_t start = m_queue_start_offset;
+    uint32_t end   = m_queue_end_offset;
 
-    if (event_data_size <= m_queue_event_size)
+    if (end >= start)
     {
-        uint16_t event_index = 0xFFFF;
-
-        CRITICAL_REGION_ENTER();
-
-        if (!APP_SCHED_QUEUE_FULL())
+        // Free space at the tail, and in front of the start offset.
+        if ((end + record_size < m_queue_buf_size) ||
+            ((end + record_size == m_queue_buf_size) && (start != 0)))
         {
-            event_index       = m_queue_end_index;
-            m_queue_end_index = next_index(m_queue_end_index);
+            m_queue_end_offset = (end + record_size) % m_queue_buf_size;
+            return end;
         }
 
-        CRITICAL_REGION_EXIT();
-
-        if (event_index != 0xFFFF)
+        if (record_size < start)
         {
-            // NOTE: This can be done outside the critical region since the event consumer will
-            //       always be called from the main loop, and will thus never interrupt this code.
-            m_queue_event_headers[event_index].handler = handler;
-            if ((p_event_data != NULL) && (event_data_size > 0))
-            {
-                memcpy(&m_queue_event_data[event_index * m_queue_event_size],
-                       p_event_data,
-                       event_data_size);
-                m_queue_event_headers[event_index].event_data_size = event_data_size;
-            }
-            else
+            // Mark the unused tail so the consumer skips it. A tail smaller than a header is
+            // skipped implicitly.
+            if (m_queue_buf_size - end >= APP_SCHED_EVENT_HEADER_SIZE)
             {
-                m_queue_event_headers[event_index].event_data_size = 0;
+                event_header_get(end)->state = EVENT_STATE_WRAP;
             }
-
-            err_code = NRF_SUCCESS;
+            m_queue_end_offset = record_size;
+            return 0;
         }
-        else
+    }
+    else if (end + record_size < start)
+    {
+        m_queue_end_offset = end + record_size;
+        return end;
+    }
+
+    return m_queue_buf_size;
+}
+#endif // APP_SCHEDULER_WITH_VARIABLE_SIZE
+
+
+uint32_t app_sched_event_alloc(uint16_t                  event_data_size,
+                               app_sched_event_handler_t handler,
+                               void **                   pp_event_data)
+{
+    event_header_t * p_header = NULL;
+    uint8_t        * p_data   = NULL;
+
+    if (event_data_size > m_queue_event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    CRITICAL_REGION_ENTER();
+
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+    uint32_t offset = ring_reserve(event_record_size(event_data_size));
+
+    if (offset != m_queue_buf_size)
+    {
+        p_header = event_header_get(offset);
+        p_data   = &m_queue_buf[offset + APP_SCHED_EVENT_HEADER_SIZE];
+        p_header->state = EVENT_STATE_ALLOCATED;
+    }
+#else
+    if (!APP_SCHED_QUEUE_FULL())
+    {
+        p_header = &m_queue_event_headers[m_queue_end_index];
+        p_data   = &m_queue_event_data[m_queue_end_index * m_queue_slot_size];
+        if (m_queue_slot_size == 0)
         {
-            err_code = NRF_ERROR_NO_MEM;
+            // All slots share the same (empty) data, so the header identifies the event.
+            p_data = (uint8_t *)p_header;
         }
+        p_header->state   = EVENT_STATE_ALLOCATED;
+        m_queue_end_index = next_index(m_queue_end_index);
+    }
+#endif
+
+    CRITICAL_REGION_EXIT();
+
+    if (p_header == NULL)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    // NOTE: This can be done outside the critical region since the event consumer will not
+    //       touch the event until it is committed.
+    p_header->handler         = handler;
+    p_header->event_data_size = event_data_size;
+
+    *pp_event_data = p_data;
+    return NRF_SUCCESS;
+}
+
+
+void app_sched_event_commit(void * p_event_data)
+{
+    event_header_t * p_header;
+
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+    p_header = (event_header_t *)((uint8_t *)p_event_data - APP_SCHED_EVENT_HEADER_SIZE);
+#else
+    if (m_queue_slot_size == 0)
+    {
+        p_header = (event_header_t *)p_event_data;
     }
     else
     {
-        err_code = NRF_ERROR_INVALID_LENGTH;
+        uint32_t event_index = ((uint8_t *)p_event_data - m_queue_event_data) / m_queue_slot_size;
+
+        p_header = &m_queue_event_headers[event_index];
+    }
+#endif
+
+    __DMB();
+    p_header->state = EVENT_STATE_COMMITTED;
+}
+
+
+uint32_t app_sched_event_put(void                    * p_event_data,
+                             uint16_t                  event_data_size,
+                             app_sched_event_handler_t handler)
+{
+    uint32_t err_code;
+    void   * p_queue_data;
+
+    if (p_event_data == NULL)
+    {
+        event_data_size = 0;
+    }
+
+    err_code = app_sched_event_alloc(event_data_size, handler, &p_queue_data);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        if (event_data_size > 0)
+        {
+            memcpy(p_queue_data, p_event_data, event_data_size);
+        }
+        app_sched_event_commit(p_queue_data);
     }
 
     return err_code;
@@ -143,38 +291,80 @@ uint32_t app_sched_event_put(void                    * p_event_data,
 
 
 /**@brief Function for reading the next event from specified event queue.
+ *
+ * @details The event stays in the queue until app_sched_event_release() is called, so the handler
+ *          can use the event data in place.
  *
  * @param[out]  pp_event_data       Pointer to pointer to event data.
  * @param[out]  p_event_data_size   Pointer to size of event data.
  * @param[out]  p_event_handler     Pointer to event handler function pointer.
  *
- * @return      NRF_SUCCESS if new event, NRF_ERROR_NOT_FOUND if event queue is empty.
+ * @return      NRF_SUCCESS if new event, NRF_ERROR_NOT_FOUND if event queue is empty or the next
+ *              event is not yet committed.
  */
 static uint32_t app_sched_event_get(void                     ** pp_event_data,
                                     uint16_t *                  p_event_data_size,
                                     app_sched_event_handler_t * p_event_handler)
 {
-    uint32_t err_code = NRF_ERROR_NOT_FOUND;
+    event_header_t * p_header;
+
+    // NOTE: There is no need for a critical region here, as this function will only be called
+    //       from app_sched_execute() from inside the main loop, so it will never interrupt
+    //       app_sched_event_alloc(). Also, updating of (i.e. writing to) the start index will be
+    //       an atomic operation.
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+    uint32_t start = m_queue_start_offset;
 
-    if (!APP_SCHED_QUEUE_EMPTY())
+    if (start == m_queue_end_offset)
     {
-        uint16_t event_index;
+        return NRF_ERROR_NOT_FOUND;
+    }
 
-        // NOTE: There is no need for a critical region here, as this function will only be called
-        //       from app_sched_execute() from inside the main loop, so it will never interrupt
-        //       app_sched_event_put(). Also, updating of (i.e. writing to) the start index will be
-        //       an atomic operation.
-        event_index         = m_queue_start_index;
-        m_queue_start_index = next_index(m_queue_start_index);
+    if ((m_queue_buf_size - start < APP_SCHED_EVENT_HEADER_SIZE) ||
+        (event_header_get(start)->state == EVENT_STATE_WRAP))
+    {
+        start                = 0;
+        m_queue_start_offset = 0;
+    }
 
-        *pp_event_data     = &m_queue_event_data[event_index * m_queue_event_size];
-        *p_event_data_size = m_queue_event_headers[event_index].event_data_size;
-        *p_event_handler   = m_queue_event_headers[event_index].handler;
+    p_header       = event_header_get(start);
+    *pp_event_data = &m_queue_buf[start + APP_SCHED_EVENT_HEADER_SIZE];
+#else
+    if (APP_SCHED_QUEUE_EMPTY())
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    p_header       = &m_queue_event_headers[m_queue_start_index];
+    *pp_event_data = &m_queue_event_data[m_queue_start_index * m_queue_slot_size];
+#endif
 
-        err_code = NRF_SUCCESS;
+    if (p_header->state != EVENT_STATE_COMMITTED)
+    {
+        return NRF_ERROR_NOT_FOUND;
     }
 
-    return err_code;
+    __DMB();
+    *p_event_data_size = p_header->event_data_size;
+    *p_event_handler   = p_header->handler;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for removing the event returned by app_sched_event_get() from the queue.
+ *
+ * @param[in]   event_data_size   Size of event data.
+ */
+static void app_sched_event_release(uint16_t event_data_size)
+{
+#ifdef APP_SCHEDULER_WITH_VARIABLE_SIZE
+    m_queue_start_offset = (m_queue_start_offset + event_record_size(event_data_size))
+                           % m_queue_buf_size;
+#else
+    UNUSED_PARAMETER(event_data_size);
+    m_queue_start_index = next_index(m_queue_start_index);
+#endif
 }
 
 
@@ -188,5 +378,6 @@ void app_sched_execute(void)
     while ((app_sched_event_get(&p_event_data, &event_data_size, &event_handler) == NRF_SUCCESS))
     {
         event_handler(p_event_data, event_data_size);
+        app_sched_event_release(event_data_size);
     }
 }
@@ -54,7 +54,15 @@
 #include "app_error.h"
 #include "app_util.h"
 
-#define APP_SCHED_EVENT_HEADER_SIZE 8       /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). */
+/**@brief Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()).
+ *
+ * @details The header holds the handler pointer followed by the event size and state, padded to the
+ *          alignment of the pointer. This is 8 bytes on Cortex-M, and also fits the header when the
+ *          scheduler is built for a host with wider pointers.
+ */
+#define APP_SCHED_EVENT_HEADER_SIZE                                                                \
+            (CEIL_DIV(sizeof(app_sched_event_handler_t) + sizeof(uint32_t),                        \
+                      sizeof(app_sched_event_handler_t)) * sizeof(app_sched_event_handler_t))
 
 /**@brief Compute number of bytes required to hold the scheduler buffer.
  *
@@ -64,8 +72,68 @@
  *
  * @return    Required scheduler buffer size (in bytes).
  */
+#ifdef APP_SCHEDULER_WITH_PRIORITY
+
+#ifndef APP_SCHED_PRIO_LANE_COUNT
+#define APP_SCHED_PRIO_LANE_COUNT   3       /**< Number of priority lanes. Lane 0 has the highest priority. */
+#endif
+
+#define APP_SCHED_PRIO_LANE_DEFAULT (APP_SCHED_PRIO_LANE_COUNT - 1) /**< Lane used by app_sched_event_put(). */
+
+#ifdef SOFTDEVICE_PRESENT
+#define APP_SCHED_PRIO_CONTEXT_COUNT 3      /**< Producer contexts: APP_IRQ_PRIORITY_HIGH, APP_IRQ_PRIORITY_LOW and Thread Mode. */
+#else
+#define APP_SCHED_PRIO_CONTEXT_COUNT 5      /**< Producer contexts: interrupt priority 0 to 3 and Thread Mode. */
+#endif
+
+/**@brief Compute number of bytes required to hold the scheduler buffer.
+ *
+ * @details Every lane holds one queue per producer context (see @ref APP_SCHED_PRIO_CONTEXT_COUNT),
+ *          each with room for QUEUE_SIZE events.
+ *
+ * @param[in] EVENT_SIZE   Maximum size of events to be passed through the scheduler.
+ * @param[in] QUEUE_SIZE   Number of entries in each lane queue of a producer context.
+ *
+ * @return    Required scheduler buffer size (in bytes).
+ */
+#define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE)                                                 \
+            (((EVENT_SIZE) + APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 1) *                   \
+             APP_SCHED_PRIO_LANE_COUNT * APP_SCHED_PRIO_CONTEXT_COUNT)
+
+#elif defined(APP_SCHEDULER_WITH_VARIABLE_SIZE)
+
+/**@brief Compute number of bytes required to hold the scheduler buffer.
+ *
+ * @details Events are packed back to back in a ring, each taking a header and its own data size
+ *          rounded up to a word. The buffer holds at least QUEUE_SIZE events of EVENT_SIZE, and
+ *          correspondingly more small events.
+ *
+ * @param[in] EVENT_SIZE   Maximum size of events to be passed through the scheduler.
+ * @param[in] QUEUE_SIZE   Number of maximum size events that are guaranteed to fit in the queue.
+ *
+ * @return    Required scheduler buffer size (in bytes).
+ */
+#define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE)                                                 \
+            ((CEIL_DIV((EVENT_SIZE), sizeof(uint32_t)) * sizeof(uint32_t) +                        \
+              APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 2))
+
+#else
+
+/**@brief Compute number of bytes required to hold the scheduler buffer.
+ *
+ * @details Each queue entry takes a header and a data slot of EVENT_SIZE rounded up to a word, so
+ *          the event data of every entry is word aligned.
+ *
+ * @param[in] EVENT_SIZE   Maximum size of events to be passed through the scheduler.
+ * @param[in] QUEUE_SIZE   Number of entries in scheduler queue.
+ *
+ * @return    Required scheduler buffer size (in bytes).
+ */
 #define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE)                                                 \
-            (((EVENT_SIZE) + APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 1))
+            ((CEIL_DIV((EVENT_SIZE), sizeof(uint32_t)) * sizeof(uint32_t) +                        \
+              APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 1))
+
+#endif // APP_SCHEDULER_WITH_PRIORITY
             
 /**@brief Scheduler event handler type. */
 typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_size);
@@ -132,6 +200,69 @@ uint32_t app_sched_event_put(void *                    p_event_data,
                              uint16_t                  event_size,
                              app_sched_event_handler_t handler);
 
+/**@brief Function for allocating an event directly in the scheduler queue.
+ *
+ * @details Reserves room for an event in the queue and returns a pointer to its data, so the
+ *          producer can build the event in place instead of copying it in with
+ *          app_sched_event_put(). The event is executed once app_sched_event_commit() has been
+ *          called for it. Events are executed in allocation order, so an allocated event that is
+ *          not yet committed holds back the events allocated after it.
+ *
+ * @note Only available in app_scheduler.c.
+ *
+ * @param[in]   event_size       Size of event data to be scheduled.
+ * @param[in]   handler          Event handler to receive the event.
+ * @param[out]  pp_event_data    Pointer to the word aligned event data in the queue.
+ *
+ * @retval      NRF_SUCCESS               Event allocated.
+ * @retval      NRF_ERROR_INVALID_LENGTH  Event size larger than the maximum event size.
+ * @retval      NRF_ERROR_NO_MEM          Queue full.
+ */
+uint32_t app_sched_event_alloc(uint16_t                  event_size,
+                               app_sched_event_handler_t handler,
+                               void **                   pp_event_data);
+
+/**@brief Function for committing an event allocated with app_sched_event_alloc().
+ *
+ * @note Only available in app_scheduler.c.
+ *
+ * @param[in]   p_event_data   Event data pointer returned by app_sched_event_alloc().
+ */
+void app_sched_event_commit(void * p_event_data);
+
+#ifdef APP_SCHEDULER_WITH_PRIORITY
+/**@brief Function for scheduling an event in a given priority lane.
+ *
+ * @details Puts an event into the queue of the given lane that belongs to the calling interrupt
+ *          priority. Interrupts at the same priority never preempt each other, so each such queue
+ *          has exactly one producer context and one consumer, and no critical region is needed.
+ *          Events posted from the same interrupt priority to the same lane are executed in order.
+ *
+ * @param[in]   p_event_data   Pointer to event data to be scheduled.
+ * @param[in]   event_size     Size of event data to be scheduled.
+ * @param[in]   handler        Event handler to receive the event.
+ * @param[in]   lane           Priority lane, 0 being the highest priority.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+uint32_t app_sched_event_put_prio(void *                    p_event_data,
+                                  uint16_t                  event_size,
+                                  app_sched_event_handler_t handler,
+                                  uint8_t                   lane);
+
+/**@brief Function for getting the maximum observed queue depth of a lane.
+ *
+ * @details The value is the highest number of events that were pending at the same time in any
+ *          single producer context queue of the lane, and can be compared directly with the
+ *          QUEUE_SIZE given to APP_SCHED_INIT().
+ *
+ * @param[in]   lane           Priority lane.
+ *
+ * @return      High-water mark of the lane queue depth.
+ */
+uint16_t app_sched_lane_high_water_get(uint8_t lane);
+#endif
+
 #ifdef APP_SCHEDULER_WITH_PAUSE
 /**@brief A function to pause the scheduler.
  *
@@ -0,0 +1,274 @@
+/* Copyright (c) 2012 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Priority lane variant of the scheduler. Build this file instead of app_scheduler.c and define
+ * APP_SCHEDULER_WITH_PRIORITY for all files including app_scheduler.h.
+ *
+ * Each lane is split in one single-producer/single-consumer queue per interrupt priority level.
+ * On Cortex-M an interrupt can only be preempted by a higher priority one, so a queue never has
+ * two producers running at the same time. The producer owns the end index and the consumer owns
+ * the start index, and both are updated with a single store, so neither side needs LDREX/STREX
+ * or a critical region.
+ */
+
+#include "app_scheduler.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "nrf_soc.h"
+#include "nrf_assert.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+
+#ifndef APP_SCHEDULER_WITH_PRIORITY
+#error "app_scheduler_prio.c requires APP_SCHEDULER_WITH_PRIORITY to be defined."
+#endif
+
+#define QUEUE_COUNT (APP_SCHED_PRIO_LANE_COUNT * APP_SCHED_PRIO_CONTEXT_COUNT) /**< Number of single-producer queues. */
+
+/**@brief Structure for holding a scheduled event header. */
+typedef struct
+{
+    app_sched_event_handler_t handler;          /**< Pointer to event handler to receive the event. */
+    uint16_t                  event_data_size;  /**< Size of event data. */
+} event_header_t;
+
+STATIC_ASSERT(sizeof(event_header_t) <= APP_SCHED_EVENT_HEADER_SIZE);
+
+/**@brief Structure for holding the state of one single-producer queue. */
+typedef struct
+{
+    volatile uint8_t start_index;               /**< Index of queue entry at the start of the queue. Written by the consumer only. */
+    volatile uint8_t end_index;                 /**< Index of queue entry at the end of the queue. Written by the producer only. */
+    uint8_t          high_water;                /**< Maximum number of pending entries. Written by the producer only. */
+} sched_queue_t;
+
+static event_header_t * m_queue_event_headers;  /**< Array for holding the queue event headers. */
+static uint8_t        * m_queue_event_data;     /**< Array for holding the queue event data. */
+static uint16_t         m_queue_event_size;     /**< Maximum event size in queue. */
+static uint16_t         m_queue_size;           /**< Number of queue entries. */
+static sched_queue_t    m_queues[QUEUE_COUNT];  /**< Queue state, grouped by lane. */
+
+/**@brief Function for incrementing a queue index, and handle wrap-around.
+ *
+ * @param[in]   index   Old index.
+ *
+ * @return      New (incremented) index.
+ */
+static __INLINE uint8_t next_index(uint8_t index)
+{
+    return (index < m_queue_size) ? (index + 1) : 0;
+}
+
+
+/**@brief Function for getting the number of pending entries in a queue.
+ *
+ * @param[in]   start   Start index.
+ * @param[in]   end     End index.
+ *
+ * @return      Number of pending entries.
+ */
+static __INLINE uint8_t queue_depth(uint8_t start, uint8_t end)
+{
+    return (end >= start) ? (end - start) : (m_queue_size + 1 - start + end);
+}
+
+
+/**@brief Function for mapping the current interrupt priority to a producer context index.
+ *
+ * @return      Producer context index.
+ */
+static __INLINE uint8_t context_index_get(void)
+{
+    uint8_t priority = current_int_priority_get();
+
+#ifdef SOFTDEVICE_PRESENT
+    switch (priority)
+    {
+        case APP_IRQ_PRIORITY_HIGH:
+            return 0;
+
+        case APP_IRQ_PRIORITY_LOW:
+            return 1;
+
+        default:
+            return 2;
+    }
+#else
+    return (priority < NRF_APP_PRIORITY_THREAD) ? priority : NRF_APP_PRIORITY_THREAD;
+#endif
+}
+
+
+uint32_t app_sched_init(uint16_t event_size, uint16_t queue_size, void * p_event_buffer)
+{
+    uint32_t data_start_index = (queue_size + 1) * QUEUE_COUNT * sizeof(event_header_t);
+
+    // Check that buffer is correctly aligned
+    if (!is_word_aligned(p_event_buffer))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // The indexes are 8 bit wide.
+    if (queue_size >= UINT8_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Initialize event scheduler
+    m_queue_event_headers = p_event_buffer;
+    m_queue_event_data    = &((uint8_t *)p_event_buffer)[data_start_index];
+    m_queue_event_size    = event_size;
+    m_queue_size          = queue_size;
+    memset(m_queues, 0, sizeof(m_queues));
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_sched_event_put_prio(void                    * p_event_data,
+                                  uint16_t                  event_data_size,
+                                  app_sched_event_handler_t handler,
+                                  uint8_t                   lane)
+{
+    uint32_t        queue_id;
+    uint32_t        event_index;
+    sched_queue_t * p_queue;
+    uint8_t         start;
+    uint8_t         end;
+    uint8_t         depth;
+
+    if (lane >= APP_SCHED_PRIO_LANE_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (event_data_size > m_queue_event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    queue_id = lane * APP_SCHED_PRIO_CONTEXT_COUNT + context_index_get();
+    p_queue  = &m_queues[queue_id];
+    start    = p_queue->start_index;
+    end      = p_queue->end_index;
+
+    if (next_index(end) == start)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    // NOTE: Only the current interrupt priority writes to this entry and to the end index. The
+    //       entry is filled in completely before the end index publishes it to the consumer.
+    event_index = queue_id * (m_queue_size + 1) + end;
+
+    m_queue_event_headers[event_index].handler = handler;
+    if ((p_event_data != NULL) && (event_data_size > 0))
+    {
+        memcpy(&m_queue_event_data[event_index * m_queue_event_size],
+               p_event_data,
+               event_data_size);
+        m_queue_event_headers[event_index].event_data_size = event_data_size;
+    }
+    else
+    {
+        m_queue_event_headers[event_index].event_data_size = 0;
+    }
+
+    __DMB();
+    p_queue->end_index = next_index(end);
+
+    depth = queue_depth(start, next_index(end));
+    if (depth > p_queue->high_water)
+    {
+        p_queue->high_water = depth;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_sched_event_put(void                    * p_event_data,
+                             uint16_t                  event_data_size,
+                             app_sched_event_handler_t handler)
+{
+    return app_sched_event_put_prio(p_event_data,
+                                    event_data_size,
+                                    handler,
+                                    APP_SCHED_PRIO_LANE_DEFAULT);
+}
+
+
+uint16_t app_sched_lane_high_water_get(uint8_t lane)
+{
+    uint16_t high_water = 0;
+    uint32_t i;
+
+    if (lane >= APP_SCHED_PRIO_LANE_COUNT)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < APP_SCHED_PRIO_CONTEXT_COUNT; i++)
+    {
+        high_water = MAX(high_water, m_queues[lane * APP_SCHED_PRIO_CONTEXT_COUNT + i].high_water);
+    }
+
+    return high_water;
+}
+
+
+/**@brief Function for executing the next event from the highest priority non-empty lane.
+ *
+ * @details Within a lane, the queues of higher interrupt priorities are served first. The entry is
+ *          released after the handler returns, so the handler may use the event data in place.
+ *
+ * @return      NRF_SUCCESS if an event was executed, NRF_ERROR_NOT_FOUND if all queues are empty.
+ */
+static uint32_t app_sched_event_execute_next(void)
+{
+    uint32_t queue_id;
+
+    for (queue_id = 0; queue_id < QUEUE_COUNT; queue_id++)
+    {
+        sched_queue_t * p_queue = &m_queues[queue_id];
+        uint8_t         start   = p_queue->start_index;
+
+        if (start != p_queue->end_index)
+        {
+            uint32_t event_index = queue_id * (m_queue_size + 1) + start;
+
+            __DMB();
+            m_queue_event_headers[event_index].handler(
+                &m_queue_event_data[event_index * m_queue_event_size],
+                m_queue_event_headers[event_index].event_data_size);
+
+            p_queue->start_index = next_index(start);
+            return NRF_SUCCESS;
+        }
+    }
+
+    return NRF_ERROR_NOT_FOUND;
+}
+
+
+void app_sched_execute(void)
+{
+    // Every iteration restarts from the highest priority lane, so a high priority event waits for
+    // at most one lower priority handler to complete.
+    while (app_sched_event_execute_next() == NRF_SUCCESS)
+    {
+        // No implementation needed.
+    }
+}
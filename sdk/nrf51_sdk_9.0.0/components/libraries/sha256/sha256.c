@@ -29,6 +29,17 @@
 #define SIG0(x) (ROTRIGHT(x,7) ^ ROTRIGHT(x,18) ^ ((x) >> 3))
 #define SIG1(x) (ROTRIGHT(x,17) ^ ROTRIGHT(x,19) ^ ((x) >> 10))
 
+// Message schedule word i, computed in place in a 16 word circular buffer.
+#define SCHEDULE(m,i) ((m)[(i) & 15] += SIG1((m)[((i) - 2) & 15]) + (m)[((i) - 7) & 15] + SIG0((m)[((i) - 15) & 15]))
+
+// One round with the working variables passed in rotated order, so no moves are needed.
+#define ROUND(a,b,c,d,e,f,g,h,w,i) \
+    do { \
+        uint32_t t = (h) + EP1(e) + CH(e,f,g) + k[i] + (w); \
+        (d) += t; \
+        (h)  = t + EP0(a) + MAJ(a,b,c); \
+    } while (0)
+
 
 static const uint32_t k[64] = {
     0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
@@ -43,18 +54,21 @@ static const uint32_t k[64] = {
 
 
 /**@brief Function for calculating the hash of a 64-byte section of data.
+ *
+ * @details The message schedule is kept in a 16 word circular buffer instead of a 64 word array.
+ *          The data is read byte by byte, so it does not need to be word aligned. Define
+ *          SHA256_UNROLLED to unroll the round loop eight times, which is faster but uses more
+ *          flash.
  *
  * @param[in,out] ctx   Hash instance.
  * @param[in]     data  Aray with data to be hashed. Assumed to be 64 bytes long.
  */
 void sha256_transform(sha256_context_t *ctx, const uint8_t * data)
 {
-    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
+    uint32_t a, b, c, d, e, f, g, h, i, j, m[16];
 
     for (i = 0, j = 0; i < 16; ++i, j += 4)
-        m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-    for ( ; i < 64; ++i)
-        m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+        m[i] = ((uint32_t)data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
 
     a = ctx->state[0];
     b = ctx->state[1];
@@ -65,8 +79,32 @@ void sha256_transform(sha256_context_t *ctx, const uint8_t * data)
     g = ctx->state[6];
     h = ctx->state[7];
 
+#ifdef SHA256_UNROLLED
+    for (i = 0; i < 16; i += 8) {
+        ROUND(a, b, c, d, e, f, g, h, m[i],     i);
+        ROUND(h, a, b, c, d, e, f, g, m[i + 1], i + 1);
+        ROUND(g, h, a, b, c, d, e, f, m[i + 2], i + 2);
+        ROUND(f, g, h, a, b, c, d, e, m[i + 3], i + 3);
+        ROUND(e, f, g, h, a, b, c, d, m[i + 4], i + 4);
+        ROUND(d, e, f, g, h, a, b, c, m[i + 5], i + 5);
+        ROUND(c, d, e, f, g, h, a, b, m[i + 6], i + 6);
+        ROUND(b, c, d, e, f, g, h, a, m[i + 7], i + 7);
+    }
+    for ( ; i < 64; i += 8) {
+        ROUND(a, b, c, d, e, f, g, h, SCHEDULE(m, i),     i);
+        ROUND(h, a, b, c, d, e, f, g, SCHEDULE(m, i + 1), i + 1);
+        ROUND(g, h, a, b, c, d, e, f, SCHEDULE(m, i + 2), i + 2);
+        ROUND(f, g, h, a, b, c, d, e, SCHEDULE(m, i + 3), i + 3);
+        ROUND(e, f, g, h, a, b, c, d, SCHEDULE(m, i + 4), i + 4);
+        ROUND(d, e, f, g, h, a, b, c, SCHEDULE(m, i + 5), i + 5);
+        ROUND(c, d, e, f, g, h, a, b, SCHEDULE(m, i + 6), i + 6);
+        ROUND(b, c, d, e, f, g, h, a, SCHEDULE(m, i + 7), i + 7);
+    }
+#else
     for (i = 0; i < 64; ++i) {
-        t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
+        uint32_t t1, t2;
+
+        t1 = h + EP1(e) + CH(e,f,g) + k[i] + ((i < 16) ? m[i] : SCHEDULE(m, i));
         t2 = EP0(a) + MAJ(a,b,c);
         h = g;
         g = f;
@@ -77,6 +115,7 @@ void sha256_transform(sha256_context_t *ctx, const uint8_t * data)
         b = a;
         a = t1 + t2;
     }
+#endif // SHA256_UNROLLED
 
     ctx->state[0] += a;
     ctx->state[1] += b;
@@ -118,18 +157,37 @@ ret_code_t sha256_update(sha256_context_t *ctx, const uint8_t * data, size_t len
         return NRF_ERROR_NULL;
     }
 
-    uint32_t i;
+    size_t remaining = len;
+
+    // Complete a block buffered by an earlier call.
+    if (ctx->datalen > 0) {
+        size_t fill = 64 - ctx->datalen;
+
+        if (fill > remaining)
+            fill = remaining;
+        memcpy(&ctx->data[ctx->datalen], data, fill);
+        ctx->datalen += fill;
+        data         += fill;
+        remaining    -= fill;
+        if (ctx->datalen < 64)
+            return NRF_SUCCESS;
+        sha256_transform(ctx, ctx->data);
+        ctx->bitlen += 512;
+        ctx->datalen = 0;
+    }
 
-    for (i = 0; i < len; ++i) {
-        ctx->data[ctx->datalen] = data[i];
-        ctx->datalen++;
-        if (ctx->datalen == 64) {
-            sha256_transform(ctx, ctx->data);
-            ctx->bitlen += 512;
-            ctx->datalen = 0;
-        }
+    // Transform whole blocks straight from the caller's buffer.
+    while (remaining >= 64) {
+        sha256_transform(ctx, data);
+        ctx->bitlen += 512;
+        data        += 64;
+        remaining   -= 64;
     }
 
+    // Keep the tail for the next call or sha256_final.
+    memcpy(ctx->data, data, remaining);
+    ctx->datalen = remaining;
+
     return NRF_SUCCESS;
 }
 
@@ -0,0 +1,269 @@
+/* Copyright (c) 2015 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "slip.h"
+#include <string.h>
+#include "nrf_error.h"
+
+/**@brief Escape code for each byte value, 0 for bytes that are sent as they are. */
+static const uint8_t m_escape_code[256] =
+{
+    [SLIP_END] = SLIP_ESC_END,
+    [SLIP_ESC] = SLIP_ESC_ESC,
+};
+
+
+/**@brief Function for finding the length of the run of bytes that need no escaping.
+ *
+ * @param[in] p_data  Data to scan.
+ * @param[in] len     Maximum number of bytes to scan.
+ *
+ * @return Number of bytes before the first SLIP_END or SLIP_ESC, or len if there is none.
+ */
+static uint32_t plain_run_length(uint8_t const * p_data, uint32_t len)
+{
+    uint32_t i = 0;
+
+    while ((i < len) && (m_escape_code[p_data[i]] == 0))
+    {
+        i++;
+    }
+
+    return i;
+}
+
+
+void slip_encoder_init(slip_encoder_t * p_encoder)
+{
+    p_encoder->pending = 0;
+}
+
+
+uint32_t slip_encode(slip_encoder_t * p_encoder,
+                     uint8_t const  * p_input,
+                     uint32_t       * p_input_len,
+                     uint8_t        * p_output,
+                     uint32_t       * p_output_len)
+{
+    uint32_t in_len  = *p_input_len;
+    uint32_t out_len = *p_output_len;
+    uint32_t in_pos  = 0;
+    uint32_t out_pos = 0;
+
+    if ((p_encoder->pending != 0) && (out_len > 0))
+    {
+        p_output[out_pos++] = p_encoder->pending;
+        p_encoder->pending  = 0;
+    }
+
+    while ((p_encoder->pending == 0) && (in_pos < in_len) && (out_pos < out_len))
+    {
+        uint32_t run_max = in_len - in_pos;
+        uint32_t run;
+
+        if (run_max > out_len - out_pos)
+        {
+            run_max = out_len - out_pos;
+        }
+
+        run = plain_run_length(&p_input[in_pos], run_max);
+        memcpy(&p_output[out_pos], &p_input[in_pos], run);
+        in_pos  += run;
+        out_pos += run;
+
+        if (run == run_max)
+        {
+            continue;
+        }
+
+        // p_input[in_pos] must be escaped. The escape code goes out on the next call if the
+        // output block ends after the escape byte.
+        p_output[out_pos++] = SLIP_ESC;
+        p_encoder->pending  = m_escape_code[p_input[in_pos++]];
+
+        if (out_pos < out_len)
+        {
+            p_output[out_pos++] = p_encoder->pending;
+            p_encoder->pending  = 0;
+        }
+    }
+
+    *p_input_len  = in_pos;
+    *p_output_len = out_pos;
+
+    if ((in_pos < in_len) || (p_encoder->pending != 0))
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+void slip_decoder_init(slip_decoder_t * p_decoder)
+{
+    p_decoder->p_buffer = NULL;
+    p_decoder->size     = 0;
+    p_decoder->len      = 0;
+    p_decoder->state    = SLIP_STATE_SYNC_WAIT;
+}
+
+
+void slip_decoder_buffer_set(slip_decoder_t * p_decoder, uint8_t * p_buffer, uint32_t size)
+{
+    p_decoder->p_buffer = p_buffer;
+    p_decoder->size     = (p_buffer != NULL) ? size : 0;
+    p_decoder->len      = 0;
+}
+
+
+uint32_t slip_decoder_buffer_move(slip_decoder_t * p_decoder, uint8_t * p_buffer, uint32_t size)
+{
+    if (p_decoder->len > size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    if ((p_decoder->len > 0) && (p_buffer != p_decoder->p_buffer))
+    {
+        memcpy(p_buffer, p_decoder->p_buffer, p_decoder->len);
+    }
+
+    p_decoder->p_buffer = p_buffer;
+    p_decoder->size     = size;
+
+    return NRF_SUCCESS;
+}
+
+
+void slip_decoder_skip(slip_decoder_t * p_decoder)
+{
+    p_decoder->len   = 0;
+    p_decoder->state = SLIP_STATE_SYNC_WAIT;
+}
+
+
+uint32_t slip_decode(slip_decoder_t * p_decoder, uint8_t const * p_input, uint32_t * p_len)
+{
+    uint32_t len = *p_len;
+    uint32_t pos = 0;
+
+    if (p_decoder->state == SLIP_STATE_FRAME_END)
+    {
+        p_decoder->len   = 0;
+        p_decoder->state = SLIP_STATE_DATA;
+    }
+
+    while (pos < len)
+    {
+        uint8_t const * p_end;
+        uint32_t        run;
+        uint32_t        room;
+        uint8_t         byte;
+
+        switch (p_decoder->state)
+        {
+            case SLIP_STATE_SYNC_WAIT:
+                p_end = memchr(&p_input[pos], SLIP_END, len - pos);
+
+                if (p_end == NULL)
+                {
+                    pos = len;
+                }
+                else
+                {
+                    pos              = (uint32_t)(p_end - p_input) + 1;
+                    p_decoder->len   = 0;
+                    p_decoder->state = SLIP_STATE_DATA;
+                }
+                break;
+
+            case SLIP_STATE_ESCAPE:
+                byte = p_input[pos];
+
+                if (byte == SLIP_END)
+                {
+                    // Broken escape sequence, the SLIP_END still ends the frame.
+                    p_decoder->state = SLIP_STATE_DATA;
+                    break;
+                }
+
+                if (p_decoder->len == p_decoder->size)
+                {
+                    *p_len = pos;
+                    return NRF_ERROR_NO_MEM;
+                }
+
+                pos++;
+
+                if (byte == SLIP_ESC_END)
+                {
+                    byte = SLIP_END;
+                }
+                else if (byte == SLIP_ESC_ESC)
+                {
+                    byte = SLIP_ESC;
+                }
+
+                p_decoder->p_buffer[p_decoder->len++] = byte;
+                p_decoder->state                      = SLIP_STATE_DATA;
+                break;
+
+            default:
+                run  = plain_run_length(&p_input[pos], len - pos);
+                room = p_decoder->size - p_decoder->len;
+
+                if (run > room)
+                {
+                    run = room;
+                }
+
+                if (run > 0)
+                {
+                    memcpy(&p_decoder->p_buffer[p_decoder->len], &p_input[pos], run);
+                    p_decoder->len += run;
+                    pos            += run;
+                }
+
+                if (pos == len)
+                {
+                    break;
+                }
+
+                if (m_escape_code[p_input[pos]] == 0)
+                {
+                    // Data byte that does not fit in the buffer.
+                    *p_len = pos;
+                    return NRF_ERROR_NO_MEM;
+                }
+
+                if (p_input[pos++] == SLIP_ESC)
+                {
+                    p_decoder->state = SLIP_STATE_ESCAPE;
+                }
+                else if (p_decoder->len > 0)
+                {
+                    p_decoder->state = SLIP_STATE_FRAME_END;
+                    *p_len           = pos;
+                    return NRF_SUCCESS;
+                }
+                else
+                {
+                    // Empty frame, the SLIP_END also starts the next one.
+                }
+                break;
+        }
+    }
+
+    *p_len = pos;
+    return NRF_ERROR_BUSY;
+}
@@ -0,0 +1,158 @@
+/* Copyright (c) 2015 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @defgroup slip SLIP encoder and decoder
+ * @{
+ * @ingroup app_common
+ *
+ * @brief    Block based SLIP (RFC 1055) encoding and decoding.
+ *
+ * @details  The encoder and decoder work on blocks of bytes instead of single bytes. Runs of bytes
+ *           that need no escaping are found with a lookup table and copied with memcpy, so the
+ *           cost per byte is low when the data is mostly plain. Both sides keep their state
+ *           between calls, so a frame can be split over any number of input and output blocks,
+ *           for example the contiguous spans of a FIFO.
+ */
+
+#ifndef SLIP_H__
+#define SLIP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SLIP_END             0xC0    /**< Marks the start and the end of a frame. */
+#define SLIP_ESC             0xDB    /**< Escape byte. The next byte is an escaped data byte. */
+#define SLIP_ESC_END         0xDC    /**< Follows SLIP_ESC to encode a data byte 0xC0. */
+#define SLIP_ESC_ESC         0xDD    /**< Follows SLIP_ESC to encode a data byte 0xDB. */
+
+/**@brief Worst case number of bytes on the line for a frame of LEN data bytes, delimiters included. */
+#define SLIP_ENCODED_SIZE_MAX(LEN)  ((2 * (LEN)) + 2)
+
+/**@brief SLIP decoder states. */
+typedef enum
+{
+    SLIP_STATE_SYNC_WAIT,            /**< Skipping bytes until the next SLIP_END. */
+    SLIP_STATE_DATA,                 /**< Decoding frame data. */
+    SLIP_STATE_ESCAPE,               /**< SLIP_ESC received, the next byte is the escape code. */
+    SLIP_STATE_FRAME_END             /**< A frame was returned, the next call starts a new one. */
+} slip_state_t;
+
+/**@brief SLIP encoder instance. Initialize with @ref slip_encoder_init before use. */
+typedef struct
+{
+    uint8_t          pending;        /**< Escape code that did not fit in the last output block, 0 if none. */
+} slip_encoder_t;
+
+/**@brief SLIP decoder instance. Initialize with @ref slip_decoder_init before use. */
+typedef struct
+{
+    uint8_t *        p_buffer;       /**< Buffer the frame is decoded to, NULL if none is set. */
+    uint32_t         size;           /**< Size of the buffer. */
+    uint32_t         len;            /**< Number of decoded bytes in the buffer. */
+    slip_state_t     state;          /**< Decoder state. */
+} slip_decoder_t;
+
+/**@brief Function for initializing a SLIP encoder.
+ *
+ * @param[out] p_encoder  Encoder instance.
+ */
+void slip_encoder_init(slip_encoder_t * p_encoder);
+
+/**@brief Function for encoding a block of frame data.
+ *
+ * @details The frame delimiters are not added, the caller writes @ref SLIP_END before and after
+ *          the frame data. If the output block ends in the middle of an escape sequence, the
+ *          rest of the sequence is written first on the next call.
+ *
+ * @param[in]     p_encoder    Encoder instance.
+ * @param[in]     p_input      Data to encode.
+ * @param[in,out] p_input_len  In: number of bytes in p_input. Out: number of bytes consumed.
+ * @param[out]    p_output     Output block.
+ * @param[in,out] p_output_len In: size of p_output. Out: number of bytes written.
+ *
+ * @retval NRF_SUCCESS       If all input was consumed and no escape code is pending.
+ * @retval NRF_ERROR_NO_MEM  If the output block is full. Call again with a new output block.
+ */
+uint32_t slip_encode(slip_encoder_t * p_encoder,
+                     uint8_t const  * p_input,
+                     uint32_t       * p_input_len,
+                     uint8_t        * p_output,
+                     uint32_t       * p_output_len);
+
+/**@brief Function for initializing a SLIP decoder.
+ *
+ * @details The decoder starts without a buffer and skips bytes until the first @ref SLIP_END.
+ *
+ * @param[out] p_decoder  Decoder instance.
+ */
+void slip_decoder_init(slip_decoder_t * p_decoder);
+
+/**@brief Function for setting the buffer the next frame is decoded to.
+ *
+ * @details The number of decoded bytes is reset to zero. Setting a NULL buffer makes
+ *          @ref slip_decode return NRF_ERROR_NO_MEM on the first data byte of the next frame.
+ *
+ * @param[in] p_decoder  Decoder instance.
+ * @param[in] p_buffer   Buffer, or NULL.
+ * @param[in] size       Size of the buffer.
+ */
+void slip_decoder_buffer_set(slip_decoder_t * p_decoder, uint8_t * p_buffer, uint32_t size);
+
+/**@brief Function for moving the frame being decoded to a larger buffer.
+ *
+ * @details The bytes decoded so far are copied to the new buffer and decoding continues there.
+ *          Typically called after @ref slip_decode returned NRF_ERROR_NO_MEM.
+ *
+ * @param[in] p_decoder  Decoder instance.
+ * @param[in] p_buffer   New buffer.
+ * @param[in] size       Size of the new buffer.
+ *
+ * @retval NRF_SUCCESS               If the frame was moved.
+ * @retval NRF_ERROR_INVALID_LENGTH  If the decoded bytes do not fit in the new buffer.
+ */
+uint32_t slip_decoder_buffer_move(slip_decoder_t * p_decoder, uint8_t * p_buffer, uint32_t size);
+
+/**@brief Function for dropping the frame being decoded.
+ *
+ * @details The decoder skips bytes until the next @ref SLIP_END and keeps its buffer.
+ *
+ * @param[in] p_decoder  Decoder instance.
+ */
+void slip_decoder_skip(slip_decoder_t * p_decoder);
+
+/**@brief Function for decoding a block of received bytes.
+ *
+ * @details Decoding stops after the first complete frame, so a block holding several frames
+ *          needs several calls. Empty frames, that is two SLIP_END bytes in a row, are skipped.
+ *          An escape byte followed by SLIP_END is dropped and the frame ends. An escape byte
+ *          followed by any other byte than SLIP_ESC_END or SLIP_ESC_ESC is stored as that byte.
+ *
+ * @param[in]     p_decoder  Decoder instance.
+ * @param[in]     p_input    Received bytes.
+ * @param[in,out] p_len      In: number of bytes in p_input. Out: number of bytes consumed.
+ *
+ * @retval NRF_SUCCESS       If a frame was completed. It is in p_decoder->p_buffer and is
+ *                           p_decoder->len bytes long. Set a new buffer before the next call if
+ *                           the frame must be kept.
+ * @retval NRF_ERROR_BUSY    If all input was consumed and the frame is not complete yet.
+ * @retval NRF_ERROR_NO_MEM  If the next data byte does not fit in the buffer. The byte is not
+ *                           consumed. Move the frame to a larger buffer with
+ *                           @ref slip_decoder_buffer_move, or drop it with @ref slip_decoder_skip,
+ *                           and call again with the remaining input.
+ */
+uint32_t slip_decode(slip_decoder_t * p_decoder, uint8_t const * p_input, uint32_t * p_len);
+
+#endif // SLIP_H__
+
+/** @} */
@@ -12,6 +12,7 @@
 
 #include "app_timer.h"
 #include <stdlib.h>
+#include <string.h>
 #include "nrf51.h"
 #include "nrf51_bitfields.h"
 #include "nrf_soc.h"
@@ -19,6 +20,7 @@
 #include "nrf_delay.h"
 #include "app_util.h"
 #include "app_util_platform.h"
+#include "nordic_common.h"
 
 #define RTC1_IRQ_PRI            APP_IRQ_PRIORITY_LOW                        /**< Priority of the RTC1 interrupt (used for checking for timeouts and executing timeout handlers). */
 #define SWI0_IRQ_PRI            APP_IRQ_PRIORITY_LOW                        /**< Priority of the SWI0 interrupt (used for updating the timer list). */
@@ -50,11 +52,16 @@ typedef struct
 {
     timer_alloc_state_t         state;                                      /**< Timer allocation state. */
     app_timer_mode_t            mode;                                       /**< Timer mode. */
-    uint32_t                    ticks_to_expire;                            /**< Number of ticks from previous timer interrupt to timer expiry. */
+    uint32_t                    ticks_to_expire;                            /**< Number of ticks from previous timer interrupt to timer expiry. With APP_TIMER_WITH_HEAP: expiry time relative to m_heap_ticks_origin. */
     uint32_t                    ticks_at_start;                             /**< Current RTC counter value when the timer was started. */
     uint32_t                    ticks_first_interval;                       /**< Number of ticks in the first timer interval. */
     uint32_t                    ticks_periodic_interval;                    /**< Timer period (for repeating timers). */
+    uint32_t                    ticks_slack;                                /**< Number of ticks the expiry may be delayed to share a wakeup with other timers. */
     bool                        is_running;                                 /**< True if timer is running, False otherwise. */
+#ifdef APP_TIMER_WITH_HEAP
+    uint8_t                     heap_index;                                 /**< Position of this timer in the heap, or HEAP_INDEX_NONE. */
+    uint8_t                     heap_entry;                                 /**< Id of the timer stored at heap position equal to this node's index. */
+#endif
     app_timer_timeout_handler_t p_timeout_handler;                          /**< Pointer to function to be executed when the timer expires. */
     void *                      p_context;                                  /**< General purpose pointer. Will be passed to the timeout handler when the timer expires. */
     app_timer_id_t              next;                                       /**< Id of next timer in list of running timers. */
@@ -78,6 +85,7 @@ typedef struct
     uint32_t ticks_at_start;                                                /**< Current RTC counter value when the timer was started. */
     uint32_t ticks_first_interval;                                          /**< Number of ticks in the first timer interval. */
     uint32_t ticks_periodic_interval;                                       /**< Timer period (for repeating timers). */
+    uint32_t ticks_slack;                                                   /**< Number of ticks the expiry may be delayed. */
     void *   p_context;                                                     /**< General purpose pointer. Will be passed to the timeout handler when the timer expires. */
 } timer_user_op_start_t;
 
@@ -138,6 +146,17 @@ static uint8_t                       m_ticks_elapsed_q_write_ind;
 static app_timer_evt_schedule_func_t m_evt_schedule_func;                       /**< Pointer to function for propagating timeout events to the scheduler. */
 static bool                          m_rtc1_running;                            /**< Boolean indicating if RTC1 is running. */
 static bool                          m_rtc1_reset;                              /**< Boolean indicating if RTC1 counter has been reset due to last timer removed from timer list during the timer list handling. */
+static uint32_t                      m_ticks_wakeup;                            /**< RTC counter value of the wakeup programmed in the Capture Compare register. */
+static app_timer_stats_t             m_stats;                                   /**< Wakeup and expiry statistics. */
+
+#ifdef APP_TIMER_WITH_HEAP
+#define HEAP_INDEX_NONE             0xFF                                        /**< Heap index of a timer that is not in the heap. */
+
+static uint8_t                       m_heap_size;                               /**< Number of timers in the heap. */
+static uint32_t                      m_heap_ticks_origin;                       /**< Free running tick count corresponding to m_ticks_latest. Heap keys are relative to the same origin. */
+static app_timer_id_t                m_expired_head;                            /**< First timer in list of expired timers not yet handled by the list handler. */
+static app_timer_id_t                m_expired_tail;                            /**< Last timer in list of expired timers. */
+#endif
  
 
 /**@brief Function for initializing the RTC1 counter.
@@ -219,6 +238,243 @@ static __INLINE void rtc1_compare0_set(uint32_t value)
 }
 
 
+#ifdef APP_TIMER_WITH_HEAP
+/**@brief Function for checking if a timer expires before another.
+ *
+ * @details The keys are free running tick counts, compared as signed differences so the
+ *          comparison stays valid across wrap-around.
+ */
+static __INLINE bool heap_key_less(app_timer_id_t id_a, app_timer_id_t id_b)
+{
+    return (int32_t)(mp_nodes[id_a].ticks_to_expire - mp_nodes[id_b].ticks_to_expire) < 0;
+}
+
+
+/**@brief Function for placing a timer at a heap position.
+ */
+static __INLINE void heap_set(uint8_t pos, app_timer_id_t timer_id)
+{
+    mp_nodes[pos].heap_entry      = timer_id;
+    mp_nodes[timer_id].heap_index = pos;
+}
+
+
+/**@brief Function for moving the timer at a heap position towards the root.
+ */
+static void heap_sift_up(uint8_t pos)
+{
+    app_timer_id_t timer_id = mp_nodes[pos].heap_entry;
+
+    while (pos > 0)
+    {
+        uint8_t parent = (pos - 1) / 2;
+
+        if (!heap_key_less(timer_id, mp_nodes[parent].heap_entry))
+        {
+            break;
+        }
+        heap_set(pos, mp_nodes[parent].heap_entry);
+        pos = parent;
+    }
+    heap_set(pos, timer_id);
+}
+
+
+/**@brief Function for moving the timer at a heap position towards the leaves.
+ */
+static void heap_sift_down(uint8_t pos)
+{
+    app_timer_id_t timer_id = mp_nodes[pos].heap_entry;
+
+    for (;;)
+    {
+        uint32_t child = 2 * pos + 1;
+
+        if (child >= m_heap_size)
+        {
+            break;
+        }
+        if ((child + 1 < m_heap_size) &&
+            heap_key_less(mp_nodes[child + 1].heap_entry, mp_nodes[child].heap_entry))
+        {
+            child++;
+        }
+        if (!heap_key_less(mp_nodes[child].heap_entry, timer_id))
+        {
+            break;
+        }
+        heap_set(pos, mp_nodes[child].heap_entry);
+        pos = child;
+    }
+    heap_set(pos, timer_id);
+}
+
+
+/**@brief Function for updating the cached id of the first timer to expire.
+ */
+static __INLINE void heap_head_update(void)
+{
+    m_timer_id_head = (m_heap_size > 0) ? mp_nodes[0].heap_entry : TIMER_NULL;
+}
+
+
+/**@brief Function for removing the timer at a heap position.
+ */
+static void heap_remove_at(uint8_t pos)
+{
+    app_timer_id_t timer_id = mp_nodes[pos].heap_entry;
+
+    mp_nodes[timer_id].heap_index = HEAP_INDEX_NONE;
+    m_heap_size--;
+
+    if (pos != m_heap_size)
+    {
+        // Fill the hole with the last entry, and restore the heap order in either direction.
+        app_timer_id_t moved_id = mp_nodes[m_heap_size].heap_entry;
+
+        heap_set(pos, moved_id);
+        heap_sift_up(pos);
+        heap_sift_down(mp_nodes[moved_id].heap_index);
+    }
+
+    heap_head_update();
+}
+
+
+/**@brief Function for getting the number of ticks from m_ticks_latest to the expiry of a timer.
+ */
+static __INLINE uint32_t timer_ticks_to_expire_get(app_timer_id_t timer_id)
+{
+    return mp_nodes[timer_id].ticks_to_expire - m_heap_ticks_origin;
+}
+
+
+/**@brief Function for getting the number of ticks from m_ticks_latest to the next wakeup.
+ *
+ * @details The wakeup is delayed as long as no running timer would be delayed by more than its
+ *          slack, so that timers expiring within each other's slack share one wakeup. Only the
+ *          part of the heap expiring before the wakeup is visited.
+ */
+static uint32_t timer_wakeup_ticks_get(void)
+{
+    uint8_t  stack[2 * 8];
+    uint32_t stack_size = 0;
+    uint32_t wakeup     = timer_ticks_to_expire_get(m_timer_id_head) + mp_nodes[m_timer_id_head].ticks_slack;
+
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        uint32_t       pos      = stack[--stack_size];
+        app_timer_id_t timer_id = mp_nodes[pos].heap_entry;
+        uint32_t       expiry   = timer_ticks_to_expire_get(timer_id);
+
+        if (expiry > wakeup)
+        {
+            // Children expire even later.
+            continue;
+        }
+
+        wakeup = MIN(wakeup, expiry + mp_nodes[timer_id].ticks_slack);
+
+        if (2 * pos + 1 < m_heap_size)
+        {
+            stack[stack_size++] = 2 * pos + 1;
+        }
+        if (2 * pos + 2 < m_heap_size)
+        {
+            stack[stack_size++] = 2 * pos + 2;
+        }
+    }
+
+    // The wakeup must stay within the range of the RTC counter.
+    return MIN(wakeup, MAX_RTC_COUNTER_VAL);
+}
+
+
+/**@brief Function for inserting a timer in the timer heap.
+ *
+ * @details On entry, ticks_to_expire holds the number of ticks from m_ticks_latest. It is turned
+ *          into a key relative to the free running tick origin.
+ *
+ * @param[in]  timer_id   Id of timer to insert.
+ */
+static void timer_list_insert(app_timer_id_t timer_id)
+{
+    mp_nodes[timer_id].ticks_to_expire += m_heap_ticks_origin;
+
+    heap_set(m_heap_size, timer_id);
+    m_heap_size++;
+    heap_sift_up(m_heap_size - 1);
+
+    heap_head_update();
+}
+
+
+/**@brief Function for removing a timer from the timer heap.
+ *
+ * @param[in]  timer_id   Id of timer to remove.
+ */
+static void timer_list_remove(app_timer_id_t timer_id)
+{
+    // Timer not in heap, e.g. already expired and waiting in the expired list.
+    if (mp_nodes[timer_id].heap_index == HEAP_INDEX_NONE)
+    {
+        return;
+    }
+
+    heap_remove_at(mp_nodes[timer_id].heap_index);
+
+    // No more timers in the heap. Reset RTC1 in case Start timer operations are present in the queue.
+    if ((m_timer_id_head == TIMER_NULL) && (m_expired_head == TIMER_NULL))
+    {
+        NRF_RTC1->TASKS_CLEAR = 1;
+        m_ticks_latest        = 0;
+        m_rtc1_reset          = true;
+    }
+}
+
+#else
+
+/**@brief Function for getting the number of ticks from m_ticks_latest to the expiry of a timer.
+ *
+ * @details Only valid for the first timer in the list.
+ */
+static __INLINE uint32_t timer_ticks_to_expire_get(app_timer_id_t timer_id)
+{
+    return mp_nodes[timer_id].ticks_to_expire;
+}
+
+
+/**@brief Function for getting the number of ticks from m_ticks_latest to the next wakeup.
+ *
+ * @details The wakeup is delayed as long as no running timer would be delayed by more than its
+ *          slack, so that timers expiring within each other's slack share one wakeup. Only the
+ *          part of the list expiring before the wakeup is visited.
+ */
+static uint32_t timer_wakeup_ticks_get(void)
+{
+    app_timer_id_t timer_id = m_timer_id_head;
+    uint32_t       expiry   = 0;
+    uint32_t       wakeup   = mp_nodes[timer_id].ticks_to_expire + mp_nodes[timer_id].ticks_slack;
+
+    while (timer_id != TIMER_NULL)
+    {
+        expiry += mp_nodes[timer_id].ticks_to_expire;
+        if (expiry > wakeup)
+        {
+            break;
+        }
+
+        wakeup   = MIN(wakeup, expiry + mp_nodes[timer_id].ticks_slack);
+        timer_id = mp_nodes[timer_id].next;
+    }
+
+    // The wakeup must stay within the range of the RTC counter.
+    return MIN(wakeup, MAX_RTC_COUNTER_VAL);
+}
+
+
 /**@brief Function for inserting a timer in the timer list.
  *
  * @param[in]  timer_id   Id of timer to insert.
@@ -328,6 +584,8 @@ static void timer_list_remove(app_timer_id_t timer_id)
     }
 }
 
+#endif // APP_TIMER_WITH_HEAP
+
 
 /**@brief Function for scheduling a check for timeouts by generating a RTC1 interrupt.
  */
@@ -368,12 +626,54 @@ static void timeout_handler_exec(timer_node_t * p_timer)
  */
 static void timer_timeouts_check(void)
 {
+#ifdef APP_TIMER_WITH_HEAP
+    // Handle expired of timer
+    if ((m_timer_id_head != TIMER_NULL) || (m_expired_head != TIMER_NULL))
+    {
+        uint32_t        ticks_elapsed;
+        uint32_t        ticks_expired;
+        uint32_t        expired_count = 0;
+
+        // ticks_elapsed is collected here, job will use it.
+        ticks_elapsed = ticks_diff_get(rtc1_counter_get(), m_ticks_latest);
+
+        // Move expired timers from the heap to the end of the expired list. This is safe since
+        // the list handler runs at the same interrupt level.
+        while ((m_timer_id_head != TIMER_NULL) &&
+               (timer_ticks_to_expire_get(m_timer_id_head) <= ticks_elapsed))
+        {
+            app_timer_id_t timer_id = m_timer_id_head;
+            timer_node_t * p_timer  = &mp_nodes[timer_id];
+
+            heap_remove_at(0);
+
+            p_timer->next = TIMER_NULL;
+            if (m_expired_head == TIMER_NULL)
+            {
+                m_expired_head = timer_id;
+            }
+            else
+            {
+                mp_nodes[m_expired_tail].next = timer_id;
+            }
+            m_expired_tail = timer_id;
+            expired_count++;
+
+            // Execute Task.
+            timeout_handler_exec(p_timer);
+        }
+
+        // Ticks consumed up to the last expired timer.
+        ticks_expired = (m_expired_head != TIMER_NULL) ? timer_ticks_to_expire_get(m_expired_tail) : 0;
+
+#else
     // Handle expired of timer 
     if (m_timer_id_head != TIMER_NULL)
     {
         app_timer_id_t  timer_id;
         uint32_t        ticks_elapsed;
         uint32_t        ticks_expired;
+        uint32_t        expired_count = 0;
 
         // Initialize actual elapsed ticks being consumed to 0.
         ticks_expired = 0;
@@ -404,11 +704,21 @@ static void timer_timeouts_check(void)
 
             // Move to next timer.
             timer_id = p_timer->next;
+            expired_count++;
 
             // Execute Task.
             timeout_handler_exec(p_timer);
         }
 
+#endif // APP_TIMER_WITH_HEAP
+
+        if (expired_count > 0)
+        {
+            m_stats.wakeups++;
+            m_stats.expirations   += expired_count;
+            m_stats.wakeups_saved += expired_count - 1;
+        }
+
         // Prepare to queue the ticks expired in the m_ticks_elapsed queue.
         if (m_ticks_elapsed_q_read_ind == m_ticks_elapsed_q_write_ind)
         {
@@ -510,6 +820,30 @@ static bool list_deletions_handler(void)
                     break;
                     
                 case TIMER_USER_OP_TYPE_STOP_ALL:
+#ifdef APP_TIMER_WITH_HEAP
+                {
+                    app_timer_id_t expired_id;
+
+                    // Empty the heap, and mark all timers as not running. Expired timers that have
+                    // not been handled yet are skipped by the expired timers handler.
+                    while (m_heap_size > 0)
+                    {
+                        timer_node_t * p_last = &mp_nodes[mp_nodes[--m_heap_size].heap_entry];
+
+                        p_last->is_running = false;
+                        p_last->heap_index = HEAP_INDEX_NONE;
+                    }
+                    heap_head_update();
+
+                    for (expired_id = m_expired_head;
+                         expired_id != TIMER_NULL;
+                         expired_id = mp_nodes[expired_id].next)
+                    {
+                        mp_nodes[expired_id].is_running = false;
+                    }
+                    break;
+                }
+#else
                     // Delete list of running timers, and mark all timers as not running.
                     while (m_timer_id_head != TIMER_NULL)
                     {
@@ -519,6 +853,7 @@ static bool list_deletions_handler(void)
                         m_timer_id_head    = p_head->next;
                     }
                     break;
+#endif
                     
                 default:
                     // No implementation needed.
@@ -542,6 +877,37 @@ static void expired_timers_handler(uint32_t         ticks_elapsed,
                                    uint32_t         ticks_previous,
                                    app_timer_id_t * p_restart_list_head)
 {
+#ifdef APP_TIMER_WITH_HEAP
+    app_timer_id_t timer_id = m_expired_head;
+
+    m_expired_head = TIMER_NULL;
+
+    while (timer_id != TIMER_NULL)
+    {
+        timer_node_t * p_timer = &mp_nodes[timer_id];
+        app_timer_id_t id_next = p_timer->next;
+
+        // Skip timers that were stopped after they expired.
+        if (p_timer->is_running)
+        {
+            p_timer->is_running = false;
+
+            // Timer will be restarted if periodic.
+            if (p_timer->ticks_periodic_interval != 0)
+            {
+                p_timer->ticks_at_start       = (ticks_previous + timer_ticks_to_expire_get(timer_id))
+                                                & MAX_RTC_COUNTER_VAL;
+                p_timer->ticks_first_interval = p_timer->ticks_periodic_interval;
+                p_timer->next                 = *p_restart_list_head;
+                *p_restart_list_head          = timer_id;
+            }
+        }
+
+        timer_id = id_next;
+    }
+
+    m_heap_ticks_origin += ticks_elapsed;
+#else
     uint32_t ticks_expired = 0;
 
     while (m_timer_id_head != TIMER_NULL)
@@ -580,6 +946,7 @@ static void expired_timers_handler(uint32_t         ticks_elapsed,
             *p_restart_list_head          = id_expired;
         }
     }
+#endif // APP_TIMER_WITH_HEAP
 }
 
 
@@ -593,6 +960,7 @@ static bool list_insertions_handler(app_timer_id_t restart_list_head)
 {
     app_timer_id_t timer_id_old_head;
     uint8_t        user_id;
+    bool           wakeup_moved = false;
 
     // Remember the old head, so as to decide if new compare needs to be set.
     timer_id_old_head = m_timer_id_head;
@@ -635,6 +1003,7 @@ static bool list_insertions_handler(app_timer_id_t restart_list_head)
                 p_timer->ticks_at_start          = p_user_op->params.start.ticks_at_start;
                 p_timer->ticks_first_interval    = p_user_op->params.start.ticks_first_interval;
                 p_timer->ticks_periodic_interval = p_user_op->params.start.ticks_periodic_interval;
+                p_timer->ticks_slack             = p_user_op->params.start.ticks_slack;
                 p_timer->p_context               = p_user_op->params.start.p_context;
 
                 if (m_rtc1_reset)
@@ -673,12 +1042,24 @@ static bool list_insertions_handler(app_timer_id_t restart_list_head)
             p_timer->is_running           = true;
             p_timer->next                 = TIMER_NULL;
 
+            // A timer inserted behind the head still moves the wakeup earlier if its slack ends
+            // before the programmed wakeup. The wakeup is kept as an RTC counter value, so the
+            // distance is taken from the current m_ticks_latest.
+            if (
+                MIN(p_timer->ticks_to_expire + p_timer->ticks_slack, MAX_RTC_COUNTER_VAL)
+                <
+                ticks_diff_get(m_ticks_wakeup, m_ticks_latest)
+               )
+            {
+                wakeup_moved = true;
+            }
+
             // Insert into list 
             timer_list_insert(id_start);
         }
     }
     
-    return (m_timer_id_head != timer_id_old_head);
+    return wakeup_moved || (m_timer_id_head != timer_id_old_head);
 }
 
 
@@ -689,7 +1070,7 @@ static void compare_reg_update(app_timer_id_t timer_id_head_old)
     // Setup the timeout for timers on the head of the list 
     if (m_timer_id_head != TIMER_NULL)
     {
-        uint32_t ticks_to_expire = mp_nodes[m_timer_id_head].ticks_to_expire;
+        uint32_t ticks_to_expire = timer_wakeup_ticks_get();
         uint32_t pre_counter_val = rtc1_counter_get();
         uint32_t cc              = m_ticks_latest;
         uint32_t ticks_elapsed   = ticks_diff_get(pre_counter_val, cc) + RTC_COMPARE_OFFSET_MIN;
@@ -704,6 +1085,7 @@ static void compare_reg_update(app_timer_id_t timer_id_head_old)
         cc &= MAX_RTC_COUNTER_VAL;
         
         rtc1_compare0_set(cc);
+        m_ticks_wakeup = cc;
 
         uint32_t post_counter_val = rtc1_counter_get();
 
@@ -820,6 +1202,7 @@ static timer_user_op_t * user_op_alloc(timer_user_t * p_user, app_timer_id_t * p
  * @param[in]  timer_id          Id of timer to start.
  * @param[in]  timeout_initial   Time (in ticks) to first timer expiry.
  * @param[in]  timeout_periodic  Time (in ticks) between periodic expiries.
+ * @param[in]  slack             Time (in ticks) each expiry may be delayed.
  * @param[in]  p_context         General purpose pointer. Will be passed to the timeout handler when
  *                               the timer expires.
  * @return     NRF_SUCCESS on success, otherwise an error code.
@@ -828,6 +1211,7 @@ static uint32_t timer_start_op_schedule(timer_user_id_t user_id,
                                         app_timer_id_t  timer_id,
                                         uint32_t        timeout_initial,
                                         uint32_t        timeout_periodic,
+                                        uint32_t        slack,
                                         void *          p_context)
 {
     app_timer_id_t last_index;
@@ -843,6 +1227,7 @@ static uint32_t timer_start_op_schedule(timer_user_id_t user_id,
     p_user_op->params.start.ticks_at_start          = rtc1_counter_get();
     p_user_op->params.start.ticks_first_interval    = timeout_initial;
     p_user_op->params.start.ticks_periodic_interval = timeout_periodic;
+    p_user_op->params.start.ticks_slack             = slack;
     p_user_op->params.start.p_context               = p_context;
     
     user_op_enque(&mp_users[user_id], last_index);    
@@ -968,6 +1353,9 @@ uint32_t app_timer_init(uint32_t                      prescaler,
     {
         mp_nodes[i].state      = STATE_FREE;
         mp_nodes[i].is_running = false;
+#ifdef APP_TIMER_WITH_HEAP
+        mp_nodes[i].heap_index = HEAP_INDEX_NONE;
+#endif
     }
     
     // Skip timer node array
@@ -995,6 +1383,12 @@ uint32_t app_timer_init(uint32_t                      prescaler,
     }
 
     m_timer_id_head             = TIMER_NULL;
+#ifdef APP_TIMER_WITH_HEAP
+    m_heap_size                 = 0;
+    m_heap_ticks_origin         = 0;
+    m_expired_head              = TIMER_NULL;
+    m_expired_tail              = TIMER_NULL;
+#endif
     m_ticks_elapsed_q_read_ind  = 0;
     m_ticks_elapsed_q_write_ind = 0;
 
@@ -1005,6 +1399,8 @@ uint32_t app_timer_init(uint32_t                      prescaler,
     rtc1_init(prescaler);
 
     m_ticks_latest = rtc1_counter_get();
+
+    memset(&m_stats, 0, sizeof(m_stats));
     
     return NRF_SUCCESS;
 }
@@ -1078,6 +1474,15 @@ static timer_user_id_t user_id_get(void)
 
 
 uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    return app_timer_start_with_slack(timer_id, timeout_ticks, 0, p_context);
+}
+
+
+uint32_t app_timer_start_with_slack(app_timer_id_t timer_id,
+                                    uint32_t       timeout_ticks,
+                                    uint32_t       slack_ticks,
+                                    void *         p_context)
 {
     uint32_t timeout_periodic;
     
@@ -1086,7 +1491,8 @@ uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void *
     {
         return NRF_ERROR_INVALID_STATE;
     }
-    if ((timer_id >= m_node_array_size) || (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS))
+    if ((timer_id >= m_node_array_size) || (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS) ||
+        (slack_ticks >= timeout_ticks))
     {
         return NRF_ERROR_INVALID_PARAM;
     }
@@ -1102,6 +1508,7 @@ uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void *
                                    timer_id,
                                    timeout_ticks,
                                    timeout_periodic,
+                                   slack_ticks,
                                    p_context);
 }
 
@@ -1154,3 +1561,14 @@ uint32_t app_timer_cnt_diff_compute(uint32_t   ticks_to,
     return NRF_SUCCESS;
 }
 
+
+uint32_t app_timer_stats_get(app_timer_stats_t * p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    *p_stats = m_stats;
+    return NRF_SUCCESS;
+}
@@ -34,6 +34,11 @@
  * @details Use the USE_SCHEDULER parameter of the APP_TIMER_INIT() macro to select if the
  *          @ref app_scheduler is to be used or not.
  *
+ * @details Running timers are kept in a delta-encoded linked list by default, which makes
+ *          starting and stopping a timer O(n) in the number of running timers. Define
+ *          APP_TIMER_WITH_HEAP to keep them in a binary heap instead, making start, stop and
+ *          expiry O(log n) at the cost of a few more instructions for small timer counts.
+ *
  * @note    Even if the scheduler is not used, app_timer.h will include app_scheduler.h, so when
  *          compiling, app_scheduler.h must be available in one of the compiler include paths.
  */
@@ -51,8 +56,8 @@
 #define APP_TIMER_CLOCK_FREQ         32768                      /**< Clock frequency of the RTC timer used to implement the app timer module. */
 #define APP_TIMER_MIN_TIMEOUT_TICKS  5                          /**< Minimum value of the timeout_ticks parameter of app_timer_start(). */
 
-#define APP_TIMER_NODE_SIZE          40                         /**< Size of app_timer.timer_node_t (only for use inside APP_TIMER_BUF_SIZE()). */
-#define APP_TIMER_USER_OP_SIZE       24                         /**< Size of app_timer.timer_user_op_t (only for use inside APP_TIMER_BUF_SIZE()). */
+#define APP_TIMER_NODE_SIZE          44                         /**< Size of app_timer.timer_node_t (only for use inside APP_TIMER_BUF_SIZE()). */
+#define APP_TIMER_USER_OP_SIZE       28                         /**< Size of app_timer.timer_user_op_t (only for use inside APP_TIMER_BUF_SIZE()). */
 #define APP_TIMER_USER_SIZE          8                          /**< Size of app_timer.timer_user_t (only for use inside APP_TIMER_BUF_SIZE()). */
 #define APP_TIMER_INT_LEVELS         3                          /**< Number of interrupt levels from where timer operations may be initiated (only for use inside APP_TIMER_BUF_SIZE()). */
 
@@ -114,6 +119,14 @@ typedef enum
     APP_TIMER_MODE_REPEATED                     /**< The timer will restart each time it expires. */
 } app_timer_mode_t;
 
+/**@brief Timer wakeup statistics. */
+typedef struct
+{
+    uint32_t wakeups;                           /**< Number of RTC1 interrupts that expired at least one timer. */
+    uint32_t expirations;                       /**< Number of timer expiries. */
+    uint32_t wakeups_saved;                     /**< Number of timer expiries that shared a wakeup with an earlier expiry. */
+} app_timer_stats_t;
+
 /**@brief Macro for initializing the application timer module.
  *
  * @details It will handle dimensioning and allocation of the memory buffer required by the timer,
@@ -222,6 +235,33 @@ uint32_t app_timer_create(app_timer_id_t *            p_timer_id,
  */
 uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context);
 
+/**@brief Function for starting a timer that tolerates a delayed expiry.
+ *
+ * @details Works like app_timer_start(), but each expiry may be delayed by up to slack_ticks so
+ *          that it can be handled in the same RTC1 wakeup as other timers. The wakeup is placed
+ *          at the latest point that does not delay any running timer by more than its own slack.
+ *          For repeating timers, the next interval is counted from the nominal expiry, so the
+ *          slack does not accumulate.
+ *
+ * @param[in]  timer_id        Id of timer to start.
+ * @param[in]  timeout_ticks   Number of ticks (of RTC1, including prescaling) to timeout event
+ *                             (minimum 5 ticks).
+ * @param[in]  slack_ticks     Number of ticks each expiry may be delayed. Must be smaller than
+ *                             timeout_ticks. Zero gives the same behavior as app_timer_start().
+ * @param[in]  p_context       General purpose pointer. Will be passed to the timeout handler when
+ *                             the timer expires.
+ *
+ * @retval     NRF_SUCCESS               Timer was successfully started.
+ * @retval     NRF_ERROR_INVALID_PARAM   Invalid parameter.
+ * @retval     NRF_ERROR_INVALID_STATE   Application timer module has not been initialized, or timer
+ *                                       has not been created.
+ * @retval     NRF_ERROR_NO_MEM          Timer operations queue was full.
+ */
+uint32_t app_timer_start_with_slack(app_timer_id_t timer_id,
+                                    uint32_t       timeout_ticks,
+                                    uint32_t       slack_ticks,
+                                    void *         p_context);
+
 /**@brief Function for stopping the specified timer.
  *
  * @param[in]  timer_id   Id of timer to stop.
@@ -262,6 +302,15 @@ uint32_t app_timer_cnt_diff_compute(uint32_t   ticks_to,
                                     uint32_t   ticks_from,
                                     uint32_t * p_ticks_diff);
 
+/**@brief Function for reading the timer wakeup statistics.
+ *
+ * @param[out] p_stats   Statistics since app_timer_init().
+ *
+ * @retval     NRF_SUCCESS      Statistics were successfully read.
+ * @retval     NRF_ERROR_NULL   p_stats is NULL.
+ */
+uint32_t app_timer_stats_get(app_timer_stats_t * p_stats);
+
 #endif // APP_TIMER_H__
 
 /** @} */
@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 #include "ser_sd_transport.h"
 #include "ser_hal_transport.h"
 #include "nrf_error.h"
@@ -54,6 +55,155 @@ static volatile bool m_rsp_wait = false;
 /** SoftDevice call return value decoded by user decoder handler. */
 static uint32_t m_return_value;
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+/**@brief Structure for a command that has been sent and is waiting for its response. */
+typedef struct
+{
+    ser_sd_transport_rsp_handler_t rsp_handler; /**< Response decoder. NULL if the entry is free. */
+    uint8_t                        pkt_type;    /**< Packet type of the command. */
+    uint8_t                        op_code;     /**< Op code of the command, repeated in the response. */
+    uint8_t                        seq;         /**< Tag given in sending order. */
+    bool                           blocking;    /**< True if cmd_write is waiting for this response. */
+} ser_sd_transport_cmd_t;
+
+/** Commands in flight. An entry is claimed in task context and released in interrupt context, the
+ *  response handler is written last when claiming so no entry is seen half filled. */
+static ser_sd_transport_cmd_t m_cmd_window[SER_SD_TRANSPORT_WINDOW_SIZE];
+
+/** Tag given to the next command. */
+static uint8_t m_cmd_seq = 0;
+
+/** Handler called when a command sent with @ref ser_sd_transport_cmd_post fails. */
+static ser_sd_transport_async_rsp_handler_t m_async_rsp_handler = NULL;
+
+
+/**@brief Function for counting the commands in flight.
+ */
+static uint32_t cmd_window_count(void)
+{
+    uint32_t i;
+    uint32_t count = 0;
+
+    for (i = 0; i < SER_SD_TRANSPORT_WINDOW_SIZE; i++)
+    {
+        if (m_cmd_window[i].rsp_handler != NULL)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+
+/**@brief Function for claiming a window entry for a command about to be sent.
+ *
+ * @param[in]   p_buffer    Command packet, starting with the packet type.
+ * @param[in]   rsp_handler Response decoder.
+ * @param[in]   blocking    True if the caller waits for the response.
+ *
+ * @return Pointer to the entry, NULL if the window is full.
+ */
+static ser_sd_transport_cmd_t * cmd_window_claim(const uint8_t *                p_buffer,
+                                                 ser_sd_transport_rsp_handler_t rsp_handler,
+                                                 bool                           blocking)
+{
+    uint32_t i;
+
+    for (i = 0; i < SER_SD_TRANSPORT_WINDOW_SIZE; i++)
+    {
+        if (m_cmd_window[i].rsp_handler == NULL)
+        {
+            m_cmd_window[i].pkt_type    = p_buffer[SER_PKT_TYPE_POS];
+            m_cmd_window[i].op_code     = p_buffer[SER_PKT_OP_CODE_POS];
+            m_cmd_window[i].seq         = m_cmd_seq++;
+            m_cmd_window[i].blocking    = blocking;
+            m_cmd_window[i].rsp_handler = rsp_handler;
+            return &m_cmd_window[i];
+        }
+    }
+    return NULL;
+}
+
+
+/**@brief Function for finding the command a response belongs to.
+ *
+ * @details The connectivity chip does not echo the tag, so the response is given to the oldest
+ *          command in flight with the same op code. DTM responses go to the oldest DTM command.
+ *
+ * @param[in]   packet_type Response packet type.
+ * @param[in]   p_data      Response packet without the packet type.
+ *
+ * @return Pointer to the entry, NULL if no command waits for this response.
+ */
+static ser_sd_transport_cmd_t * cmd_window_match(uint8_t packet_type, const uint8_t * p_data)
+{
+    ser_sd_transport_cmd_t * p_match = NULL;
+    uint8_t                  max_age = 0;
+    uint32_t                 i;
+
+    for (i = 0; i < SER_SD_TRANSPORT_WINDOW_SIZE; i++)
+    {
+        ser_sd_transport_cmd_t * p_cmd = &m_cmd_window[i];
+        const uint8_t            age   = (uint8_t)(m_cmd_seq - p_cmd->seq);
+
+        if (p_cmd->rsp_handler == NULL)
+        {
+            continue;
+        }
+        if (packet_type == SER_PKT_TYPE_DTM_RESP)
+        {
+            if (p_cmd->pkt_type != SER_PKT_TYPE_DTM_CMD)
+            {
+                continue;
+            }
+        }
+        else if ((p_cmd->pkt_type != SER_PKT_TYPE_CMD) ||
+                 (p_cmd->op_code != p_data[SER_CMD_OP_CODE_POS]))
+        {
+            continue;
+        }
+        if ((p_match == NULL) || (age > max_age))
+        {
+            p_match = p_cmd;
+            max_age = age;
+        }
+    }
+    return p_match;
+}
+
+
+/**@brief Function for completing a command in flight with its decoded result.
+ *
+ * @param[in]   p_cmd       Window entry of the command.
+ * @param[in]   result      SoftDevice call return value.
+ */
+static void cmd_window_complete(ser_sd_transport_cmd_t * p_cmd, uint32_t result)
+{
+    const bool    blocking = p_cmd->blocking;
+    const uint8_t op_code  = p_cmd->op_code;
+
+    p_cmd->rsp_handler = NULL;
+
+    if (blocking)
+    {
+        m_return_value = result;
+
+        /* Reset response flag - cmd_write function is pending on it.*/
+        m_rsp_wait = false;
+
+        /* If os handler is set, signal os that response has arrived.*/
+        if (m_os_rsp_set_handler)
+        {
+            m_os_rsp_set_handler();
+        }
+    }
+    else if ((result != NRF_SUCCESS) && m_async_rsp_handler)
+    {
+        m_async_rsp_handler(op_code, result);
+    }
+}
+#endif // SER_SD_TRANSPORT_PIPELINE
+
 /**@brief Function for handling the rx packets comming from hal_transport.
  *
  * @details
@@ -77,6 +227,23 @@ static void ser_sd_transport_rx_packet_handler(uint8_t * p_data, uint16_t length
             case SER_PKT_TYPE_RESP:
             case SER_PKT_TYPE_DTM_RESP:
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+                if (length >= SER_OP_CODE_SIZE)
+                {
+                    ser_sd_transport_cmd_t * p_cmd = cmd_window_match(packet_type, p_data);
+
+                    if (p_cmd)
+                    {
+                        const uint32_t result = p_cmd->rsp_handler(p_data, length);
+                        (void)ser_sd_transport_rx_free(p_data);
+                        cmd_window_complete(p_cmd, result);
+                        break;
+                    }
+                }
+                /* Unexpected packet. */
+                (void)ser_sd_transport_rx_free(p_data);
+                APP_ERROR_HANDLER(packet_type);
+#else
                 if (m_rsp_wait)
                 {
                     m_return_value = m_rsp_dec_handler(p_data, length);
@@ -97,6 +264,7 @@ static void ser_sd_transport_rx_packet_handler(uint8_t * p_data, uint16_t length
                     (void)ser_sd_transport_rx_free(p_data);
                     APP_ERROR_HANDLER(packet_type);
                 }
+#endif // SER_SD_TRANSPORT_PIPELINE
                 break;
 
             case SER_PKT_TYPE_EVT:
@@ -139,6 +307,20 @@ static void ser_sd_transport_hal_handler(ser_hal_transport_evt_t event)
         break;
     case SER_HAL_TRANSP_EVT_PHY_ERROR:
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+        {
+            /* Responses to all commands in flight are lost. */
+            uint32_t i;
+
+            for (i = 0; i < SER_SD_TRANSPORT_WINDOW_SIZE; i++)
+            {
+                if (m_cmd_window[i].rsp_handler != NULL)
+                {
+                    cmd_window_complete(&m_cmd_window[i], NRF_ERROR_INTERNAL);
+                }
+            }
+        }
+#else
         if (m_rsp_wait)
         {
             m_return_value = NRF_ERROR_INTERNAL;
@@ -152,6 +334,7 @@ static void ser_sd_transport_hal_handler(ser_hal_transport_evt_t event)
                 m_os_rsp_set_handler();
             }
         }
+#endif // SER_SD_TRANSPORT_PIPELINE
         break;
     default:
         break;
@@ -184,6 +367,12 @@ uint32_t ser_sd_transport_close(void)
     m_os_rsp_set_handler  = NULL;
     m_ot_rsp_wait_handler = NULL;
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+    memset(m_cmd_window, 0, sizeof (m_cmd_window));
+    m_rsp_wait            = false;
+    m_async_rsp_handler   = NULL;
+#endif // SER_SD_TRANSPORT_PIPELINE
+
     ser_hal_transport_close();
 
     return NRF_SUCCESS;
@@ -198,14 +387,18 @@ uint32_t ser_sd_transport_ot_rsp_wait_handler_set(ser_sd_transport_rsp_wait_hand
 
 bool ser_sd_transport_is_busy(void)
 {
+#ifdef SER_SD_TRANSPORT_PIPELINE
+    return m_rsp_wait || (cmd_window_count() == SER_SD_TRANSPORT_WINDOW_SIZE);
+#else
     return m_rsp_wait;
+#endif // SER_SD_TRANSPORT_PIPELINE
 }
 
 uint32_t ser_sd_transport_tx_alloc(uint8_t * * pp_data, uint16_t * p_len)
 {
     uint32_t err_code;
 
-    if (m_rsp_wait)
+    if (ser_sd_transport_is_busy())
     {
         err_code = NRF_ERROR_BUSY;
     }
@@ -233,9 +426,31 @@ uint32_t ser_sd_transport_cmd_write(const uint8_t *                p_buffer,
 {
     uint32_t err_code = NRF_SUCCESS;
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+    ser_sd_transport_cmd_t * p_cmd = NULL;
+
+    m_rsp_wait = true;
+    if (cmd_rsp_decode_callback)
+    {
+        /* The window entry must exist before the response can arrive. */
+        p_cmd = cmd_window_claim(p_buffer, cmd_rsp_decode_callback, true);
+        if (p_cmd == NULL)
+        {
+            m_rsp_wait = false;
+            (void)ser_hal_transport_tx_pkt_free((uint8_t *)p_buffer);
+            return NRF_ERROR_BUSY;
+        }
+    }
+    err_code = ser_hal_transport_tx_pkt_send(p_buffer, length);
+    if ((err_code != NRF_SUCCESS) && p_cmd)
+    {
+        p_cmd->rsp_handler = NULL;
+    }
+#else
     m_rsp_wait        = true;
     m_rsp_dec_handler = cmd_rsp_decode_callback;
     err_code          = ser_hal_transport_tx_pkt_send(p_buffer, length);
+#endif // SER_SD_TRANSPORT_PIPELINE
     APP_ERROR_CHECK(err_code);
 
     /* Execute callback for response decoding only if one was provided.*/
@@ -257,3 +472,46 @@ uint32_t ser_sd_transport_cmd_write(const uint8_t *                p_buffer,
     APPL_LOG("\r\n[SD_CALL_ID]: 0x%X, err_code= 0x%X\r\n", p_buffer[1], err_code);
     return err_code;
 }
+
+#ifdef SER_SD_TRANSPORT_PIPELINE
+uint32_t ser_sd_transport_cmd_post(const uint8_t *                p_buffer,
+                                   uint16_t                       length,
+                                   ser_sd_transport_rsp_handler_t cmd_rsp_decode_callback)
+{
+    uint32_t                 err_code;
+    ser_sd_transport_cmd_t * p_cmd;
+
+    if (cmd_rsp_decode_callback == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    p_cmd = cmd_window_claim(p_buffer, cmd_rsp_decode_callback, false);
+    if (p_cmd == NULL)
+    {
+        (void)ser_hal_transport_tx_pkt_free((uint8_t *)p_buffer);
+        return NRF_ERROR_BUSY;
+    }
+
+    err_code = ser_hal_transport_tx_pkt_send(p_buffer, length);
+    if (err_code != NRF_SUCCESS)
+    {
+        p_cmd->rsp_handler = NULL;
+        (void)ser_hal_transport_tx_pkt_free((uint8_t *)p_buffer);
+    }
+    APPL_LOG("\r\n[SD_POST_ID]: 0x%X, err_code= 0x%X\r\n", p_buffer[1], err_code);
+    return err_code;
+}
+
+uint32_t ser_sd_transport_async_rsp_handler_set(ser_sd_transport_async_rsp_handler_t handler)
+{
+    m_async_rsp_handler = handler;
+
+    return NRF_SUCCESS;
+}
+
+uint32_t ser_sd_transport_cmd_in_flight_count(void)
+{
+    return cmd_window_count();
+}
+#endif // SER_SD_TRANSPORT_PIPELINE
@@ -30,6 +30,13 @@
  *          ser_sd_transport (using response decoder handler provided for each SoftDevice call) but
  *          events are forwarded to the user so it is user's responsibility to free RX buffer.
  *
+ *          When SER_SD_TRANSPORT_PIPELINE is defined, up to SER_SD_TRANSPORT_WINDOW_SIZE commands
+ *          can be in flight. Commands written with @ref ser_sd_transport_cmd_write still block
+ *          until their own response arrives, while commands posted with
+ *          @ref ser_sd_transport_cmd_post return once they are sent. Responses are matched to the
+ *          oldest command in flight with the same op code, so the connectivity side needs no
+ *          changes.
+ *
  */
 #ifndef SER_SD_TRANSPORT_H_
 #define SER_SD_TRANSPORT_H_
@@ -37,12 +44,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+#ifndef SER_SD_TRANSPORT_WINDOW_SIZE
+#define SER_SD_TRANSPORT_WINDOW_SIZE 4 /**< Maximum number of commands waiting for a response. */
+#endif
+#endif // SER_SD_TRANSPORT_PIPELINE
+
 typedef void (*ser_sd_transport_evt_handler_t)(uint8_t * p_buffer, uint16_t length);
 typedef void (*ser_sd_transport_rsp_wait_handler_t)(void);
 typedef void (*ser_sd_transport_rsp_set_handler_t)(void);
 typedef void (*ser_sd_transport_rx_notification_handler_t)(void);
 
 typedef uint32_t (*ser_sd_transport_rsp_handler_t)(const uint8_t * p_buffer, uint16_t length);
+typedef void (*ser_sd_transport_async_rsp_handler_t)(uint8_t op_code, uint32_t result);
 
 /**@brief Function for opening the module.
  *
@@ -126,6 +140,8 @@ uint32_t ser_sd_transport_rx_free(uint8_t * p_data);
 
 
 /**@brief Function for checking if module is busy waiting for response from connectivity side.
+ *
+ * @note In pipelined mode the module is also busy when the command window is full.
  *
  * @retval true      Module busy. Cannot accept next command.
  * @retval false     Module not busy. Can accept next command.
@@ -144,10 +160,53 @@ bool ser_sd_transport_is_busy(void);
  * @param[in] cmd_resp_decode_callback Pointer to function for decoding response packet.
  *
  * @retval NRF_SUCCESS          Operation success.
+ * @retval NRF_ERROR_BUSY       Command window is full. The command buffer has been released.
  */
 uint32_t ser_sd_transport_cmd_write(const uint8_t *                p_buffer,
                                     uint16_t                       length,
                                     ser_sd_transport_rsp_handler_t cmd_resp_decode_callback);
 
+#ifdef SER_SD_TRANSPORT_PIPELINE
+/**@brief Function for sending a SoftDevice command without waiting for its response.
+ *
+ * @details The response is decoded in serial peripheral interrupt context when it arrives. If the
+ *          decoded return value is not NRF_SUCCESS, the handler set with
+ *          @ref ser_sd_transport_async_rsp_handler_set is called.
+ *
+ * @note Output parameters of the command must stay valid until the response arrives, or the
+ *       decoder must not write them.
+ * @note The SoftDevice calls in the codec middleware always use @ref ser_sd_transport_cmd_write,
+ *       so their return codes and output parameters reach the caller as before. Commands posted
+ *       with this function only report failures through the handler set with
+ *       @ref ser_sd_transport_async_rsp_handler_set.
+ *
+ * @param[in] p_buffer                 Pointer to command.
+ * @param[in] length                   Command length.
+ * @param[in] cmd_resp_decode_callback Pointer to function for decoding response packet.
+ *
+ * @retval NRF_SUCCESS          Command sent.
+ * @retval NRF_ERROR_NULL       No response decoder given.
+ * @retval NRF_ERROR_BUSY       Command window is full. The command buffer has been released.
+ * @retval NRF_ERROR_INTERNAL   Command could not be sent. The command buffer has been released.
+ */
+uint32_t ser_sd_transport_cmd_post(const uint8_t *                p_buffer,
+                                   uint16_t                       length,
+                                   ser_sd_transport_rsp_handler_t cmd_resp_decode_callback);
+
+/**@brief Function for setting the handler called when a posted command fails.
+ *
+ * @note The handler is called in serial peripheral interrupt context.
+ *
+ * @param[in] handler       Handler, or NULL to ignore failures.
+ *
+ * @retval NRF_SUCCESS          Operation success.
+ */
+uint32_t ser_sd_transport_async_rsp_handler_set(ser_sd_transport_async_rsp_handler_t handler);
+
+/**@brief Function for getting the number of commands waiting for a response.
+ */
+uint32_t ser_sd_transport_cmd_in_flight_count(void);
+#endif // SER_SD_TRANSPORT_PIPELINE
+
 #endif /* SER_SD_TRANSPORT_H_ */
 /** @} */
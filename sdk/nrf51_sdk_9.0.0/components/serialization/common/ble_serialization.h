@@ -15,8 +15,10 @@
 
 #include "nordic_common.h"
 #include "nrf_error.h"
+#include "compiler_abstraction.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 /**@brief The types of serialization packets. */
 typedef enum
@@ -120,6 +122,109 @@ typedef enum
 /** See Bluetooth 4.0 spec: 3.4.4.7. */
 #define BLE_GATTC_HANDLE_COUNT_LEN_MAX     ((GATT_MTU_SIZE_DEFAULT - 1) / 2)
 
+/** Size in bytes of the run of members FIRST to LAST of a struct type. */
+#define SER_RUN_SIZE(TYPE, FIRST, LAST) \
+    (offsetof(TYPE, LAST) + sizeof (((TYPE *)0)->LAST) - offsetof(TYPE, FIRST))
+
+/* Field macros for the length the fields of a struct take themselves, without the fields that
+ * conditional members point to. */
+#define SER_RUN_LEN(FIRST, LAST)                                                                   \
+    ser_len += SER_RUN_SIZE(ser_struct_t, FIRST, LAST);
+
+#define SER_COND_LEN(MEMBER, ENC, DEC)                                                             \
+    ser_len += 1;
+
+#define SER_LEN16DATA_ENC_LEN(DATA, LEN, LEN_MAX)                                                  \
+    SER_ERROR_CHECK(p_ser_struct->LEN <= (LEN_MAX), NRF_ERROR_INVALID_PARAM);                      \
+    ser_len += 3 + ((p_ser_struct->DATA != NULL) ? p_ser_struct->LEN : 0);
+
+#define SER_LEN16DATA_DEC_LEN(DATA, LEN, LEN_MAX)                                                  \
+    ser_len += 3;
+
+/* Field macros for encoding. */
+#define SER_RUN_ENC(FIRST, LAST)                                                                   \
+    memcpy(&p_ser_buf[ser_index], &p_ser_struct->FIRST, SER_RUN_SIZE(ser_struct_t, FIRST, LAST)); \
+    ser_index += SER_RUN_SIZE(ser_struct_t, FIRST, LAST);                                          \
+    ser_len   -= SER_RUN_SIZE(ser_struct_t, FIRST, LAST);
+
+#define SER_COND_ENC(MEMBER, ENC, DEC)                                                             \
+    p_ser_buf[ser_index++] = (p_ser_struct->MEMBER == NULL) ? SER_FIELD_NOT_PRESENT                \
+                                                            : SER_FIELD_PRESENT;                   \
+    ser_len               -= 1;                                                                    \
+    if (p_ser_struct->MEMBER != NULL)                                                              \
+    {                                                                                              \
+        uint32_t ser_err_code;                                                                     \
+                                                                                                   \
+        *p_ser_index = ser_index;                                                                  \
+        ser_err_code = ENC(p_ser_struct->MEMBER, p_ser_buf, ser_buf_len, p_ser_index);            \
+        SER_ASSERT(ser_err_code == NRF_SUCCESS, ser_err_code);                                     \
+        ser_index = *p_ser_index;                                                                  \
+        SER_ASSERT_LENGTH_LEQ(ser_len, ((int32_t)ser_buf_len - ser_index));                        \
+    }
+
+#define SER_LEN16DATA_ENC(DATA, LEN, LEN_MAX)                                                      \
+    ser_index             += uint16_encode(p_ser_struct->LEN, &p_ser_buf[ser_index]);              \
+    p_ser_buf[ser_index++] = (p_ser_struct->DATA == NULL) ? SER_FIELD_NOT_PRESENT                  \
+                                                          : SER_FIELD_PRESENT;                     \
+    ser_len               -= 3;                                                                    \
+    if (p_ser_struct->DATA != NULL)                                                                \
+    {                                                                                              \
+        memcpy(&p_ser_buf[ser_index], p_ser_struct->DATA, p_ser_struct->LEN);                      \
+        ser_index += p_ser_struct->LEN;                                                            \
+        ser_len   -= p_ser_struct->LEN;                                                            \
+    }
+
+/* Field macros for decoding. Present pointer members must point to storage for the decoded
+ * field, and the length member of len16 data holds the size of that storage. */
+#define SER_RUN_DEC(FIRST, LAST)                                                                   \
+    memcpy(&p_ser_struct->FIRST, &p_ser_buf[ser_index], SER_RUN_SIZE(ser_struct_t, FIRST, LAST)); \
+    ser_index += SER_RUN_SIZE(ser_struct_t, FIRST, LAST);                                          \
+    ser_len   -= SER_RUN_SIZE(ser_struct_t, FIRST, LAST);
+
+#define SER_COND_DEC(MEMBER, ENC, DEC)                                                             \
+    ser_len -= 1;                                                                                  \
+    if (p_ser_buf[ser_index] == SER_FIELD_PRESENT)                                                 \
+    {                                                                                              \
+        uint32_t ser_err_code;                                                                     \
+                                                                                                   \
+        SER_ASSERT_NOT_NULL(p_ser_struct->MEMBER);                                                 \
+        *p_ser_index = ser_index + 1;                                                              \
+        ser_err_code = DEC(p_ser_buf, ser_buf_len, p_ser_index, p_ser_struct->MEMBER);            \
+        SER_ASSERT(ser_err_code == NRF_SUCCESS, ser_err_code);                                     \
+        ser_index = *p_ser_index;                                                                  \
+        SER_ASSERT_LENGTH_LEQ(ser_len, ((int32_t)ser_buf_len - ser_index));                        \
+    }                                                                                              \
+    else if (p_ser_buf[ser_index] == SER_FIELD_NOT_PRESENT)                                        \
+    {                                                                                              \
+        p_ser_struct->MEMBER = NULL;                                                               \
+        ser_index++;                                                                               \
+    }                                                                                              \
+    else                                                                                           \
+    {                                                                                              \
+        return NRF_ERROR_INVALID_DATA;                                                             \
+    }
+
+#define SER_LEN16DATA_DEC(DATA, LEN, LEN_MAX)                                                      \
+    {                                                                                              \
+        uint16_t ser_dlen_max = p_ser_struct->LEN;                                                 \
+                                                                                                   \
+        p_ser_struct->LEN = uint16_decode(&p_ser_buf[ser_index]);                                  \
+        ser_index        += 3;                                                                     \
+        ser_len          -= 3;                                                                     \
+        if (p_ser_buf[ser_index - 1] == SER_FIELD_PRESENT)                                         \
+        {                                                                                          \
+            SER_ASSERT_NOT_NULL(p_ser_struct->DATA);                                               \
+            SER_ASSERT_LENGTH_LEQ(p_ser_struct->LEN, ser_dlen_max);                                \
+            SER_ASSERT_LENGTH_LEQ(p_ser_struct->LEN + ser_len, ((int32_t)ser_buf_len - ser_index));\
+            memcpy(p_ser_struct->DATA, &p_ser_buf[ser_index], p_ser_struct->LEN);                  \
+            ser_index += p_ser_struct->LEN;                                                        \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            p_ser_struct->DATA = NULL;                                                             \
+        }                                                                                          \
+    }
+
 /** Generic command response status code encoder. */
 uint32_t ser_ble_cmd_rsp_status_code_enc(uint8_t          op_code,
                                          uint32_t         command_status,
@@ -575,6 +680,112 @@ uint32_t uint8_vector_dec(uint8_t const * const p_buf,
                  uint8_t  * const      p_data,
                  uint16_t              dlen);
 
+/**@brief Macro for the body of an encoder of a struct described by a schema.
+ *
+ * The buffer length is checked once for all the bytes the struct itself takes, then each field is
+ * written. A conditional field hands the field it points to to its own encoder, and the length is
+ * checked again for the rest of the struct when that returns. The body returns from the encoder.
+ *
+ * A schema lists the fields of a struct in the order they are serialized. It is a macro that takes
+ * the names of three field macros and uses them for its fields, for example:
+ *
+ * @code
+ * #define OPT_PRIVACY_FIELDS(RUN, COND, LEN16DATA)        \
+ *     COND(p_irk, ble_gap_irk_enc, ble_gap_irk_dec)       \
+ *     RUN(interval_s, interval_s)
+ * @endcode
+ *
+ * - RUN(FIRST, LAST): members FIRST to LAST, serialized as they are stored in memory. The members
+ *   must follow each other without padding and must be stored little-endian, which is the case
+ *   for all nRF51 targets.
+ * - COND(MEMBER, ENC, DEC): pointer member, serialized as by @ref cond_field_enc with the field
+ *   encoder ENC and the field decoder DEC.
+ * - LEN16DATA(DATA, LEN, LEN_MAX): data pointer member and its uint16_t length member, serialized
+ *   as by @ref len16data_enc. Encoding fails with NRF_ERROR_INVALID_PARAM when the length is above
+ *   LEN_MAX.
+ *
+ * The schema expands into straight-line code for each field, and each run into a copy of a fixed
+ * size.
+ *
+ * @param[in]      TYPE             Type of the struct.
+ * @param[in]      FIELDS           Schema of the struct.
+ * @param[in]      P_STRUCT         Pointer to the struct.
+ * @param[out]     P_BUF            Pointer to the beginning of the output buffer.
+ * @param[in]      BUF_LEN          Size of buffer.
+ * @param[in,out]  P_INDEX          \c in: Index to start of the struct in buffer.
+ *                                  \c out: Index in buffer to first byte after the encoded struct.
+ *
+ * @return NRF_SUCCESS              Fields encoded successfully.
+ * @retval NRF_ERROR_INVALID_LENGTH Encoding failure. Incorrect buffer length.
+ * @retval NRF_ERROR_INVALID_PARAM  Encoding failure. Len16 data longer than allowed.
+ */
+#define SER_STRUCT_ENC(TYPE, FIELDS, P_STRUCT, P_BUF, BUF_LEN, P_INDEX)                            \
+    typedef TYPE               ser_struct_t;                                                       \
+    ser_struct_t const * const p_ser_struct = (ser_struct_t const *)(P_STRUCT);                    \
+    uint8_t * const            p_ser_buf    = (P_BUF);                                             \
+    uint32_t const             ser_buf_len  = (BUF_LEN);                                           \
+    uint32_t * const           p_ser_index  = (P_INDEX);                                           \
+    uint32_t                   ser_index;                                                          \
+    uint32_t                   ser_len      = 0;                                                   \
+                                                                                                   \
+    SER_ASSERT_NOT_NULL(p_ser_struct);                                                             \
+    SER_ASSERT_NOT_NULL(p_ser_buf);                                                                \
+    SER_ASSERT_NOT_NULL(p_ser_index);                                                              \
+                                                                                                   \
+    FIELDS(SER_RUN_LEN, SER_COND_LEN, SER_LEN16DATA_ENC_LEN)                                       \
+    SER_ASSERT_LENGTH_LEQ(ser_len, ((int32_t)ser_buf_len - *p_ser_index));                         \
+                                                                                                   \
+    ser_index = *p_ser_index;                                                                      \
+    FIELDS(SER_RUN_ENC, SER_COND_ENC, SER_LEN16DATA_ENC)                                           \
+    *p_ser_index = ser_index;                                                                      \
+                                                                                                   \
+    return NRF_SUCCESS
+
+/**@brief Macro for the body of a decoder of a struct described by a schema.
+ *
+ * The buffer length is checked once for all the bytes the struct itself takes, then each field is
+ * read. A conditional field hands the field it points to to its own decoder, and the length is
+ * checked again for the rest of the struct when that returns. The body returns from the decoder.
+ *
+ * As with @ref cond_field_dec and @ref len16data_dec, present pointer members must point to
+ * storage for the decoded field, and the length member of len16 data holds the size of that
+ * storage. Pointer members of fields that are not present are set to NULL.
+ *
+ * @param[in]      TYPE             Type of the struct.
+ * @param[in]      FIELDS           Schema of the struct, see @ref SER_STRUCT_ENC.
+ * @param[in]      P_BUF            Pointer to the beginning of the input buffer.
+ * @param[in]      BUF_LEN          Size of buffer.
+ * @param[in,out]  P_INDEX          \c in: Index to start of the struct in buffer.
+ *                                  \c out: Index in buffer to first byte after the decoded struct.
+ * @param[in,out]  P_STRUCT         Pointer to the struct.
+ *
+ * @return NRF_SUCCESS              Fields decoded successfully.
+ * @retval NRF_ERROR_INVALID_LENGTH Decoding failure. Incorrect buffer length.
+ * @retval NRF_ERROR_INVALID_DATA   Decoding failure. Invalid presence flag of a conditional field.
+ * @retval NRF_ERROR_NULL           Decoding failure. No storage for a present field.
+ */
+#define SER_STRUCT_DEC(TYPE, FIELDS, P_BUF, BUF_LEN, P_INDEX, P_STRUCT)                            \
+    typedef TYPE          ser_struct_t;                                                            \
+    ser_struct_t * const  p_ser_struct = (ser_struct_t *)(P_STRUCT);                               \
+    uint8_t const * const p_ser_buf    = (P_BUF);                                                  \
+    uint32_t const        ser_buf_len  = (BUF_LEN);                                                \
+    uint32_t * const      p_ser_index  = (P_INDEX);                                                \
+    uint32_t              ser_index;                                                               \
+    uint32_t              ser_len      = 0;                                                        \
+                                                                                                   \
+    SER_ASSERT_NOT_NULL(p_ser_buf);                                                                \
+    SER_ASSERT_NOT_NULL(p_ser_index);                                                              \
+    SER_ASSERT_NOT_NULL(p_ser_struct);                                                             \
+                                                                                                   \
+    FIELDS(SER_RUN_LEN, SER_COND_LEN, SER_LEN16DATA_DEC_LEN)                                       \
+    SER_ASSERT_LENGTH_LEQ(ser_len, ((int32_t)ser_buf_len - *p_ser_index));                         \
+                                                                                                   \
+    ser_index = *p_ser_index;                                                                      \
+    FIELDS(SER_RUN_DEC, SER_COND_DEC, SER_LEN16DATA_DEC)                                           \
+    *p_ser_index = ser_index;                                                                      \
+                                                                                                   \
+    return NRF_SUCCESS
+
 
 #endif
 
@@ -53,6 +53,16 @@
     #define SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE         SER_HAL_TRANSPORT_CONN_TO_APP_MAX_PKT_SIZE
 #endif /* SER_CONNECTIVITY */
 
+/** Number of RX and TX packet buffers in serialization HAL Transport layer, 1 to 254. With more
+ *  than one RX buffer a packet can be received while the previous one is being processed, with
+ *  more than one TX buffer packets can be queued for transmission back to back. */
+#ifndef SER_HAL_TRANSPORT_RX_BUF_COUNT
+#define SER_HAL_TRANSPORT_RX_BUF_COUNT                1
+#endif
+#ifndef SER_HAL_TRANSPORT_TX_BUF_COUNT
+#define SER_HAL_TRANSPORT_TX_BUF_COUNT                1
+#endif
+
 
 /***********************************************************************************************//**
  * SER_PHY layer configuration.
@@ -63,6 +73,22 @@
 /** Max transfer unit for SPI MASTER and SPI SLAVE. */
 #define SER_PHY_SPI_MTU_SIZE            255
 
+/** Max number of unacknowledged HCI packets, 1 to 7. 1 is stop-and-wait. With HCI_LINK_CONTROL the
+ *  smaller of the two sides' values is used, otherwise both sides must use the same value. */
+#ifndef SER_PHY_HCI_WINDOW_SIZE
+#define SER_PHY_HCI_WINDOW_SIZE         1
+#endif
+
+/** UART FIFO sizes used when SER_PHY_HCI_SLIP_BLOCK is defined, powers of two. In that mode the HCI
+ *  SLIP layer encodes and decodes whole spans of the UART FIFOs (link app_uart_fifo.c and slip.c
+ *  instead of app_uart.c). Without it every byte is handled in its own UART event. */
+#ifndef SER_PHY_HCI_SLIP_UART_RX_BUF_SIZE
+#define SER_PHY_HCI_SLIP_UART_RX_BUF_SIZE   64
+#endif
+#ifndef SER_PHY_HCI_SLIP_UART_TX_BUF_SIZE
+#define SER_PHY_HCI_SLIP_UART_TX_BUF_SIZE   256
+#endif
+
 /** UART transmission parameters */
 #define SER_PHY_UART_FLOW_CTRL          APP_UART_FLOW_CONTROL_ENABLED
 #define SER_PHY_UART_PARITY             true
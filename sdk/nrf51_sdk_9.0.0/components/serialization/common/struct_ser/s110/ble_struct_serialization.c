@@ -20,21 +20,15 @@
 #include <string.h>
 
 
+#define UUID_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(uuid, type)
+
 uint32_t ble_uuid_t_enc(void const * const p_void_uuid,
                         uint8_t * const    p_buf,
                         uint32_t           buf_len,
                         uint32_t * const   p_index)
 {
-    ble_uuid_t * p_uuid   = (ble_uuid_t *)p_void_uuid;
-    uint32_t     err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&p_uuid->uuid, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint8_t_enc(&p_uuid->type, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_uuid_t, UUID_FIELDS, p_void_uuid, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_uuid_t_dec(uint8_t const * const p_buf,
@@ -42,13 +36,7 @@ uint32_t ble_uuid_t_dec(uint8_t const * const p_buf,
                         uint32_t * const      p_index,
                         void * const          p_void_uuid)
 {
-    ble_uuid_t * p_uuid = (ble_uuid_t *)p_void_uuid;
-
-    SER_ASSERT_LENGTH_LEQ(3, buf_len - *p_index);
-    uint16_dec(p_buf, buf_len, p_index, &p_uuid->uuid);
-    uint8_dec(p_buf, buf_len, p_index, &p_uuid->type);
-
-    return NRF_SUCCESS;
+    SER_STRUCT_DEC(ble_uuid_t, UUID_FIELDS, p_buf, buf_len, p_index, p_void_uuid);
 }
 
 uint32_t ble_uuid128_t_enc(void const * const p_void_uuid,
@@ -85,25 +73,15 @@ uint32_t ble_uuid128_t_dec(uint8_t const * const p_buf,
     return err_code;
 }
 
+#define L2CAP_HEADER_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(len, cid)
+
 uint32_t ble_l2cap_header_t_enc(void const * const p_void_header,
                                 uint8_t * const    p_buf,
                                 uint32_t           buf_len,
                                 uint32_t * const   p_index)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-    SER_ASSERT_NOT_NULL(p_void_header);
-
-    ble_l2cap_header_t * p_header = (ble_l2cap_header_t *)p_void_header;
-    uint32_t             err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&(p_header->len), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&(p_header->cid), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_l2cap_header_t, L2CAP_HEADER_FIELDS, p_void_header, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_l2cap_header_t_dec(uint8_t const * const p_buf,
@@ -111,20 +89,7 @@ uint32_t ble_l2cap_header_t_dec(uint8_t const * const p_buf,
                                 uint32_t * const      p_index,
                                 void * const          p_void_header)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-    SER_ASSERT_NOT_NULL(p_void_header);
-
-    ble_l2cap_header_t * p_header = (ble_l2cap_header_t *)p_void_header;
-    uint32_t             err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_header->len));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_header->cid));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_DEC(ble_l2cap_header_t, L2CAP_HEADER_FIELDS, p_buf, buf_len, p_index, p_void_header);
 }
 
 uint32_t ble_l2cap_evt_rx_t_enc(void const * const p_void_evt_rx,
@@ -116,24 +116,17 @@ uint32_t ble_gap_sec_levels_dec(uint8_t const * const p_buf,
 }
 
 
+#define SEC_KEYS_FIELDS(RUN, COND, LEN16DATA)                      \
+    COND(p_enc_key, ble_gap_enc_key_t_enc, ble_gap_enc_key_t_dec)  \
+    COND(p_id_key, ble_gap_id_key_t_enc, ble_gap_id_key_t_dec)     \
+    COND(p_sign_key, ble_gap_sign_info_enc, ble_gap_sign_info_dec)
+
 uint32_t ble_gap_sec_keys_enc(void const * const p_data,
                               uint8_t * const    p_buf,
                               uint32_t           buf_len,
                               uint32_t * const   p_index)
 {
-    ble_gap_sec_keys_t * p_sec_keys = (ble_gap_sec_keys_t *)p_data;
-    uint32_t err_code = NRF_SUCCESS;
-
-    err_code = cond_field_enc(p_sec_keys->p_enc_key, p_buf, buf_len, p_index, ble_gap_enc_key_t_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_enc(p_sec_keys->p_id_key, p_buf, buf_len, p_index, ble_gap_id_key_t_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_enc(p_sec_keys->p_sign_key, p_buf, buf_len, p_index, ble_gap_sign_info_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gap_sec_keys_t, SEC_KEYS_FIELDS, p_data, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gap_sec_keys_dec(uint8_t const * const p_buf,
@@ -141,19 +134,7 @@ uint32_t ble_gap_sec_keys_dec(uint8_t const * const p_buf,
                               uint32_t * const      p_index,
                               void * const          p_data)
 {
-    ble_gap_sec_keys_t * p_sec_keys = (ble_gap_sec_keys_t *)p_data;
-    uint32_t err_code = NRF_SUCCESS;
-
-    err_code = cond_field_dec(p_buf, buf_len, p_index, (void * *)&(p_sec_keys->p_enc_key), ble_gap_enc_key_t_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf, buf_len, p_index, (void * *)&(p_sec_keys->p_id_key), ble_gap_id_key_t_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf, buf_len, p_index, (void * *)&(p_sec_keys->p_sign_key), ble_gap_sign_info_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gap_sec_keys_t, SEC_KEYS_FIELDS, p_buf, buf_len, p_index, p_data);
 }
 
 uint32_t ble_gap_enc_info_enc(void const * const p_data,
@@ -620,27 +601,16 @@ uint32_t ble_gap_evt_conn_param_update_request_t_dec(uint8_t const * const p_buf
     return ble_gap_conn_params_t_dec(p_buf, buf_len, p_index, p_void_evt_conn_param_update_request);
 }
 
+#define CONN_PARAMS_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(min_conn_interval, conn_sup_timeout)
+
 uint32_t ble_gap_conn_params_t_enc(void const * const p_void_conn_params,
                                    uint8_t * const    p_buf,
                                    uint32_t           buf_len,
                                    uint32_t * const   p_index)
 {
-    ble_gap_conn_params_t * p_conn_params = (ble_gap_conn_params_t *)p_void_conn_params;
-    uint32_t                err_code      = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&p_conn_params->min_conn_interval, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_conn_params->max_conn_interval, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_conn_params->slave_latency, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_conn_params->conn_sup_timeout, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gap_conn_params_t, CONN_PARAMS_FIELDS,
+                   p_void_conn_params, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gap_conn_params_t_dec(uint8_t const * const p_buf,
@@ -648,21 +618,8 @@ uint32_t ble_gap_conn_params_t_dec(uint8_t const * const p_buf,
                                    uint32_t * const      p_index,
                                    void * const          p_void_conn_params)
 {
-    ble_gap_conn_params_t * p_conn_params = (ble_gap_conn_params_t *)p_void_conn_params;
-
-    SER_ASSERT_LENGTH_LEQ(*p_index + 2, buf_len);
-    uint16_dec(p_buf, buf_len, p_index, &p_conn_params->min_conn_interval);
-
-    SER_ASSERT_LENGTH_LEQ(*p_index + 2, buf_len);
-    uint16_dec(p_buf, buf_len, p_index, &p_conn_params->max_conn_interval);
-
-    SER_ASSERT_LENGTH_LEQ(*p_index + 2, buf_len);
-    uint16_dec(p_buf, buf_len, p_index, &p_conn_params->slave_latency);
-
-    SER_ASSERT_LENGTH_LEQ(*p_index + 2, buf_len);
-    uint16_dec(p_buf, buf_len, p_index, &p_conn_params->conn_sup_timeout);
-
-    return NRF_SUCCESS;
+    SER_STRUCT_DEC(ble_gap_conn_params_t, CONN_PARAMS_FIELDS,
+                   p_buf, buf_len, p_index, p_void_conn_params);
 }
 
 uint32_t ble_gap_evt_disconnected_t_enc(void const * const p_void_disconnected,
@@ -693,21 +650,15 @@ uint32_t ble_gap_evt_disconnected_t_dec(uint8_t const * const p_buf,
     return err_code;
 }
 
+#define MASTER_ID_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(ediv, rand)
+
 uint32_t ble_gap_master_id_t_enc(void const * const p_master_idx,
                                  uint8_t * const    p_buf,
                                  uint32_t           buf_len,
                                  uint32_t * const   p_index)
 {
-    ble_gap_master_id_t * p_master_id = (ble_gap_master_id_t *) p_master_idx;
-    uint32_t err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&(p_master_id->ediv), p_buf, buf_len, p_index);
-
-    SER_ASSERT_LENGTH_LEQ(BLE_GAP_SEC_RAND_LEN, buf_len - *p_index);
-    memcpy(&p_buf[*p_index], p_master_id->rand, BLE_GAP_SEC_RAND_LEN);
-    *p_index += BLE_GAP_SEC_RAND_LEN;
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gap_master_id_t, MASTER_ID_FIELDS, p_master_idx, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gap_master_id_t_dec(uint8_t const * const p_buf,
@@ -715,18 +666,7 @@ uint32_t ble_gap_master_id_t_dec(uint8_t const * const p_buf,
                                uint32_t      * const p_index,
                                void          * const p_master_idx)
 {
-    ble_gap_master_id_t *p_master_id = (ble_gap_master_id_t *)p_master_idx;
-
-    uint32_t err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_master_id->ediv));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    SER_ASSERT_LENGTH_LEQ(BLE_GAP_SEC_RAND_LEN, buf_len - *p_index);
-    memcpy(p_master_id->rand, &p_buf[*p_index], BLE_GAP_SEC_RAND_LEN);
-    *p_index += BLE_GAP_SEC_RAND_LEN;
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gap_master_id_t, MASTER_ID_FIELDS, p_buf, buf_len, p_index, p_master_idx);
 }
 
 uint32_t ble_gap_whitelist_t_enc(void const * const p_data,
@@ -1065,26 +1005,15 @@ uint32_t ble_gap_sec_kdist_t_dec(uint8_t const * const p_buf,
     return err_code;
 }
 
+#define OPT_CH_MAP_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(conn_handle, ch_map)
+
 uint32_t ble_gap_opt_ch_map_t_enc(void const * const p_data,
                                   uint8_t * const    p_buf,
                                   uint32_t           buf_len,
                                   uint32_t * const   p_index)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-    
-    ble_gap_opt_ch_map_t * p_gap_opt_ch_map = (ble_gap_opt_ch_map_t *)p_data;
-    uint32_t err_code = NRF_SUCCESS;
-    
-    err_code = uint16_t_enc(&p_gap_opt_ch_map->conn_handle, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    SER_ASSERT_LENGTH_LEQ(5, buf_len - *p_index);
-    memcpy(&p_buf[*p_index], p_gap_opt_ch_map->ch_map, 5);
-
-    *p_index += 5;
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gap_opt_ch_map_t, OPT_CH_MAP_FIELDS, p_data, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gap_opt_ch_map_t_dec(uint8_t const * const p_buf,
@@ -1092,45 +1021,20 @@ uint32_t ble_gap_opt_ch_map_t_dec(uint8_t const * const p_buf,
                                   uint32_t * const      p_index,
                                   void * const          p_data)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-    
-    ble_gap_opt_ch_map_t * p_gap_opt_ch_map = (ble_gap_opt_ch_map_t *)p_data;
-    uint32_t err_code = NRF_SUCCESS;
-    
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &p_gap_opt_ch_map->conn_handle);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-    
-    SER_ASSERT_LENGTH_LEQ(5, buf_len - *p_index);
-    memcpy(p_gap_opt_ch_map->ch_map, &p_buf[*p_index], 5);
-
-    *p_index += 5;
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gap_opt_ch_map_t, OPT_CH_MAP_FIELDS, p_buf, buf_len, p_index, p_data);
 }
 
+#define OPT_LOCAL_CONN_LATENCY_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(conn_handle, requested_latency)                     \
+    COND(p_actual_latency, uint16_t_enc, uint16_t_dec)
+
 uint32_t ble_gap_opt_local_conn_latency_t_enc(void const * const p_void_local_conn_latency,
                                               uint8_t * const    p_buf,
                                               uint32_t           buf_len,
                                               uint32_t * const   p_index)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-
-    ble_gap_opt_local_conn_latency_t * p_latency =
-        (ble_gap_opt_local_conn_latency_t *)p_void_local_conn_latency;
-    uint32_t err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&(p_latency->conn_handle), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&(p_latency->requested_latency), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_enc(p_latency->p_actual_latency, p_buf, buf_len, p_index, uint16_t_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gap_opt_local_conn_latency_t, OPT_LOCAL_CONN_LATENCY_FIELDS,
+                   p_void_local_conn_latency, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gap_opt_local_conn_latency_t_dec(uint8_t const * const p_buf,
@@ -1138,24 +1042,8 @@ uint32_t ble_gap_opt_local_conn_latency_t_dec(uint8_t const * const p_buf,
                                               uint32_t * const      p_index,
                                               void * const          p_void_local_conn_latency)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-
-    ble_gap_opt_local_conn_latency_t * p_latency =
-        (ble_gap_opt_local_conn_latency_t *)p_void_local_conn_latency;
-    uint32_t err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_latency->conn_handle));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_latency->requested_latency));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf, buf_len, p_index, (void **) &(p_latency->p_actual_latency),
-                              uint16_t_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gap_opt_local_conn_latency_t, OPT_LOCAL_CONN_LATENCY_FIELDS,
+                   p_buf, buf_len, p_index, p_void_local_conn_latency);
 }
 
 uint32_t ble_gap_opt_passkey_t_enc(void const * const p_void_passkey,
@@ -1195,24 +1083,17 @@ uint32_t ble_gap_opt_passkey_t_dec(uint8_t const * const p_buf,
     return err_code;
 }
 
+#define OPT_PRIVACY_FIELDS(RUN, COND, LEN16DATA)  \
+    COND(p_irk, ble_gap_irk_enc, ble_gap_irk_dec) \
+    RUN(interval_s, interval_s)
+
 uint32_t ble_gap_opt_privacy_t_enc(void const * const p_void_privacy,
                                    uint8_t * const    p_buf,
                                    uint32_t           buf_len,
                                    uint32_t * const   p_index)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-
-    ble_gap_opt_privacy_t * p_privacy = (ble_gap_opt_privacy_t *)p_void_privacy;
-    uint32_t                 err_code = NRF_SUCCESS;
-
-    err_code = cond_field_enc(p_privacy->p_irk, p_buf, buf_len, p_index, ble_gap_irk_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&(p_privacy->interval_s), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gap_opt_privacy_t, OPT_PRIVACY_FIELDS,
+                   p_void_privacy, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gap_opt_privacy_t_dec(uint8_t const * const p_buf,
@@ -1220,19 +1101,8 @@ uint32_t ble_gap_opt_privacy_t_dec(uint8_t const * const p_buf,
                                    uint32_t * const      p_index,
                                    void * const          p_void_privacy)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-
-    ble_gap_opt_privacy_t * p_privacy = (ble_gap_opt_privacy_t *)p_void_privacy;
-    uint32_t                 err_code = NRF_SUCCESS;
-
-    err_code = cond_field_dec(p_buf, buf_len, p_index, (void **) &(p_privacy->p_irk), ble_gap_irk_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_privacy->interval_s));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gap_opt_privacy_t, OPT_PRIVACY_FIELDS,
+                   p_buf, buf_len, p_index, p_void_privacy);
 }
 
 uint32_t ble_gap_opt_scan_req_report_t_enc(void const * const p_void_scan_req_report,
@@ -151,21 +151,16 @@ uint32_t ble_gattc_evt_char_vals_read_rsp_t_dec(uint8_t const * const p_buf,
     return error_code;
 }
 
+#define HANDLE_RANGE_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(start_handle, end_handle)
+
 uint32_t ble_gattc_handle_range_t_enc(void const * const p_void_struct,
                                       uint8_t * const    p_buf,
                                       uint32_t           buf_len,
                                       uint32_t * const   p_index)
 {
-    ble_gattc_handle_range_t * p_range  = (ble_gattc_handle_range_t *) p_void_struct;
-    uint32_t                   err_code = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&(p_range->start_handle), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&(p_range->end_handle), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gattc_handle_range_t, HANDLE_RANGE_FIELDS,
+                   p_void_struct, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gattc_handle_range_t_dec(uint8_t const * const p_buf,
@@ -173,14 +168,8 @@ uint32_t ble_gattc_handle_range_t_dec(uint8_t const * const p_buf,
                                       uint32_t * const      p_index,
                                       void * const          p_void_struct)
 {
-    ble_gattc_handle_range_t * p_range  = (ble_gattc_handle_range_t *) p_void_struct;
-    uint32_t                   err_code = NRF_SUCCESS;
-
-    SER_ASSERT_LENGTH_LEQ(4, buf_len - *p_index);
-    uint16_dec(p_buf, buf_len, p_index, &(p_range->start_handle));
-    uint16_dec(p_buf, buf_len, p_index, &(p_range->end_handle));
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gattc_handle_range_t, HANDLE_RANGE_FIELDS,
+                   p_buf, buf_len, p_index, p_void_struct);
 }
 
 
@@ -300,35 +289,17 @@ uint32_t ble_gattc_evt_rel_disc_rsp_t_dec(uint8_t const * const p_buf,
     return error_code;
 }
 
+#define WRITE_PARAMS_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(write_op, offset)                         \
+    LEN16DATA(p_value, len, UINT16_MAX)
+
 uint32_t ble_gattc_write_params_t_enc(void const * const p_void_write,
                                       uint8_t * const    p_buf,
                                       uint32_t           buf_len,
                                       uint32_t * const   p_index)
 {
-    SER_ASSERT_NOT_NULL(p_void_write);
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-
-    uint32_t err_code = NRF_SUCCESS;
-
-    ble_gattc_write_params_t * p_write = (ble_gattc_write_params_t *)p_void_write;
-
-    err_code = uint8_t_enc(&(p_write->write_op), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint8_t_enc(&(p_write->flags), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&(p_write->handle), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&(p_write->offset), p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = len16data_enc(p_write->p_value, p_write->len, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gattc_write_params_t, WRITE_PARAMS_FIELDS,
+                   p_void_write, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gattc_write_params_t_dec(uint8_t const * const p_buf,
@@ -336,28 +307,6 @@ uint32_t ble_gattc_write_params_t_dec(uint8_t const * const p_buf,
                                       uint32_t * const      p_index,
                                       void * const          p_void_write)
 {
-    SER_ASSERT_NOT_NULL(p_buf);
-    SER_ASSERT_NOT_NULL(p_index);
-    SER_ASSERT_NOT_NULL(p_void_write);
-
-    uint32_t err_code = NRF_SUCCESS;
-
-    ble_gattc_write_params_t * p_write = (ble_gattc_write_params_t *)p_void_write;
-
-    err_code = uint8_t_dec(p_buf, buf_len, p_index, &(p_write->write_op));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint8_t_dec(p_buf, buf_len, p_index, &(p_write->flags));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_write->handle));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_dec(p_buf, buf_len, p_index, &(p_write->offset));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = len16data_dec(p_buf, buf_len, p_index, &(p_write->p_value), &(p_write->len));
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gattc_write_params_t, WRITE_PARAMS_FIELDS,
+                   p_buf, buf_len, p_index, p_void_write);
 }
@@ -19,22 +19,16 @@
 #include "cond_field_serialization.h"
 #include <string.h>
 
+#define CHAR_PF_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(format, name_space)                  \
+    RUN(desc, desc)
+
 uint32_t ser_ble_gatts_char_pf_dec(uint8_t const * const p_buf,
                                    uint32_t              buf_len,
                                    uint32_t * const      p_index,
                                    void * const          p_void_char_pf)
 {
-    ble_gatts_char_pf_t * p_char_pf = (ble_gatts_char_pf_t *)p_void_char_pf;
-
-    SER_ASSERT_LENGTH_LEQ(7, buf_len - *p_index);
-
-    uint8_dec(p_buf, buf_len, p_index, &p_char_pf->format);
-    uint8_dec(p_buf, buf_len, p_index, (uint8_t *)&p_char_pf->exponent);
-    uint16_dec(p_buf, buf_len, p_index, &p_char_pf->unit);
-    uint8_dec(p_buf, buf_len, p_index, &p_char_pf->name_space);
-    uint16_dec(p_buf, buf_len, p_index, &p_char_pf->desc);
-
-    return NRF_SUCCESS;
+    SER_STRUCT_DEC(ble_gatts_char_pf_t, CHAR_PF_FIELDS, p_buf, buf_len, p_index, p_void_char_pf);
 }
 
 uint32_t ser_ble_gatts_char_pf_enc(void const * const p_void_char_pf,
@@ -42,25 +36,7 @@ uint32_t ser_ble_gatts_char_pf_enc(void const * const p_void_char_pf,
                                    uint32_t           buf_len,
                                    uint32_t * const   p_index)
 {
-    ble_gatts_char_pf_t * p_char_pf = (ble_gatts_char_pf_t *)p_void_char_pf;
-    uint32_t              err_code  = NRF_SUCCESS;
-
-    err_code = uint8_t_enc(&p_char_pf->format, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint8_t_enc(&p_char_pf->exponent, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_char_pf->unit, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint8_t_enc(&p_char_pf->name_space, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_char_pf->desc, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gatts_char_pf_t, CHAR_PF_FIELDS, p_void_char_pf, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gatts_attr_md_enc(void const * const p_void_attr_md,
@@ -122,63 +98,38 @@ uint32_t ble_gatts_attr_md_dec(uint8_t const * const p_buf,
     return err_code;
 }
 
+// The properties are bit-fields and are packed by hand, the schema starts after them.
+#define CHAR_MD_FIELDS(RUN, COND, LEN16DATA)                                     \
+    RUN(char_user_desc_max_size, char_user_desc_max_size)                        \
+    LEN16DATA(p_char_user_desc, char_user_desc_size, BLE_GATTS_VAR_ATTR_LEN_MAX) \
+    COND(p_char_pf, ser_ble_gatts_char_pf_enc, ser_ble_gatts_char_pf_dec)        \
+    COND(p_user_desc_md, ble_gatts_attr_md_enc, ble_gatts_attr_md_dec)           \
+    COND(p_cccd_md, ble_gatts_attr_md_enc, ble_gatts_attr_md_dec)                \
+    COND(p_sccd_md, ble_gatts_attr_md_enc, ble_gatts_attr_md_dec)
+
 uint32_t ble_gatts_char_md_enc(void const * const p_void_char_md,
                                uint8_t * const    p_buf,
                                uint32_t           buf_len,
                                uint32_t * const   p_index)
 {
-    uint32_t err_code = NRF_SUCCESS;
-
     ble_gatts_char_md_t * p_char_md = (ble_gatts_char_md_t *)p_void_char_md;
-    uint8_t               temp8;
 
-    temp8 = p_char_md->char_props.broadcast |
-            (p_char_md->char_props.read << 1) |
-            (p_char_md->char_props.write_wo_resp << 2) |
-            (p_char_md->char_props.write << 3) |
-            (p_char_md->char_props.notify << 4) |
-            (p_char_md->char_props.indicate << 5) |
-            (p_char_md->char_props.auth_signed_wr << 6);
-
-    err_code = uint8_t_enc(&temp8, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    temp8 = p_char_md->char_ext_props.reliable_wr |
-            (p_char_md->char_ext_props.wr_aux << 1);
-
-    err_code = uint8_t_enc(&temp8, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_char_md->char_user_desc_max_size, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    SER_ERROR_CHECK(p_char_md->char_user_desc_size <= BLE_GATTS_VAR_ATTR_LEN_MAX,
-                    NRF_ERROR_INVALID_PARAM);
-    err_code = len16data_enc(p_char_md->p_char_user_desc, p_char_md->char_user_desc_size, p_buf,
-                             buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_enc(p_char_md->p_char_pf,
-                              p_buf,
-                              buf_len,
-                              p_index,
-                              ser_ble_gatts_char_pf_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_enc(p_char_md->p_user_desc_md,
-                              p_buf,
-                              buf_len,
-                              p_index,
-                              ble_gatts_attr_md_enc);
-    SER_ERROR_CHECK(err_code == NRF_SUCCESS, err_code);
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_index);
+    SER_ASSERT_LENGTH_LEQ(2, ((int32_t)buf_len - *p_index));
 
-    err_code = cond_field_enc(p_char_md->p_cccd_md, p_buf, buf_len, p_index, ble_gatts_attr_md_enc);
-    SER_ERROR_CHECK(err_code == NRF_SUCCESS, err_code);
+    p_buf[(*p_index)++] = p_char_md->char_props.broadcast |
+                          (p_char_md->char_props.read << 1) |
+                          (p_char_md->char_props.write_wo_resp << 2) |
+                          (p_char_md->char_props.write << 3) |
+                          (p_char_md->char_props.notify << 4) |
+                          (p_char_md->char_props.indicate << 5) |
+                          (p_char_md->char_props.auth_signed_wr << 6);
 
-    err_code = cond_field_enc(p_char_md->p_sccd_md, p_buf, buf_len, p_index, ble_gatts_attr_md_enc);
-    SER_ERROR_CHECK(err_code == NRF_SUCCESS, err_code);
+    p_buf[(*p_index)++] = p_char_md->char_ext_props.reliable_wr |
+                          (p_char_md->char_ext_props.wr_aux << 1);
 
-    return err_code;
+    SER_STRUCT_ENC(ble_gatts_char_md_t, CHAR_MD_FIELDS, p_char_md, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gatts_char_md_dec(uint8_t const * const p_buf,
@@ -186,13 +137,14 @@ uint32_t ble_gatts_char_md_dec(uint8_t const * const p_buf,
                                uint32_t * const      p_index,
                                void * const          p_void_char_md)
 {
-    uint32_t err_code = NRF_SUCCESS;
-
     ble_gatts_char_md_t * p_char_md = (ble_gatts_char_md_t *)p_void_char_md;
+    uint8_t               temp8;
 
-    SER_ASSERT_LENGTH_LEQ(2, buf_len - *p_index);
-    uint8_t temp8 = p_buf[*p_index];
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_index);
+    SER_ASSERT_LENGTH_LEQ(2, ((int32_t)buf_len - *p_index));
 
+    temp8 = p_buf[(*p_index)++];
     p_char_md->char_props.broadcast      = temp8 >> 0;
     p_char_md->char_props.read           = temp8 >> 1;
     p_char_md->char_props.write_wo_resp  = temp8 >> 2;
@@ -201,84 +153,26 @@ uint32_t ble_gatts_char_md_dec(uint8_t const * const p_buf,
     p_char_md->char_props.indicate       = temp8 >> 5;
     p_char_md->char_props.auth_signed_wr = temp8 >> 6;
 
-    temp8 = p_buf[*p_index + 1];
+    temp8 = p_buf[(*p_index)++];
     p_char_md->char_ext_props.reliable_wr = temp8 >> 0;
     p_char_md->char_ext_props.wr_aux      = temp8 >> 1;
 
-    *p_index += 2;
-
-    SER_ASSERT_LENGTH_LEQ(2, buf_len - *p_index);
-    uint16_dec(p_buf, buf_len, p_index, &p_char_md->char_user_desc_max_size);
-
-    err_code = len16data_dec(p_buf,
-                             buf_len,
-                             p_index,
-                             &p_char_md->p_char_user_desc,
-                             &p_char_md->char_user_desc_size);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf,
-                              buf_len,
-                              p_index,
-                              (void * *)&p_char_md->p_char_pf,
-                              ser_ble_gatts_char_pf_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf,
-                              buf_len,
-                              p_index,
-                              (void * *)&p_char_md->p_user_desc_md,
-                              ble_gatts_attr_md_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf,
-                              buf_len,
-                              p_index,
-                              (void * *)&p_char_md->p_cccd_md,
-                              ble_gatts_attr_md_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf,
-                              buf_len,
-                              p_index,
-                              (void * *)&p_char_md->p_sccd_md,
-                              ble_gatts_attr_md_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
-
+    SER_STRUCT_DEC(ble_gatts_char_md_t, CHAR_MD_FIELDS, p_buf, buf_len, p_index, p_char_md);
 }
 
+// init_len is sent just before the value, as len16 data.
+#define ATTR_FIELDS(RUN, COND, LEN16DATA)                         \
+    COND(p_uuid, ble_uuid_t_enc, ble_uuid_t_dec)                  \
+    COND(p_attr_md, ble_gatts_attr_md_enc, ble_gatts_attr_md_dec) \
+    RUN(init_offs, max_len)                                       \
+    LEN16DATA(p_value, init_len, BLE_GATTS_VAR_ATTR_LEN_MAX)
+
 uint32_t ble_gatts_attr_enc(void const * const p_void_gatts_attr,
                             uint8_t * const    p_buf,
                             uint32_t           buf_len,
                             uint32_t * const   p_index)
 {
-    uint32_t           err_code     = NRF_SUCCESS;
-    ble_gatts_attr_t * p_gatts_attr = (ble_gatts_attr_t *)p_void_gatts_attr;
-
-    err_code = cond_field_enc((void *)p_gatts_attr->p_uuid, p_buf, buf_len, p_index, ble_uuid_t_enc);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_enc((void *)p_gatts_attr->p_attr_md,
-                              p_buf,
-                              buf_len,
-                              p_index,
-                              ble_gatts_attr_md_enc);
-    SER_ERROR_CHECK(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_gatts_attr->init_offs, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_gatts_attr->max_len, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    SER_ERROR_CHECK(p_gatts_attr->init_len <= BLE_GATTS_VAR_ATTR_LEN_MAX, NRF_ERROR_INVALID_PARAM);
-    //init len move just before p_data to be able to use len16data decoder.
-    err_code = len16data_enc(p_gatts_attr->p_value, p_gatts_attr->init_len, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gatts_attr_t, ATTR_FIELDS, p_void_gatts_attr, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gatts_attr_dec(uint8_t const * const p_buf,
@@ -286,59 +180,19 @@ uint32_t ble_gatts_attr_dec(uint8_t const * const p_buf,
                             uint32_t * const      p_index,
                             void * const          p_void_gatts_attr)
 {
-    uint32_t           err_code     = NRF_SUCCESS;
-    ble_gatts_attr_t * p_gatts_attr = (ble_gatts_attr_t *)p_void_gatts_attr;
-
-    err_code = cond_field_dec(p_buf,
-                              buf_len,
-                              p_index,
-                              (void * *)&p_gatts_attr->p_uuid,
-                              ble_uuid_t_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = cond_field_dec(p_buf,
-                              buf_len,
-                              p_index,
-                              (void * *)&p_gatts_attr->p_attr_md,
-                              ble_gatts_attr_md_dec);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    SER_ASSERT_LENGTH_LEQ(4, buf_len - *p_index);
-    uint16_dec(p_buf, buf_len, p_index, &p_gatts_attr->init_offs);
-    uint16_dec(p_buf, buf_len, p_index, &p_gatts_attr->max_len);
-
-    //init len move just before p_data to be able to use len16data decoder.
-    err_code = len16data_dec(p_buf,
-                             buf_len,
-                             p_index,
-                             &p_gatts_attr->p_value,
-                             &p_gatts_attr->init_len);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_DEC(ble_gatts_attr_t, ATTR_FIELDS, p_buf, buf_len, p_index, p_void_gatts_attr);
 }
 
+#define CHAR_HANDLES_FIELDS(RUN, COND, LEN16DATA) \
+    RUN(value_handle, sccd_handle)
+
 uint32_t ble_gatts_char_handles_enc(void const * const p_void_char_handles,
                                     uint8_t * const    p_buf,
                                     uint32_t           buf_len,
                                     uint32_t * const   p_index)
 {
-    ble_gatts_char_handles_t * p_char_handles = (ble_gatts_char_handles_t *)p_void_char_handles;
-    uint32_t                   err_code       = NRF_SUCCESS;
-
-    err_code = uint16_t_enc(&p_char_handles->value_handle, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_char_handles->user_desc_handle, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_char_handles->cccd_handle, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    err_code = uint16_t_enc(&p_char_handles->sccd_handle, p_buf, buf_len, p_index);
-    SER_ASSERT(err_code == NRF_SUCCESS, err_code);
-
-    return err_code;
+    SER_STRUCT_ENC(ble_gatts_char_handles_t, CHAR_HANDLES_FIELDS,
+                   p_void_char_handles, p_buf, buf_len, p_index);
 }
 
 uint32_t ble_gatts_char_handles_dec(uint8_t const * const p_buf,
@@ -346,15 +200,8 @@ uint32_t ble_gatts_char_handles_dec(uint8_t const * const p_buf,
                                     uint32_t * const      p_index,
                                     void * const          p_void_char_handles)
 {
-    ble_gatts_char_handles_t * p_char_handles = (ble_gatts_char_handles_t *)p_void_char_handles;
-
-    SER_ASSERT_LENGTH_LEQ(8, buf_len - *p_index);
-    uint16_dec(p_buf, buf_len, p_index, &(p_char_handles->value_handle));
-    uint16_dec(p_buf, buf_len, p_index, &p_char_handles->user_desc_handle);
-    uint16_dec(p_buf, buf_len, p_index, &p_char_handles->cccd_handle);
-    uint16_dec(p_buf, buf_len, p_index, &p_char_handles->sccd_handle);
-
-    return NRF_SUCCESS;
+    SER_STRUCT_DEC(ble_gatts_char_handles_t, CHAR_HANDLES_FIELDS,
+                   p_buf, buf_len, p_index, p_void_char_handles);
 }
 
 uint32_t ble_gatts_hvx_params_t_enc(void const * const p_void_hvx_params,
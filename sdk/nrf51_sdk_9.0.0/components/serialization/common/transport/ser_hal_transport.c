@@ -16,9 +16,22 @@
 #include "ser_config.h"
 #include "ser_phy.h"
 #include "ser_hal_transport.h"
+#ifdef SER_HAL_TRANSPORT_STATS
+#include "app_timer.h"
+#endif
+
+#if (SER_HAL_TRANSPORT_RX_BUF_COUNT < 1) || (SER_HAL_TRANSPORT_RX_BUF_COUNT > 254) || \
+    (SER_HAL_TRANSPORT_TX_BUF_COUNT < 1) || (SER_HAL_TRANSPORT_TX_BUF_COUNT > 254)
+#error "SER_HAL_TRANSPORT_RX_BUF_COUNT and SER_HAL_TRANSPORT_TX_BUF_COUNT must be 1 to 254"
+#endif
+
+#define HAL_TRANSP_BUF_INVALID 0xFFu /**< Buffer index meaning no buffer. */
 
 /**
  * @brief States of the RX state machine.
+ *
+ * @note Buffers held by an upper layer are tracked by their reference counts, so receiving can
+ *       continue while any number of them are being processed.
  */
 typedef enum
 {
@@ -26,20 +39,19 @@ typedef enum
     HAL_TRANSP_RX_STATE_IDLE,
     HAL_TRANSP_RX_STATE_RECEIVING,
     HAL_TRANSP_RX_STATE_DROPPING,
-    HAL_TRANSP_RX_STATE_RECEIVED,
-    HAL_TRANSP_RX_STATE_RECEIVED_PENDING_BUF_REQ,
-    HAL_TRANSP_RX_STATE_RECEIVED_DROPPING,
+    HAL_TRANSP_RX_STATE_PENDING_BUF_REQ,
     HAL_TRANSP_RX_STATE_MAX
 }ser_hal_transp_rx_states_t;
 
 /**
- * @brief States of the TX state machine.
+ * @brief States of a TX buffer.
  */
 typedef enum
 {
     HAL_TRANSP_TX_STATE_CLOSED = 0,
     HAL_TRANSP_TX_STATE_IDLE,
     HAL_TRANSP_TX_STATE_TX_ALLOCATED,
+    HAL_TRANSP_TX_STATE_QUEUED,
     HAL_TRANSP_TX_STATE_TRANSMITTING,
     HAL_TRANSP_TX_STATE_TRANSMITTED,
     HAL_TRANSP_TX_STATE_MAX
@@ -50,18 +62,52 @@ typedef enum
  */
 static ser_hal_transp_rx_states_t m_rx_state = HAL_TRANSP_RX_STATE_CLOSED;
 /**
- * @brief TX state.
+ * @brief TX state, HAL_TRANSP_TX_STATE_CLOSED or HAL_TRANSP_TX_STATE_IDLE when opened.
  */
 static ser_hal_transp_tx_states_t m_tx_state = HAL_TRANSP_TX_STATE_CLOSED;
 
 /**
- * @brief Transmission buffer.
+ * @brief Transmission buffers.
+ */
+static uint8_t m_tx_buffer[SER_HAL_TRANSPORT_TX_BUF_COUNT][SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE];
+/**
+ * @brief Reception buffers.
+ */
+static uint8_t m_rx_buffer[SER_HAL_TRANSPORT_RX_BUF_COUNT][SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE];
+
+/**
+ * @brief States of transmission buffers.
+ */
+static ser_hal_transp_tx_states_t m_tx_buf_state[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+/**
+ * @brief Lengths of queued packets.
+ */
+static uint16_t m_tx_buf_length[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+/**
+ * @brief Indexes of queued transmission buffers, oldest first.
  */
-static uint8_t m_tx_buffer[SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE];
+static uint8_t m_tx_queue[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+static uint8_t m_tx_queue_head;
+static uint8_t m_tx_queue_len;
 /**
- * @brief Reception buffer.
+ * @brief Index of the buffer given to the PHY layer for transmission.
  */
-static uint8_t m_rx_buffer[SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE];
+static uint8_t m_tx_current = HAL_TRANSP_BUF_INVALID;
+
+/**
+ * @brief Number of references an upper layer holds to each reception buffer, 0 if it is free.
+ */
+static uint8_t m_rx_ref_count[SER_HAL_TRANSPORT_RX_BUF_COUNT];
+/**
+ * @brief Index of the buffer given to the PHY layer for reception.
+ */
+static uint8_t m_rx_current = HAL_TRANSP_BUF_INVALID;
+
+#ifdef SER_HAL_TRANSPORT_STATS
+static ser_hal_transport_stats_t m_stats;
+static uint32_t                  m_rx_wait_start;
+static uint32_t                  m_tx_queue_time[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+#endif
 
 /**
  * @brief Callback function handler for Serialization HAL Transport layer events.
@@ -69,6 +115,120 @@ static uint8_t m_rx_buffer[SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE];
 static ser_hal_transport_events_handler_t m_events_handler = NULL;
 
 
+#ifdef SER_HAL_TRANSPORT_STATS
+static uint32_t stats_ticks_get(void)
+{
+    uint32_t ticks = 0;
+
+    (void)app_timer_cnt_get(&ticks);
+    return ticks;
+}
+
+
+static uint32_t stats_ticks_since(uint32_t ticks_from)
+{
+    uint32_t ticks = 0;
+
+    (void)app_timer_cnt_diff_compute(stats_ticks_get(), ticks_from, &ticks);
+    return ticks;
+}
+#endif
+
+
+static uint32_t tx_buf_index_get(const uint8_t * p_buffer)
+{
+    uint32_t i;
+
+    for (i = 0; i < SER_HAL_TRANSPORT_TX_BUF_COUNT; i++)
+    {
+        if (p_buffer == m_tx_buffer[i])
+        {
+            return i;
+        }
+    }
+    return HAL_TRANSP_BUF_INVALID;
+}
+
+
+static uint32_t rx_buf_index_get(const uint8_t * p_buffer)
+{
+    uint32_t i;
+
+    for (i = 0; i < SER_HAL_TRANSPORT_RX_BUF_COUNT; i++)
+    {
+        if (p_buffer == m_rx_buffer[i])
+        {
+            return i;
+        }
+    }
+    return HAL_TRANSP_BUF_INVALID;
+}
+
+
+/**
+ * @brief Finds a reception buffer that is neither held by an upper layer nor used by the PHY.
+ */
+static uint32_t rx_buf_free_find(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < SER_HAL_TRANSPORT_RX_BUF_COUNT; i++)
+    {
+        if ((m_rx_ref_count[i] == 0) && (i != m_rx_current))
+        {
+            return i;
+        }
+    }
+    return HAL_TRANSP_BUF_INVALID;
+}
+
+
+/**
+ * @brief Gives the oldest queued packet to the PHY layer if no packet is being transmitted. Must be
+ *        called with PHY interrupts disabled or from PHY event context.
+ */
+static void tx_queue_send(void)
+{
+    uint32_t err_code;
+    uint32_t index;
+
+    if ((HAL_TRANSP_BUF_INVALID == m_tx_current) && (0 != m_tx_queue_len))
+    {
+        index           = m_tx_queue[m_tx_queue_head];
+        m_tx_queue_head = (m_tx_queue_head + 1) % SER_HAL_TRANSPORT_TX_BUF_COUNT;
+        m_tx_queue_len--;
+
+#ifdef SER_HAL_TRANSPORT_STATS
+        m_stats.tx_queue_wait_ticks += stats_ticks_since(m_tx_queue_time[index]);
+#endif
+        /* State is changed first as the PHY may report the packet sent before returning. */
+        m_tx_current          = index;
+        m_tx_buf_state[index] = HAL_TRANSP_TX_STATE_TRANSMITTING;
+        err_code              = ser_phy_tx_pkt_send(m_tx_buffer[index], m_tx_buf_length[index]);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+
+/**
+ * @brief Frees the buffer given to the PHY layer for transmission and starts the next queued one.
+ */
+static void tx_current_release(void)
+{
+    uint32_t err_code;
+    uint32_t index = m_tx_current;
+
+    m_tx_buf_state[index] = HAL_TRANSP_TX_STATE_TRANSMITTED;
+    m_tx_current          = HAL_TRANSP_BUF_INVALID;
+    err_code              = ser_hal_transport_tx_pkt_free(m_tx_buffer[index]);
+    APP_ERROR_CHECK(err_code);
+
+    /* The next packet goes to the PHY before an upper layer is notified, otherwise a packet sent
+     * from the event handler would overtake the queue. */
+    tx_queue_send();
+}
+
+
 /**
  * @brief A callback function to be used to handle a PHY module events. This function is called in
  *        an interrupt context.
@@ -76,6 +236,7 @@ static ser_hal_transport_events_handler_t m_events_handler = NULL;
 static void phy_events_handler(ser_phy_evt_t phy_event)
 {
     uint32_t                err_code = 0;
+    uint32_t                index;
     ser_hal_transport_evt_t hal_transp_event;
 
     memset(&hal_transp_event, 0, sizeof (ser_hal_transport_evt_t));
@@ -85,11 +246,9 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
     {
         case SER_PHY_EVT_TX_PKT_SENT:
         {
-            if (HAL_TRANSP_TX_STATE_TRANSMITTING == m_tx_state)
+            if (HAL_TRANSP_BUF_INVALID != m_tx_current)
             {
-                m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTED;
-                err_code   = ser_hal_transport_tx_pkt_free(m_tx_buffer);
-                APP_ERROR_CHECK(err_code);
+                tx_current_release();
                 /* An event to an upper layer that a packet has been transmitted. */
                 hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_TX_PKT_SENT;
                 m_events_handler(hal_transp_event);
@@ -104,54 +263,46 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
 
         case SER_PHY_EVT_RX_BUF_REQUEST:
         {
+            if (HAL_TRANSP_RX_STATE_IDLE != m_rx_state)
+            {
+                /* Lower layer should not generate this event in current state. */
+                APP_ERROR_CHECK_BOOL(false);
+                break;
+            }
+
             /* An event to an upper layer that a packet is being scheduled to receive or to drop. */
             hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_RX_PKT_RECEIVING;
+            m_events_handler(hal_transp_event);
 
             /* Receive or drop a packet. */
-            if (phy_event.evt_params.rx_buf_request.num_of_bytes <= sizeof (m_rx_buffer))
+            if (phy_event.evt_params.rx_buf_request.num_of_bytes <= SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE)
             {
-                if (HAL_TRANSP_RX_STATE_IDLE == m_rx_state)
+                index = rx_buf_free_find();
+
+                if (HAL_TRANSP_BUF_INVALID != index)
                 {
-                    m_events_handler(hal_transp_event);
-                    err_code = ser_phy_rx_buf_set(m_rx_buffer);
+                    m_rx_current = index;
+                    m_rx_state   = HAL_TRANSP_RX_STATE_RECEIVING;
+                    err_code     = ser_phy_rx_buf_set(m_rx_buffer[index]);
                     APP_ERROR_CHECK(err_code);
-                    m_rx_state = HAL_TRANSP_RX_STATE_RECEIVING;
-                }
-                else if (HAL_TRANSP_RX_STATE_RECEIVED == m_rx_state)
-                {
-                    /* It is OK to get know higher layer at this point that we are going to receive
-                     * a new packet even though we will start receiving when rx buffer is freed. */
-                    m_events_handler(hal_transp_event);
-                    m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED_PENDING_BUF_REQ;
                 }
                 else
                 {
-                    /* Lower layer should not generate this event in current state. */
-                    APP_ERROR_CHECK_BOOL(false);
+                    /* All buffers are held by an upper layer, reception starts when one of them
+                     * is freed. */
+                    m_rx_state = HAL_TRANSP_RX_STATE_PENDING_BUF_REQ;
+#ifdef SER_HAL_TRANSPORT_STATS
+                    m_stats.rx_buf_waits++;
+                    m_rx_wait_start = stats_ticks_get();
+#endif
                 }
             }
             else
             {
                 /* There is not enough memory but packet has to be received to dummy location. */
-                if (HAL_TRANSP_RX_STATE_IDLE == m_rx_state)
-                {
-                    m_events_handler(hal_transp_event);
-                    err_code = ser_phy_rx_buf_set(NULL);
-                    APP_ERROR_CHECK(err_code);
-                    m_rx_state = HAL_TRANSP_RX_STATE_DROPPING;
-                }
-                else if (HAL_TRANSP_RX_STATE_RECEIVED == m_rx_state)
-                {
-                    m_events_handler(hal_transp_event);
-                    err_code = ser_phy_rx_buf_set(NULL);
-                    APP_ERROR_CHECK(err_code);
-                    m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED_DROPPING;
-                }
-                else
-                {
-                    /* Lower layer should not generate this event in current state. */
-                    APP_ERROR_CHECK_BOOL(false);
-                }
+                m_rx_state = HAL_TRANSP_RX_STATE_DROPPING;
+                err_code   = ser_phy_rx_buf_set(NULL);
+                APP_ERROR_CHECK(err_code);
             }
             break;
         }
@@ -160,7 +311,9 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
         {
             if (HAL_TRANSP_RX_STATE_RECEIVING == m_rx_state)
             {
-                m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED;
+                m_rx_ref_count[m_rx_current] = 1;
+                m_rx_current                 = HAL_TRANSP_BUF_INVALID;
+                m_rx_state                   = HAL_TRANSP_RX_STATE_IDLE;
                 /* Generate the event to an upper layer. */
                 hal_transp_event.evt_type =
                     SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED;
@@ -182,17 +335,13 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
         {
             if (HAL_TRANSP_RX_STATE_DROPPING == m_rx_state)
             {
-                /* Generate the event to an upper layer. */
-                hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_RX_PKT_DROPPED;
-                m_events_handler(hal_transp_event);
+#ifdef SER_HAL_TRANSPORT_STATS
+                m_stats.rx_pkt_dropped++;
+#endif
                 m_rx_state = HAL_TRANSP_RX_STATE_IDLE;
-            }
-            else if (HAL_TRANSP_RX_STATE_RECEIVED_DROPPING == m_rx_state)
-            {
                 /* Generate the event to an upper layer. */
                 hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_RX_PKT_DROPPED;
                 m_events_handler(hal_transp_event);
-                m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED;
             }
             else
             {
@@ -230,18 +379,17 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
                 SER_HAL_TRANSP_PHY_ERROR_HW_ERROR;
             hal_transp_event.evt_params.phy_error.hw_error_code =
                 phy_event.evt_params.hw_error.error_code;
-            if (HAL_TRANSP_TX_STATE_TRANSMITTING == m_tx_state)
+            /* The buffer tells which direction failed. */
+            if ((HAL_TRANSP_BUF_INVALID != m_tx_current) &&
+                (phy_event.evt_params.hw_error.p_buffer == m_tx_buffer[m_tx_current]))
             {
-                m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTED;
-                err_code   = ser_hal_transport_tx_pkt_free(phy_event.evt_params.hw_error.p_buffer);
-                APP_ERROR_CHECK(err_code);
-                /* An event to an upper layer that a packet has been transmitted. */
+                tx_current_release();
             }
-            else if (HAL_TRANSP_RX_STATE_RECEIVING == m_rx_state)
+            else if ((HAL_TRANSP_RX_STATE_RECEIVING == m_rx_state) &&
+                     (phy_event.evt_params.hw_error.p_buffer == m_rx_buffer[m_rx_current]))
             {
-                m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED;
-                err_code   = ser_hal_transport_rx_pkt_free(phy_event.evt_params.hw_error.p_buffer);
-                APP_ERROR_CHECK(err_code);
+                m_rx_current = HAL_TRANSP_BUF_INVALID;
+                m_rx_state   = HAL_TRANSP_RX_STATE_IDLE;
             }
             m_events_handler(hal_transp_event);
 
@@ -259,6 +407,7 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
 uint32_t ser_hal_transport_open(ser_hal_transport_events_handler_t events_handler)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t i;
 
     if ((HAL_TRANSP_RX_STATE_CLOSED != m_rx_state) || (HAL_TRANSP_TX_STATE_CLOSED != m_tx_state))
     {
@@ -273,6 +422,19 @@ uint32_t ser_hal_transport_open(ser_hal_transport_events_handler_t events_handle
         /* We have to change states before calling lower layer because ser_phy_open() function is
          * going to enable interrupts. On success an event from PHY layer can be emitted immediately
          * after return from ser_phy_open(). */
+        for (i = 0; i < SER_HAL_TRANSPORT_TX_BUF_COUNT; i++)
+        {
+            m_tx_buf_state[i] = HAL_TRANSP_TX_STATE_IDLE;
+        }
+        memset(m_rx_ref_count, 0, sizeof (m_rx_ref_count));
+        m_tx_queue_head = 0;
+        m_tx_queue_len  = 0;
+        m_tx_current    = HAL_TRANSP_BUF_INVALID;
+        m_rx_current    = HAL_TRANSP_BUF_INVALID;
+#ifdef SER_HAL_TRANSPORT_STATS
+        memset(&m_stats, 0, sizeof (m_stats));
+#endif
+
         m_rx_state = HAL_TRANSP_RX_STATE_IDLE;
         m_tx_state = HAL_TRANSP_TX_STATE_IDLE;
 
@@ -300,57 +462,103 @@ uint32_t ser_hal_transport_open(ser_hal_transport_events_handler_t events_handle
 
 void ser_hal_transport_close(void)
 {
+    uint32_t i;
+
     /* Reset generic handler for all events, reset internal states and close PHY module. */
     ser_phy_interrupts_disable();
     m_rx_state = HAL_TRANSP_RX_STATE_CLOSED;
     m_tx_state = HAL_TRANSP_TX_STATE_CLOSED;
 
+    for (i = 0; i < SER_HAL_TRANSPORT_TX_BUF_COUNT; i++)
+    {
+        m_tx_buf_state[i] = HAL_TRANSP_TX_STATE_CLOSED;
+    }
+
     m_events_handler = NULL;
 
     ser_phy_close();
 }
 
 
-uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer)
+uint32_t ser_hal_transport_rx_pkt_retain(uint8_t * p_buffer)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t index;
 
     ser_phy_interrupts_disable();
 
+    index = rx_buf_index_get(p_buffer);
+
     if (NULL == p_buffer)
     {
         err_code = NRF_ERROR_NULL;
     }
-    else if (p_buffer != m_rx_buffer)
+    else if (HAL_TRANSP_BUF_INVALID == index)
     {
         err_code = NRF_ERROR_INVALID_ADDR;
     }
-    else if (HAL_TRANSP_RX_STATE_RECEIVED == m_rx_state)
+    else if (0 == m_rx_ref_count[index])
     {
-        m_rx_state = HAL_TRANSP_RX_STATE_IDLE;
+        /* Upper layer should not call this function for a buffer it does not hold. */
+        err_code = NRF_ERROR_INVALID_STATE;
     }
-    else if (HAL_TRANSP_RX_STATE_RECEIVED_DROPPING == m_rx_state)
+    else if (UINT8_MAX == m_rx_ref_count[index])
     {
-        m_rx_state = HAL_TRANSP_RX_STATE_DROPPING;
+        err_code = NRF_ERROR_NO_MEM;
     }
-    else if (HAL_TRANSP_RX_STATE_RECEIVED_PENDING_BUF_REQ == m_rx_state)
+    else
     {
-        err_code = ser_phy_rx_buf_set(m_rx_buffer);
+        m_rx_ref_count[index]++;
+    }
+    ser_phy_interrupts_enable();
 
-        if (NRF_SUCCESS == err_code)
-        {
-            m_rx_state = HAL_TRANSP_RX_STATE_RECEIVING;
-        }
-        else
-        {
-            err_code = NRF_ERROR_INTERNAL;
-        }
+    return err_code;
+}
+
+
+uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    uint32_t index;
+
+    ser_phy_interrupts_disable();
+
+    index = rx_buf_index_get(p_buffer);
+
+    if (NULL == p_buffer)
+    {
+        err_code = NRF_ERROR_NULL;
     }
-    else
+    else if (HAL_TRANSP_BUF_INVALID == index)
+    {
+        err_code = NRF_ERROR_INVALID_ADDR;
+    }
+    else if (0 == m_rx_ref_count[index])
     {
         /* Upper layer should not call this function in current state. */
         err_code = NRF_ERROR_INVALID_STATE;
     }
+    else
+    {
+        m_rx_ref_count[index]--;
+
+        if ((0 == m_rx_ref_count[index]) && (HAL_TRANSP_RX_STATE_PENDING_BUF_REQ == m_rx_state))
+        {
+#ifdef SER_HAL_TRANSPORT_STATS
+            m_stats.rx_buf_wait_ticks += stats_ticks_since(m_rx_wait_start);
+#endif
+            m_rx_current = index;
+            m_rx_state   = HAL_TRANSP_RX_STATE_RECEIVING;
+            err_code     = ser_phy_rx_buf_set(m_rx_buffer[index]);
+
+            if (NRF_SUCCESS != err_code)
+            {
+                m_rx_current = HAL_TRANSP_BUF_INVALID;
+                m_rx_state   = HAL_TRANSP_RX_STATE_PENDING_BUF_REQ;
+                err_code     = NRF_ERROR_INTERNAL;
+            }
+        }
+    }
     ser_phy_interrupts_enable();
 
     return err_code;
@@ -360,6 +568,7 @@ uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer)
 uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t * * pp_memory, uint16_t * p_num_of_bytes)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t i;
 
     if ((NULL == pp_memory) || (NULL == p_num_of_bytes))
     {
@@ -369,15 +578,29 @@ uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t * * pp_memory, uint16_t * p_num_
     {
         err_code = NRF_ERROR_INVALID_STATE;
     }
-    else if (HAL_TRANSP_TX_STATE_IDLE == m_tx_state)
-    {
-        m_tx_state      = HAL_TRANSP_TX_STATE_TX_ALLOCATED;
-        *pp_memory      = &m_tx_buffer[0];
-        *p_num_of_bytes = (uint16_t)sizeof (m_tx_buffer);
-    }
     else
     {
-        err_code = NRF_ERROR_NO_MEM;
+        for (i = 0; i < SER_HAL_TRANSPORT_TX_BUF_COUNT; i++)
+        {
+            if (HAL_TRANSP_TX_STATE_IDLE == m_tx_buf_state[i])
+            {
+                break;
+            }
+        }
+
+        if (i < SER_HAL_TRANSPORT_TX_BUF_COUNT)
+        {
+            m_tx_buf_state[i] = HAL_TRANSP_TX_STATE_TX_ALLOCATED;
+            *pp_memory        = &m_tx_buffer[i][0];
+            *p_num_of_bytes   = (uint16_t)sizeof (m_tx_buffer[i]);
+        }
+        else
+        {
+#ifdef SER_HAL_TRANSPORT_STATS
+            m_stats.tx_alloc_failed++;
+#endif
+            err_code = NRF_ERROR_NO_MEM;
+        }
     }
 
     return err_code;
@@ -387,6 +610,7 @@ uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t * * pp_memory, uint16_t * p_num_
 uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of_bytes)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t index    = tx_buf_index_get(p_buffer);
 
     /* The buffer provided to this function must be allocated through ser_hal_transport_tx_alloc()
      * function - this assures correct state and that correct memory buffer is used. */
@@ -398,29 +622,46 @@ uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of
     {
         err_code = NRF_ERROR_INVALID_PARAM;
     }
-    else if (p_buffer != m_tx_buffer)
+    else if (HAL_TRANSP_BUF_INVALID == index)
     {
         err_code = NRF_ERROR_INVALID_ADDR;
     }
-    else if (num_of_bytes > sizeof (m_tx_buffer))
+    else if (num_of_bytes > sizeof (m_tx_buffer[index]))
     {
         err_code = NRF_ERROR_DATA_SIZE;
     }
-    else if (HAL_TRANSP_TX_STATE_TX_ALLOCATED == m_tx_state)
+    else if (HAL_TRANSP_TX_STATE_TX_ALLOCATED == m_tx_buf_state[index])
     {
         ser_phy_interrupts_disable();
-        err_code = ser_phy_tx_pkt_send(p_buffer, num_of_bytes);
 
-        if (NRF_SUCCESS == err_code)
+        if (HAL_TRANSP_BUF_INVALID == m_tx_current)
         {
-            m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTING;
+            m_tx_current          = index;
+            m_tx_buf_state[index] = HAL_TRANSP_TX_STATE_TRANSMITTING;
+            err_code              = ser_phy_tx_pkt_send(p_buffer, num_of_bytes);
+
+            if (NRF_SUCCESS != err_code)
+            {
+                m_tx_current          = HAL_TRANSP_BUF_INVALID;
+                m_tx_buf_state[index] = HAL_TRANSP_TX_STATE_TX_ALLOCATED;
+
+                if (NRF_ERROR_BUSY != err_code)
+                {
+                    err_code = NRF_ERROR_INTERNAL;
+                }
+            }
         }
         else
         {
-            if (NRF_ERROR_BUSY != err_code)
-            {
-                err_code = NRF_ERROR_INTERNAL;
-            }
+            /* Another packet is being transmitted, this one follows when it is done. */
+            m_tx_buf_length[index] = num_of_bytes;
+            m_tx_buf_state[index]  = HAL_TRANSP_TX_STATE_QUEUED;
+            m_tx_queue[(m_tx_queue_head + m_tx_queue_len) % SER_HAL_TRANSPORT_TX_BUF_COUNT] = index;
+            m_tx_queue_len++;
+#ifdef SER_HAL_TRANSPORT_STATS
+            m_stats.tx_pkt_queued++;
+            m_tx_queue_time[index] = stats_ticks_get();
+#endif
         }
         ser_phy_interrupts_enable();
     }
@@ -436,20 +677,21 @@ uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of
 uint32_t ser_hal_transport_tx_pkt_free(uint8_t * p_buffer)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t index    = tx_buf_index_get(p_buffer);
 
     if (NULL == p_buffer)
     {
         err_code = NRF_ERROR_NULL;
     }
-    else if (p_buffer != m_tx_buffer)
+    else if (HAL_TRANSP_BUF_INVALID == index)
     {
         err_code = NRF_ERROR_INVALID_ADDR;
     }
-    else if ((HAL_TRANSP_TX_STATE_TX_ALLOCATED == m_tx_state) ||
-             (HAL_TRANSP_TX_STATE_TRANSMITTED == m_tx_state))
+    else if ((HAL_TRANSP_TX_STATE_TX_ALLOCATED == m_tx_buf_state[index]) ||
+             (HAL_TRANSP_TX_STATE_TRANSMITTED == m_tx_buf_state[index]))
     {
         /* Release TX buffer for use. */
-        m_tx_state = HAL_TRANSP_TX_STATE_IDLE;
+        m_tx_buf_state[index] = HAL_TRANSP_TX_STATE_IDLE;
     }
     else
     {
@@ -458,3 +700,13 @@ uint32_t ser_hal_transport_tx_pkt_free(uint8_t * p_buffer)
 
     return err_code;
 }
+
+
+#ifdef SER_HAL_TRANSPORT_STATS
+void ser_hal_transport_stats_get(ser_hal_transport_stats_t * p_stats)
+{
+    ser_phy_interrupts_disable();
+    *p_stats = m_stats;
+    ser_phy_interrupts_enable();
+}
+#endif
@@ -24,6 +24,11 @@
  *          memory management. In the future it is possible to add more feature to it as: crc,
  *          retransmission etc.
  *
+ *          Packets are stored in pools of SER_HAL_TRANSPORT_RX_BUF_COUNT RX buffers and
+ *          SER_HAL_TRANSPORT_TX_BUF_COUNT TX buffers (see ser_config.h). Reception continues while
+ *          an upper layer holds received packets, as long as a free RX buffer is left. Packets
+ *          sent while another one is being transmitted are queued and transmitted in order.
+ *
  * \n \n
  * \image html ser_hal_transport_rx_state_machine.png "RX state machine"
  * \n \n
@@ -35,6 +40,7 @@
 #define SER_HAL_TRANSPORT_H__
 
 #include <stdint.h>
+#include "ser_config.h"
 
 
 /**@brief Serialization HAL Transport layer event types. */
@@ -101,6 +107,21 @@ typedef struct
 } ser_hal_transport_evt_t;
 
 
+#ifdef SER_HAL_TRANSPORT_STATS
+/**@brief Serialization HAL Transport layer statistics. Times are in app_timer ticks. */
+typedef struct
+{
+    uint32_t rx_pkt_dropped;      /**< Received packets dropped because they were too long. */
+    uint32_t rx_buf_waits;        /**< Number of times reception waited for a free RX buffer. */
+    uint32_t rx_buf_wait_ticks;   /**< Total time reception waited for a free RX buffer. */
+    uint32_t tx_pkt_queued;       /**< Packets queued behind another packet being transmitted. */
+    uint32_t tx_queue_wait_ticks; /**< Total time packets spent in the TX queue. */
+    uint32_t tx_alloc_failed;     /**< Calls to @ref ser_hal_transport_tx_pkt_alloc that found no
+                                       free TX buffer. */
+} ser_hal_transport_stats_t;
+#endif /* SER_HAL_TRANSPORT_STATS */
+
+
 /**@brief A generic callback function type to be used by all Serialization HAL Transport layer
  *        events.
  *
@@ -140,12 +161,34 @@ uint32_t ser_hal_transport_open(ser_hal_transport_events_handler_t events_handle
 void ser_hal_transport_close(void);
 
 
+/**@brief A function for taking an additional reference to a received packet.
+ *
+ * @note A received packet is given to an upper layer with one reference. Every additional reference
+ *       taken by this function must be released by @ref ser_hal_transport_rx_pkt_free, and the
+ *       buffer is reused when the last reference is released. This lets a packet be handed over to
+ *       another module while its receiver still reads it.
+ *
+ * @param[in] p_buffer    A pointer to the beginning of a received packet (has to be the same
+ *                        address as provided in an event of type
+ *                        @ref SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED).
+ *
+ * @retval NRF_SUCCESS              Operation success.
+ * @retval NRF_ERROR_NULL           Operation failure. NULL pointer supplied.
+ * @retval NRF_ERROR_INVALID_ADDR   Operation failure. Not a valid pointer (provided address is not
+ *                                  the starting address of a buffer managed by HAL Transport layer).
+ * @retval NRF_ERROR_INVALID_STATE  Operation failure. The buffer is not held by an upper layer.
+ * @retval NRF_ERROR_NO_MEM         Operation failure. Too many references to the buffer.
+ */
+uint32_t ser_hal_transport_rx_pkt_retain(uint8_t * p_buffer);
+
+
 /**@brief A function for freeing a memory allocated for RX packet.
  *
  * @note The function should be called as a response to an event of type
  *       @ref SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED when received data has beed processed. The function
- *       frees an RX memory pointed by p_buffer. The memory, immediately or at a later time, is
- *       reused by the underlying transport layer.
+ *       releases one reference to an RX memory pointed by p_buffer. When the last reference is
+ *       released the memory, immediately or at a later time, is reused by the underlying transport
+ *       layer.
  *
  * @param[in] p_buffer    A pointer to the beginning of a buffer that has been processed (has to be
  *                        the same address as provided in an event of type
@@ -227,5 +270,17 @@ uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of
 uint32_t ser_hal_transport_tx_pkt_free(uint8_t * p_buffer);
 
 
+#ifdef SER_HAL_TRANSPORT_STATS
+/**@brief A function for reading the HAL Transport layer statistics.
+ *
+ * @note Statistics are cleared by @ref ser_hal_transport_open. Wait times are measured with
+ *       app_timer, so it has to be initialized.
+ *
+ * @param[out] p_stats    A pointer to a structure to which the statistics are copied.
+ */
+void ser_hal_transport_stats_get(ser_hal_transport_stats_t * p_stats);
+#endif /* SER_HAL_TRANSPORT_STATS */
+
+
 #endif /* SER_HAL_TRANSPORT_H__ */
 /** @} */
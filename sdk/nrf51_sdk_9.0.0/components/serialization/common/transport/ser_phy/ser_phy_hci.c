@@ -57,6 +57,8 @@
 #define HCI_PKT_CONFIG      0xFC03u                                                    /**< Link Control Packet: type CONFIG */
 #define HCI_PKT_CONFIG_RSP  0x7B04u                                                    /**< Link Control Packet: type CONFIG RESPONSE */
 #define HCI_CONFIG_FIELD    0x11u                                                      /**< Configuration field of CONFIG and CONFIG_RSP packet */
+#define HCI_CONFIG_WINDOW_MASK 0x07u                                                   /**< Sliding Window Size bits of the configuration field */
+#define HCI_CONFIG_FIELD_LOCAL ((HCI_CONFIG_FIELD & ~HCI_CONFIG_WINDOW_MASK) | SER_PHY_HCI_WINDOW_SIZE) /**< Configuration field sent by this side */
 #define HCI_PKT_SYNC_SIZE   6u                                                         /**< Size of SYNC and SYNC_RSP packet */
 #define HCI_PKT_CONFIG_SIZE 7u                                                         /**< Size of CONFIG and CONFIG_RSP packet */
 #define HCI_LINK_CONTROL_PKT_INVALID 0xFFFFu                                           /**< Size of CONFIG and CONFIG_RSP packet */
@@ -71,6 +73,10 @@
                                                          APP_TIMER_PRESCALER)) /**< Retransmission timeout for application packet in units of timer ticks. */
 #define MAX_RETRY_COUNT                 5                                      /**< Max retransmission retry count for application packets. */
 
+#if (SER_PHY_HCI_WINDOW_SIZE < 1) || (SER_PHY_HCI_WINDOW_SIZE > 7)
+#error "SER_PHY_HCI_WINDOW_SIZE must be between 1 and 7"
+#endif
+
 #if   (defined(HCI_TIMER0))
 #define HCI_TIMER            NRF_TIMER0
 #define HCI_TIMER_IRQn       TIMER0_IRQn
@@ -173,6 +179,26 @@ _static uint32_t m_packet_seq_number; // Sequence number counter of the transmit
 
 _static uint32_t m_tx_retry_count;
 
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+/**@brief A copy of a packet kept in the sliding window until it is acknowledged. */
+typedef struct
+{
+    uint8_t  payload[SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE];
+    uint16_t length;
+} hci_tx_slot_t;
+
+_static hci_tx_slot_t m_tx_slots[SER_PHY_HCI_WINDOW_SIZE];
+_static uint32_t      m_tx_window_size;   // Window size in use, SER_PHY_HCI_WINDOW_SIZE or less if the peer asked for it
+_static uint32_t      m_tx_slot_base;     // Slot of the oldest unacknowledged packet, its SEQ is m_packet_seq_number
+_static uint32_t      m_tx_count;         // Packets in the window
+_static uint32_t      m_tx_next;          // Offset from the base of the next packet to transmit
+_static uint32_t      m_tx_sent;          // Offset from the base of the first packet never transmitted
+_static uint32_t      m_tx_wire_slot;     // Slot being transmitted by SLIP
+_static bool          m_tx_on_wire       = false;
+_static bool          m_tx_timer_running = false;
+_static bool          m_tx_rewound       = false; // Already going back to the base, ignore further NACKs
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
+
 
 // _static uint32_t m_tx_retx_counter = 0;
 // _static uint32_t m_rx_drop_counter = 0;
@@ -205,6 +231,8 @@ _static bool m_buffer_reqested_flag = false;
 _static uint8_t * m_p_rx_buffer = NULL;
 _static uint16_t  m_rx_packet_length;
 _static uint8_t * m_p_rx_packet;
+_static hci_evt_t m_rx_deferred_event;           // Packet received while the previous ACK was sent
+_static bool      m_rx_deferred_flag = false;
 _static uint8_t * m_p_tx_payload = NULL;
 _static uint16_t  m_tx_payload_length;
 
@@ -418,13 +446,15 @@ static __INLINE uint8_t packet_seq_nmbr_extract(const uint8_t * p_buffer)
 
 
 /**@brief Function for constructing 1st byte of the packet header of the packet to be transmitted.
+ *
+ * @param[in] seq_number Sequence number of the packet.
  *
  * @return 1st byte of the packet header of the packet to be transmitted
  */
-static __INLINE uint8_t tx_packet_byte_zero_construct(void)
+static __INLINE uint8_t tx_packet_byte_zero_construct(uint8_t seq_number)
 {
     const uint32_t value = DATA_INTEGRITY_MASK | RELIABLE_PKT_MASK |
-                           (packet_ack_get() << 3u) | packet_seq_get();
+                           (packet_ack_get() << 3u) | seq_number;
 
     return (uint8_t) value;
 }
@@ -585,12 +615,15 @@ static uint16_t link_control_packet_decode(const uint8_t * p_buffer, uint32_t le
         {
             packet_type = HCI_LINK_CONTROL_PKT_INVALID;
         }
-        // Verify configuration field (0x11):
-        // - Sliding Window Size       == 1,
+        // Verify configuration field (0x11 with any window size):
+        // - Sliding Window Size       == 1 to 7,
         // - OOF Flow Control          == 0,
         // - Data Integrity Check Type == 1,
         // - Version Number            == 0
-        if (p_buffer[HCI_PKT_CONFIG_SIZE - 1] != HCI_CONFIG_FIELD)
+        const uint8_t config_field = p_buffer[HCI_PKT_CONFIG_SIZE - 1];
+
+        if (((config_field & ~HCI_CONFIG_WINDOW_MASK) != (HCI_CONFIG_FIELD & ~HCI_CONFIG_WINDOW_MASK)) ||
+            ((config_field & HCI_CONFIG_WINDOW_MASK) == 0))
         {
             packet_type = HCI_LINK_CONTROL_PKT_INVALID;
         }
@@ -815,16 +848,16 @@ static void hci_slip_event_handler(ser_phy_hci_slip_evt_t * p_event)
 }
 
 
-static void hci_pkt_send(void)
+static void hci_pkt_send(uint8_t * p_payload, uint16_t payload_length, uint8_t seq_number)
 {
     uint32_t err_code;
 
-    m_tx_packet_header[0] = tx_packet_byte_zero_construct();
-    uint16_t type_and_length_fields = ((m_tx_payload_length << 4u) | PKT_TYPE_VENDOR_SPECIFIC);
+    m_tx_packet_header[0] = tx_packet_byte_zero_construct(seq_number);
+    uint16_t type_and_length_fields = ((payload_length << 4u) | PKT_TYPE_VENDOR_SPECIFIC);
     (void)uint16_encode(type_and_length_fields, &(m_tx_packet_header[1]));
     m_tx_packet_header[3] = header_checksum_calculate(m_tx_packet_header);
     uint16_t crc = crc16_compute(m_tx_packet_header, PKT_HDR_SIZE, NULL);
-    crc = crc16_compute(m_p_tx_payload, m_tx_payload_length, &crc);
+    crc = crc16_compute(p_payload, payload_length, &crc);
     (void)uint16_encode(crc, m_tx_packet_crc);
 
     ser_phy_hci_pkt_params_t pkt_header;
@@ -833,8 +866,8 @@ static void hci_pkt_send(void)
 
     pkt_header.p_buffer      = m_tx_packet_header;
     pkt_header.num_of_bytes  = PKT_HDR_SIZE;
-    pkt_payload.p_buffer     = m_p_tx_payload;
-    pkt_payload.num_of_bytes = m_tx_payload_length;
+    pkt_payload.p_buffer     = p_payload;
+    pkt_payload.num_of_bytes = payload_length;
     pkt_crc.p_buffer         = m_tx_packet_crc;
     pkt_crc.num_of_bytes     = PKT_CRC_SIZE;
     DEBUG_EVT_SLIP_PACKET_TX(0);
@@ -865,13 +898,13 @@ static void hci_link_control_pkt_send(void)
     {
         link_control_payload_len = HCI_PKT_CONFIG_SIZE - PKT_HDR_SIZE;
         (void)uint16_encode(HCI_PKT_CONFIG, m_tx_link_control_payload);
-        m_tx_link_control_payload[2] = HCI_CONFIG_FIELD;
+        m_tx_link_control_payload[2] = HCI_CONFIG_FIELD_LOCAL;
     }
     else if (m_hci_link_control_next_pkt == HCI_PKT_CONFIG_RSP)
     {
         link_control_payload_len = HCI_PKT_CONFIG_SIZE - PKT_HDR_SIZE;
         (void)uint16_encode(HCI_PKT_CONFIG_RSP, m_tx_link_control_payload);
-        m_tx_link_control_payload[2] = HCI_CONFIG_FIELD;
+        m_tx_link_control_payload[2] = HCI_CONFIG_FIELD_LOCAL;
     }
     uint16_t type_and_length_fields = ((link_control_payload_len << 4u) | PKT_TYPE_LINK_CONTROL);
     (void)uint16_encode(type_and_length_fields, &(m_tx_link_control_header[1]));
@@ -924,6 +957,195 @@ static void hci_process_orphaned_ack(hci_evt_t * p_event)
     return;
 }
 
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+/**@brief Function for dropping all packets in the sliding window.
+ *
+ * @note The SEQ number is kept, as after a single packet failure in stop-and-wait mode.
+ */
+static void hci_tx_window_reset(void)
+{
+    m_tx_slot_base   = (m_tx_slot_base + m_tx_count) % SER_PHY_HCI_WINDOW_SIZE;
+    m_tx_count       = 0;
+    m_tx_next        = 0;
+    m_tx_sent        = 0;
+    m_tx_rewound     = false;
+    m_tx_retry_count = MAX_RETRY_COUNT;
+}
+
+
+/**@brief Function for copying the packet given by ser_phy_tx_pkt_send into the sliding window.
+ *
+ * The upper layer gets its buffer back as soon as the packet is copied, so it can give the next
+ * packet while this one still waits for acknowledgement.
+ */
+static void hci_tx_window_accept(void)
+{
+    if ((m_p_tx_payload != NULL) && (m_tx_count < m_tx_window_size))
+    {
+        const uint32_t slot = (m_tx_slot_base + m_tx_count) % SER_PHY_HCI_WINDOW_SIZE;
+
+        if (m_tx_on_wire && (slot == m_tx_wire_slot))
+        {
+            return; // SLIP still reads this slot, try again when it is done
+        }
+        memcpy(m_tx_slots[slot].payload, m_p_tx_payload, m_tx_payload_length);
+        m_tx_slots[slot].length = m_tx_payload_length;
+        m_tx_count++;
+        m_p_tx_payload = NULL;
+        packet_transmitted_callback();
+    }
+}
+
+
+/**@brief Function for transmitting the next packet of the sliding window, if SLIP is free.
+ */
+static void hci_tx_window_send(void)
+{
+    if (!m_tx_on_wire && (m_tx_next < m_tx_count))
+    {
+        m_tx_wire_slot = (m_tx_slot_base + m_tx_next) % SER_PHY_HCI_WINDOW_SIZE;
+        m_tx_on_wire   = true;
+        if (m_tx_next < m_tx_sent)
+        {
+            DEBUG_HCI_RETX(0);
+        }
+        hci_pkt_send(m_tx_slots[m_tx_wire_slot].payload,
+                     m_tx_slots[m_tx_wire_slot].length,
+                     (uint8_t)((m_packet_seq_number + m_tx_next) & 0x07u));
+        m_tx_next++;
+        if (m_tx_next > m_tx_sent)
+        {
+            m_tx_sent = m_tx_next;
+        }
+    }
+}
+
+
+/**@brief Function for processing a received acknowledgement packet in sliding window mode.
+ *
+ * Acknowledgements are cumulative: the ACK number is the SEQ of the next packet the peer expects,
+ * so every packet before it is released. An ACK that releases nothing is sent by the peer when it
+ * drops a packet out of order, and retransmission restarts at the oldest packet.
+ *
+ * @param[in] p_buffer Pointer to the packet data.
+ */
+static void hci_tx_window_ack_process(const uint8_t * p_buffer)
+{
+    const uint32_t expected_checksum =
+        ((p_buffer[0] + p_buffer[1] + p_buffer[2] + p_buffer[3])) & 0xFFu;
+
+    if (expected_checksum != 0)
+    {
+        return;
+    }
+
+    const uint8_t  ack_number = (p_buffer[0] >> 3u) & 0x07u;
+    const uint32_t acked      = (ack_number - m_packet_seq_number) & 0x07u;
+
+    if (acked == 0)
+    {
+        if ((m_tx_sent != 0) && !m_tx_rewound)
+        {
+            m_tx_next    = 0;
+            m_tx_rewound = true;
+        }
+        return;
+    }
+
+    if (acked > m_tx_sent)
+    {
+        return; // Not sent yet, stale or corrupted ACK
+    }
+
+    m_packet_seq_number = (m_packet_seq_number + acked) & 0x07u;
+    m_tx_slot_base      = (m_tx_slot_base + acked) % SER_PHY_HCI_WINDOW_SIZE;
+    m_tx_count         -= acked;
+    m_tx_sent          -= acked;
+    m_tx_next           = (m_tx_next > acked) ? (m_tx_next - acked) : 0;
+    m_tx_retry_count    = MAX_RETRY_COUNT;
+    m_tx_rewound        = false;
+
+    // Restart the timer for the new oldest packet
+    m_tx_timer_running = (m_tx_sent != 0);
+    hci_timeout_setup(m_tx_timer_running ? 1 : 0);
+}
+
+
+/**@brief Function for processing a retransmission timeout in sliding window mode.
+ */
+static void hci_tx_window_timeout(void)
+{
+    m_tx_timer_running = false;
+
+    if (m_tx_sent == 0)
+    {
+        return;
+    }
+
+    m_tx_retry_count--;
+    // m_tx_retx_counter++; // global retransmissions counter
+    if (m_tx_retry_count)
+    {
+        // Go back to the oldest packet, the peer drops everything after a lost one
+        m_tx_next    = 0;
+        m_tx_rewound = true;
+    }
+    else
+    {
+        hci_tx_window_reset();
+        error_callback();
+        m_p_tx_payload = NULL;
+    }
+}
+
+
+/* main tx fsm, sliding window version */
+static void hci_tx_fsm_event_process(hci_evt_t * p_event)
+{
+    if (m_hci_tx_fsm_state == HCI_TX_STATE_DISABLE)
+    {
+#ifdef HCI_LINK_CONTROL
+        /* This case should not happen if HCI is in ACTIVE mode */
+        if (m_hci_mode == HCI_MODE_ACTIVE)
+        {
+            ser_phy_hci_assert(false);
+        }
+#else
+        ser_phy_hci_assert(false);
+#endif /* HCI_LINK_CONTROL */
+        return;
+    }
+
+    if (p_event->evt_source == HCI_SLIP_EVT)
+    {
+        if (p_event->evt.ser_phy_slip_evt.evt_type == SER_PHY_HCI_SLIP_EVT_PKT_SENT)
+        {
+            m_tx_on_wire = false;
+            if (!m_tx_timer_running)
+            {
+                hci_timeout_setup(1);
+                m_tx_timer_running = true;
+            }
+        }
+        else if (p_event->evt.ser_phy_slip_evt.evt_type == SER_PHY_HCI_SLIP_EVT_PKT_RECEIVED)
+        {
+            hci_tx_window_ack_process(
+                p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
+            hci_release_ack_buffer(p_event);
+        }
+    }
+    else if (p_event->evt_source == HCI_TIMER_EVT)
+    {
+        hci_tx_window_timeout();
+    }
+    // HCI_SER_PHY_TX_REQUEST needs nothing more than the window accepting the packet
+
+    hci_tx_window_accept();
+    hci_tx_window_send();
+}
+
+#else
+
 /* main tx fsm   */
 static void hci_tx_fsm_event_process(hci_evt_t * p_event)
 {
@@ -935,7 +1157,7 @@ static void hci_tx_fsm_event_process(hci_evt_t * p_event)
             if ((p_event->evt_source == HCI_SER_PHY_EVT) &&
                 (p_event->evt.ser_phy_evt.evt_type == HCI_SER_PHY_TX_REQUEST))
             {
-                hci_pkt_send();
+                hci_pkt_send(m_p_tx_payload, m_tx_payload_length, packet_seq_get());
                 hci_timeout_setup(0);
                 m_tx_retry_count   = MAX_RETRY_COUNT;
                 m_hci_tx_fsm_state = HCI_TX_STATE_WAIT_FOR_FIRST_TX_END;
@@ -1002,7 +1224,7 @@ static void hci_tx_fsm_event_process(hci_evt_t * p_event)
                 // m_tx_retx_counter++; // global retransmissions counter
                 if (m_tx_retry_count)
                 {
-                    hci_pkt_send();
+                    hci_pkt_send(m_p_tx_payload, m_tx_payload_length, packet_seq_get());
                     DEBUG_HCI_RETX(0);
                     m_hci_tx_fsm_state = HCI_TX_STATE_WAIT_FOR_ACK_OR_TX_END;
                 }
@@ -1045,6 +1267,7 @@ static void hci_tx_fsm_event_process(hci_evt_t * p_event)
             break;
     }
 }
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
 
 
 static void hci_mem_request(hci_evt_t * p_event)
@@ -1065,6 +1288,68 @@ static void hci_inc_ack()
 }
 
 
+/**@brief Function for handling a received data packet in HCI_RX_STATE_RECEIVE state.
+ *
+ * @param[in] p_event Pointer to the SLIP event of the received packet.
+ */
+static void hci_rx_pkt_process(hci_evt_t * p_event)
+{
+    /* type and crc and check sum are validated by slip handler */
+    uint8_t rx_seq_number = packet_seq_nmbr_extract(
+        p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
+
+    if (packet_ack_get() == rx_seq_number)
+    {
+        hci_mem_request(p_event);
+        m_hci_rx_fsm_state = HCI_RX_STATE_WAIT_FOR_MEM;
+    }
+    else
+    {
+        // m_rx_drop_counter++;
+        m_hci_rx_fsm_state = HCI_RX_STATE_WAIT_FOR_SLIP_NACK_END;
+        (void) ser_phy_hci_slip_rx_buf_free( // and drop a packet
+            p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
+        ack_transmit();                      // send NACK with valid ACK
+    }
+}
+
+
+/**@brief Function for keeping a packet that arrives while an ACK is sent, to be handled after it.
+ *
+ * @details A peer using a sliding window sends packets back to back. Only one packet can be kept,
+ *          as SLIP has a single buffer for data packets.
+ *
+ * @param[in] p_event Pointer to the SLIP event of the received packet.
+ */
+static void hci_rx_pkt_defer(hci_evt_t * p_event)
+{
+    if (!m_rx_deferred_flag)
+    {
+        m_rx_deferred_event = *p_event;
+        m_rx_deferred_flag  = true;
+    }
+    else
+    {
+        (void) ser_phy_hci_slip_rx_buf_free(
+            p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
+    }
+}
+
+
+/**@brief Function for going back to HCI_RX_STATE_RECEIVE state once an ACK is sent.
+ */
+static void hci_rx_receive_resume(void)
+{
+    m_hci_rx_fsm_state = HCI_RX_STATE_RECEIVE;
+
+    if (m_rx_deferred_flag)
+    {
+        m_rx_deferred_flag = false;
+        hci_rx_pkt_process(&m_rx_deferred_event);
+    }
+}
+
+
 static void hci_rx_fsm_event_process(hci_evt_t * p_event)
 {
     switch (m_hci_rx_fsm_state)
@@ -1074,22 +1359,7 @@ static void hci_rx_fsm_event_process(hci_evt_t * p_event)
             if ((p_event->evt_source == HCI_SLIP_EVT) &&
                 (p_event->evt.ser_phy_slip_evt.evt_type == SER_PHY_HCI_SLIP_EVT_PKT_RECEIVED))
             {
-                /* type and crc and check sum are validated by slip handler */
-                uint8_t rx_seq_number = packet_seq_nmbr_extract(
-                    p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
-
-                if (packet_ack_get() == rx_seq_number)
-                {
-                    hci_mem_request(p_event);
-                    m_hci_rx_fsm_state = HCI_RX_STATE_WAIT_FOR_MEM;
-                }
-                else
-                {
-                    // m_rx_drop_counter++;
-                    m_hci_rx_fsm_state = HCI_RX_STATE_WAIT_FOR_SLIP_NACK_END;
-                    (void) ser_phy_hci_slip_rx_buf_free(m_p_rx_packet); // and drop a packet
-                    ack_transmit();                                     // send NACK with valid ACK
-                }
+                hci_rx_pkt_process(p_event);
             }
             break;
 
@@ -1103,8 +1373,8 @@ static void hci_rx_fsm_event_process(hci_evt_t * p_event)
                     memcpy(m_p_rx_buffer,
                            m_p_rx_packet + PKT_HDR_SIZE,
                            m_rx_packet_length - PKT_HDR_SIZE - PKT_CRC_SIZE);
-                    (void) ser_phy_hci_slip_rx_buf_free(m_p_rx_packet);
                 }
+                (void) ser_phy_hci_slip_rx_buf_free(m_p_rx_packet);
                 m_hci_rx_fsm_state = HCI_RX_STATE_WAIT_FOR_SLIP_ACK_END;
                 hci_inc_ack(); // SEQ was valid for good packet, we will send incremented SEQ as ACK
                 ack_transmit();
@@ -1127,12 +1397,12 @@ static void hci_rx_fsm_event_process(hci_evt_t * p_event)
                 {
                     packet_dropped_callback();
                 }
-                m_hci_rx_fsm_state = HCI_RX_STATE_RECEIVE;
+                hci_rx_receive_resume();
             }
             else if ((p_event->evt_source == HCI_SLIP_EVT) &&
                     (p_event->evt.ser_phy_slip_evt.evt_type == SER_PHY_HCI_SLIP_EVT_PKT_RECEIVED))
             {
-                (void) ser_phy_hci_slip_rx_buf_free(p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
+                hci_rx_pkt_defer(p_event);
             }
             break;
 
@@ -1140,11 +1410,12 @@ static void hci_rx_fsm_event_process(hci_evt_t * p_event)
             if ((p_event->evt_source == HCI_SLIP_EVT) &&
                (p_event->evt.ser_phy_slip_evt.evt_type == SER_PHY_HCI_SLIP_EVT_ACK_SENT))
             {
-               m_hci_rx_fsm_state = HCI_RX_STATE_RECEIVE;
+               hci_rx_receive_resume();
             }
-            else
+            else if ((p_event->evt_source == HCI_SLIP_EVT) &&
+                    (p_event->evt.ser_phy_slip_evt.evt_type == SER_PHY_HCI_SLIP_EVT_PKT_RECEIVED))
             {
-               (void) ser_phy_hci_slip_rx_buf_free(p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
+               hci_rx_pkt_defer(p_event);
             }
             break;
 
@@ -1334,7 +1605,41 @@ static void hci_rx_event_handler(hci_evt_t * p_event)
     return;
 }
 
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+/**@brief Function for setting up an empty sliding window.
+ *
+ * @param[in] window_size Number of packets that can be unacknowledged.
+ */
+static void hci_tx_window_init(uint32_t window_size)
+{
+    m_tx_window_size   = window_size;
+    m_tx_slot_base     = 0;
+    m_tx_on_wire       = false;
+    m_tx_timer_running = false;
+    hci_tx_window_reset();
+}
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
+
 #ifdef HCI_LINK_CONTROL
+/**@brief Function for using the window size of a received CONFIG or CONFIG_RSP packet.
+ *
+ * Both sides use the smaller of their window sizes. A peer built for stop-and-wait sends 1.
+ *
+ * @param[in] p_buffer Pointer to the packet data.
+ */
+static void hci_link_control_window_set(const uint8_t * p_buffer)
+{
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+    const uint32_t peer_window_size = p_buffer[HCI_PKT_CONFIG_SIZE - 1] & HCI_CONFIG_WINDOW_MASK;
+
+    m_tx_window_size = (peer_window_size < SER_PHY_HCI_WINDOW_SIZE) ? peer_window_size :
+                                                                   SER_PHY_HCI_WINDOW_SIZE;
+#else
+    (void)p_buffer;
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
+}
+
+
 /* Link control event handler - used only for Link Control packets */
 /* This handler will be called only in 2 cases:
    - when SER_PHY_HCI_SLIP_EVT_PKT_RECEIVED event is received 
@@ -1364,6 +1669,9 @@ static void hci_link_control_event_handler(hci_evt_t * p_event)
                         m_hci_tx_fsm_state  = HCI_TX_STATE_DISABLE;
                         m_hci_rx_fsm_state  = HCI_RX_STATE_DISABLE;
                         m_hci_uther_side_active = false;
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+                        hci_tx_window_init(1);
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
                     }
                     hci_link_control_pkt_send();
                     hci_timeout_setup(7u); // Need to trigger transmitting SYNC messages
@@ -1378,6 +1686,8 @@ static void hci_link_control_event_handler(hci_evt_t * p_event)
                 case HCI_PKT_CONFIG:
                     if (m_hci_mode != HCI_MODE_UNINITIALIZED)
                     {
+                        hci_link_control_window_set(
+                            p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
                         m_hci_link_control_next_pkt = HCI_PKT_CONFIG_RSP;
                         hci_link_control_pkt_send();
                         m_hci_uther_side_active = true;
@@ -1386,6 +1696,8 @@ static void hci_link_control_event_handler(hci_evt_t * p_event)
                 case HCI_PKT_CONFIG_RSP:
                     if (m_hci_mode == HCI_MODE_INITIALIZED)
                     {
+                        hci_link_control_window_set(
+                            p_event->evt.ser_phy_slip_evt.evt_params.received_pkt.p_buffer);
                         m_hci_mode          = HCI_MODE_ACTIVE;
                         m_hci_tx_fsm_state  = HCI_TX_STATE_SEND;
                         m_hci_rx_fsm_state  = HCI_RX_STATE_RECEIVE;                        
@@ -1622,11 +1934,18 @@ uint32_t ser_phy_open(ser_phy_events_handler_t events_handler)
         m_packet_ack_number = INITIAL_ACK_NUMBER_EXPECTED;
         m_packet_seq_number = INITIAL_SEQ_NUMBER;
         m_ser_phy_callback  = events_handler;
+        m_rx_deferred_flag  = false;
 
 #ifndef HCI_LINK_CONTROL
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+        hci_tx_window_init(SER_PHY_HCI_WINDOW_SIZE);
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
         m_hci_tx_fsm_state  = HCI_TX_STATE_SEND;
         m_hci_rx_fsm_state  = HCI_RX_STATE_RECEIVE;
 #else
+#if (SER_PHY_HCI_WINDOW_SIZE > 1)
+        hci_tx_window_init(1); // Until the peer tells its window size
+#endif /* SER_PHY_HCI_WINDOW_SIZE > 1 */
         hci_timeout_setup(7u);// Trigger sending SYNC messages
         m_hci_mode          = HCI_MODE_UNINITIALIZED;
 #endif /*HCI_LINK_CONTROL*/
@@ -52,6 +52,10 @@
 #endif /* SER_CONNECTIVITY */
 
 #include "ser_config.h"
+#ifdef SER_PHY_HCI_SLIP_BLOCK
+#include "slip.h"
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
+
 #define APP_SLIP_END     0xC0 /**< SLIP code for identifying the beginning and end of a packet frame.. */
 #define APP_SLIP_ESC     0xDB /**< SLIP escape code. This code is used to specify that the following character is specially encoded. */
 #define APP_SLIP_ESC_END 0xDC /**< SLIP special code. When this code follows 0xDB, this character is interpreted as payload data 0xC0.. */
@@ -78,7 +82,6 @@ static uint8_t m_big_buffer[PKT_SIZE];
 
 static uint8_t * mp_small_buffer = NULL;
 static uint8_t * mp_big_buffer   = NULL;
-static uint8_t * mp_buffer       = NULL;
 
 static ser_phy_hci_pkt_params_t m_header;
 static ser_phy_hci_pkt_params_t m_payload;
@@ -90,22 +93,46 @@ static ser_phy_hci_pkt_params_t m_crc_pending;
 static ser_phy_hci_slip_evt_t           m_ser_phy_hci_slip_event;
 static ser_phy_hci_slip_event_handler_t m_ser_phy_hci_slip_event_handler; /**< Event handler for upper layer */
 
-static bool    m_other_side_active = false; /**< Flag indicating that the other side is running */
-static uint8_t m_rx_byte;                   /**< Rx byte passed from low-level driver */
-
-static bool m_rx_escape = false;
-static bool m_tx_escape = false;
-
-static bool m_tx_busy = false; /**< Flag indicating that currently some transmission is ongoing */
+static bool m_other_side_active = false; /**< Flag indicating that the other side is running */
+static bool m_tx_busy           = false; /**< Flag indicating that currently some transmission is ongoing */
 
 static uint32_t                   m_tx_index;
-static uint32_t                   m_rx_index;
 static ser_phy_hci_pkt_params_t * mp_data = NULL;
 
+#ifdef SER_PHY_HCI_SLIP_BLOCK
+/* Block mode: frames are encoded straight into the UART TX FIFO and decoded straight from the
+ * UART RX FIFO, a span at a time, instead of one byte per UART event. */
+typedef enum
+{
+    TX_STAGE_IDLE,   /**< No frame in progress */
+    TX_STAGE_START,  /**< Opening 0xC0 not written yet */
+    TX_STAGE_DATA,   /**< Encoding header, payload and CRC */
+    TX_STAGE_END,    /**< Closing 0xC0 not written yet */
+    TX_STAGE_DRAIN   /**< Frame is in the TX FIFO, waiting for it to go out */
+} tx_stage_t;
+
+static ser_phy_hci_pkt_params_t * const m_tx_parts[] = {&m_header, &m_payload, &m_crc};
+
+static slip_encoder_t m_slip_encoder;
+static slip_decoder_t m_slip_decoder;
+static tx_stage_t     m_tx_stage = TX_STAGE_IDLE;
+static uint32_t       m_tx_part;   /**< Index of the part being encoded in m_tx_parts */
+static bool           m_tx_ack;    /**< Frame being sent is an ACK (header only) */
+
+static void ser_phy_hci_tx_start(void);
+#else
+static uint8_t * mp_buffer = NULL;
+static uint8_t   m_rx_byte;                 /**< Rx byte passed from low-level driver */
+static uint32_t  m_rx_index;
+
+static bool m_rx_escape = false;
+static bool m_tx_escape = false;
+
 /* Function declarations */
 static uint32_t ser_phy_hci_tx_byte(void);
 static bool     slip_decode(uint8_t * p_received_byte);
 static void     ser_phi_hci_rx_byte(uint8_t rx_byte);
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
 // ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 __STATIC_INLINE void callback_hw_error(uint32_t error_src)
@@ -118,6 +145,7 @@ __STATIC_INLINE void callback_hw_error(uint32_t error_src)
 }
 
 
+#ifndef SER_PHY_HCI_SLIP_BLOCK
 __STATIC_INLINE void slip_encode(void)
 {
     switch (mp_data->p_buffer[m_tx_index])
@@ -138,6 +166,7 @@ __STATIC_INLINE void slip_encode(void)
             break;
     }
 }
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
 
 
 __STATIC_INLINE bool check_pending_tx()
@@ -161,13 +190,18 @@ __STATIC_INLINE bool check_pending_tx()
         tx_continue = true;
 
         /* Start sending pending packet */
+#ifdef SER_PHY_HCI_SLIP_BLOCK
+        ser_phy_hci_tx_start();
+#else
         (void)ser_phy_hci_tx_byte();
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
     }
 
     return tx_continue;
 }
 
 
+#ifndef SER_PHY_HCI_SLIP_BLOCK
 static uint32_t ser_phy_hci_tx_byte()
 {
     /* Flags informing about actually transmited part of packet*/
@@ -286,6 +320,119 @@ static uint32_t ser_phy_hci_tx_byte()
 
     return NRF_SUCCESS;
 }
+#else
+
+
+/* Moves to the next non-empty part of the frame, or to the closing 0xC0 after the last part. */
+static void tx_part_next(void)
+{
+    m_tx_index = 0;
+
+    do
+    {
+        m_tx_part++;
+    }
+    while ((m_tx_part < sizeof (m_tx_parts) / sizeof (m_tx_parts[0])) &&
+           ((m_tx_parts[m_tx_part]->p_buffer == NULL) || (m_tx_parts[m_tx_part]->num_of_bytes == 0)));
+
+    if (m_tx_part == sizeof (m_tx_parts) / sizeof (m_tx_parts[0]))
+    {
+        m_tx_stage = TX_STAGE_END;
+    }
+}
+
+
+/* Encodes as much of the current frame as fits into the UART TX FIFO. */
+static void ser_phy_hci_tx_fill(void)
+{
+    uint8_t * p_span;
+    uint32_t  span_len;
+    uint32_t  out_len;
+    uint32_t  in_len;
+    uint32_t  len;
+    uint32_t  err_code;
+
+    while ((m_tx_stage != TX_STAGE_IDLE) && (m_tx_stage != TX_STAGE_DRAIN) &&
+           (app_uart_write_reserve(&p_span, &span_len) == NRF_SUCCESS))
+    {
+        out_len = 0;
+
+        while ((out_len < span_len) && (m_tx_stage != TX_STAGE_DRAIN))
+        {
+            switch (m_tx_stage)
+            {
+                case TX_STAGE_START:
+                    p_span[out_len++] = SLIP_END;
+                    m_tx_stage        = TX_STAGE_DATA;
+                    break;
+
+                case TX_STAGE_DATA:
+                    mp_data  = m_tx_parts[m_tx_part];
+                    in_len   = mp_data->num_of_bytes - m_tx_index;
+                    len      = span_len - out_len;
+                    err_code = slip_encode(&m_slip_encoder,
+                                           &mp_data->p_buffer[m_tx_index],
+                                           &in_len,
+                                           &p_span[out_len],
+                                           &len);
+                    m_tx_index += in_len;
+                    out_len    += len;
+
+                    if (err_code == NRF_SUCCESS)
+                    {
+                        tx_part_next();
+                    }
+                    break;
+
+                default:
+                    /* Closing 0xC0, the frame no longer needs the caller's buffers */
+                    p_span[out_len++]  = SLIP_END;
+                    m_header.p_buffer  = NULL;
+                    m_payload.p_buffer = NULL;
+                    m_crc.p_buffer     = NULL;
+                    m_tx_stage         = TX_STAGE_DRAIN;
+                    break;
+            }
+        }
+
+        (void)app_uart_write_commit(out_len);
+    }
+}
+
+
+static void ser_phy_hci_tx_start(void)
+{
+    slip_encoder_init(&m_slip_encoder);
+
+    m_tx_ack   = (m_payload.p_buffer == NULL);
+    m_tx_part  = 0;
+    m_tx_index = 0;
+    m_tx_stage = TX_STAGE_START;
+
+    ser_phy_hci_tx_fill();
+}
+
+
+/* Called when the UART TX FIFO is empty: either the frame is out, or the FIFO needs refilling. */
+static void ser_phy_hci_tx_empty(void)
+{
+    bool ack = m_tx_ack;
+
+    if (m_tx_stage != TX_STAGE_DRAIN)
+    {
+        ser_phy_hci_tx_fill();
+        return;
+    }
+
+    m_tx_stage = TX_STAGE_IDLE;
+    m_tx_busy  = check_pending_tx();
+
+    /* Report end of ACK or packet transmission */
+    m_ser_phy_hci_slip_event.evt_type = ack ? SER_PHY_HCI_SLIP_EVT_ACK_SENT :
+                                              SER_PHY_HCI_SLIP_EVT_PKT_SENT;
+    m_ser_phy_hci_slip_event_handler(&m_ser_phy_hci_slip_event);
+}
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
 
 
 uint32_t ser_phy_hci_slip_tx_pkt_send(const ser_phy_hci_pkt_params_t * p_header,
@@ -336,7 +483,11 @@ uint32_t ser_phy_hci_slip_tx_pkt_send(const ser_phy_hci_pkt_params_t * p_header,
     if (!m_tx_busy)
     {
         m_tx_busy = true;
+#ifdef SER_PHY_HCI_SLIP_BLOCK
+        ser_phy_hci_tx_start();
+#else
         (void)ser_phy_hci_tx_byte();
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
     }
 
     /* Enable TXRDY interrupts at this point*/
@@ -346,6 +497,7 @@ uint32_t ser_phy_hci_slip_tx_pkt_send(const ser_phy_hci_pkt_params_t * p_header,
 }
 
 
+#ifndef SER_PHY_HCI_SLIP_BLOCK
 /* Function returns false when last byte in packet is detected.*/
 static bool slip_decode(uint8_t * p_received_byte)
 {
@@ -515,6 +667,87 @@ static void ser_phi_hci_rx_byte(uint8_t rx_byte)
         return;
     }
 }
+#else
+
+
+/* Called when the decoder needs room for the next byte: at the start of a frame, when the frame
+ * outgrows the small (ACK) buffer, and when it outgrows the big (PKT) buffer. */
+static void ser_phy_hci_rx_buffer_grow(void)
+{
+    if ((m_slip_decoder.p_buffer == NULL) && (mp_small_buffer != NULL))
+    {
+        slip_decoder_buffer_set(&m_slip_decoder, mp_small_buffer, sizeof (m_small_buffer));
+    }
+    else if ((m_slip_decoder.p_buffer != m_big_buffer) && (mp_big_buffer != NULL))
+    {
+        /* Switch to big buffer */
+        if (m_slip_decoder.p_buffer == NULL)
+        {
+            slip_decoder_buffer_set(&m_slip_decoder, mp_big_buffer, sizeof (m_big_buffer));
+        }
+        else
+        {
+            (void)slip_decoder_buffer_move(&m_slip_decoder, mp_big_buffer, sizeof (m_big_buffer));
+        }
+    }
+    else
+    {
+        /* No buffer available or the packet is too big - drop it without notifying upper layer */
+        slip_decoder_skip(&m_slip_decoder);
+        slip_decoder_buffer_set(&m_slip_decoder, NULL, 0);
+    }
+}
+
+
+static void ser_phy_hci_rx_pkt_received(void)
+{
+    uint8_t * p_buffer = m_slip_decoder.p_buffer;
+    uint32_t  length   = m_slip_decoder.len;
+
+    /* Reset pointers to signalise buffers are locked waiting for upper layer */
+    if (p_buffer == m_small_buffer)
+    {
+        mp_small_buffer = NULL;
+    }
+    else
+    {
+        mp_big_buffer = NULL;
+    }
+
+    /* Next packet picks its buffer when its first byte arrives */
+    slip_decoder_buffer_set(&m_slip_decoder, NULL, 0);
+
+    /* Report packet reception end*/
+    m_ser_phy_hci_slip_event.evt_type = SER_PHY_HCI_SLIP_EVT_PKT_RECEIVED;
+    m_ser_phy_hci_slip_event.evt_params.received_pkt.p_buffer     = p_buffer;
+    m_ser_phy_hci_slip_event.evt_params.received_pkt.num_of_bytes = length;
+    m_ser_phy_hci_slip_event_handler(&m_ser_phy_hci_slip_event);
+}
+
+
+/* Decodes everything in the UART RX FIFO. */
+static void ser_phy_hci_rx_process(void)
+{
+    uint8_t * p_span;
+    uint32_t  span_len;
+    uint32_t  err_code;
+
+    while (app_uart_read_peek(&p_span, &span_len) == NRF_SUCCESS)
+    {
+        err_code = slip_decode(&m_slip_decoder, p_span, &span_len);
+        (void)app_uart_read_commit(span_len);
+
+        if (err_code == NRF_SUCCESS)
+        {
+            ser_phy_hci_rx_pkt_received();
+        }
+        else if (err_code == NRF_ERROR_NO_MEM)
+        {
+            ser_phy_hci_rx_buffer_grow();
+        }
+    }
+}
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
 
 
 uint32_t ser_phy_hci_slip_rx_buf_free(uint8_t * p_buffer)
@@ -574,6 +807,20 @@ static void ser_phy_uart_evt_callback(app_uart_evt_t * uart_evt)
             }
             break;
 
+#ifdef SER_PHY_HCI_SLIP_BLOCK
+        case APP_UART_FIFO_ERROR:
+            callback_hw_error(uart_evt->data.error_code);
+            break;
+
+        case APP_UART_TX_EMPTY:
+            ser_phy_hci_tx_empty();
+            break;
+
+        case APP_UART_DATA_READY:
+            m_other_side_active = true;
+            ser_phy_hci_rx_process();
+            break;
+#else
         case APP_UART_TX_EMPTY:
             (void)ser_phy_hci_tx_byte();
             break;
@@ -590,6 +837,7 @@ static void ser_phy_uart_evt_callback(app_uart_evt_t * uart_evt)
             m_rx_byte = uart_evt->data.value;
             ser_phi_hci_rx_byte(m_rx_byte);
             break;
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
 
         default:
             APP_ERROR_CHECK(NRF_ERROR_INTERNAL);
@@ -615,7 +863,19 @@ uint32_t ser_phy_hci_slip_open(ser_phy_hci_slip_event_handler_t events_handler)
 
     // Configure UART and register handler
     // uart_evt_handler is used to handle events produced by low-level uart driver
+#ifdef SER_PHY_HCI_SLIP_BLOCK
+    slip_decoder_init(&m_slip_decoder);
+    m_tx_stage = TX_STAGE_IDLE;
+
+    APP_UART_FIFO_INIT(&comm_params,
+                       SER_PHY_HCI_SLIP_UART_RX_BUF_SIZE,
+                       SER_PHY_HCI_SLIP_UART_TX_BUF_SIZE,
+                       ser_phy_uart_evt_callback,
+                       UART_IRQ_PRIORITY,
+                       err_code);
+#else
     APP_UART_INIT(&comm_params, ser_phy_uart_evt_callback, UART_IRQ_PRIORITY, err_code);
+#endif /* SER_PHY_HCI_SLIP_BLOCK */
 
     mp_small_buffer = m_small_buffer;
     mp_big_buffer   = m_big_buffer;
@@ -13,6 +13,7 @@
 #include <string.h>
 #include "app_error.h"
 #include "app_scheduler.h"
+#include "app_util_platform.h"
 #include "ser_config.h"
 #include "ser_conn_handlers.h"
 #include "ser_conn_event_encoder.h"
@@ -32,11 +33,16 @@
  *          the SoftDevice and events generated by the HAL Transport layer.
  */
 
-/** Parameters of a received packet. */
-static ser_hal_transport_evt_rx_pkt_received_params_t m_rx_pkt_received_params;
+/** Parameters of received packets, oldest first. The HAL Transport layer gives out at most
+ *  SER_HAL_TRANSPORT_RX_BUF_COUNT packets before they are freed, so the queue cannot overflow. */
+static ser_hal_transport_evt_rx_pkt_received_params_t
+    m_rx_pkt_received_params[SER_HAL_TRANSPORT_RX_BUF_COUNT];
 
-/** Indicator of received packet that should be process. */
-static bool m_rx_pkt_to_process = false;
+/** Index of the oldest received packet. */
+static uint8_t m_rx_pkt_head = 0;
+
+/** Number of received packets that should be processed. */
+static volatile uint8_t m_rx_pkt_to_process = 0;
 
 
 void ser_conn_hal_transport_event_handle(ser_hal_transport_evt_t event)
@@ -69,9 +75,11 @@ void ser_conn_hal_transport_event_handle(ser_hal_transport_evt_t event)
             /* We can NOT add received packets as events to the application scheduler queue because
              * received packets have to be processed before SoftDevice events but the scheduler
              * queue do not have priorities. */
-            memcpy(&m_rx_pkt_received_params, &event.evt_params.rx_pkt_received,
+            memcpy(&m_rx_pkt_received_params[(m_rx_pkt_head + m_rx_pkt_to_process) %
+                                             SER_HAL_TRANSPORT_RX_BUF_COUNT],
+                   &event.evt_params.rx_pkt_received,
                    sizeof (ser_hal_transport_evt_rx_pkt_received_params_t));
-            m_rx_pkt_to_process = true;
+            m_rx_pkt_to_process++;
             break;
         }
 
@@ -99,13 +107,18 @@ void ser_conn_hal_transport_event_handle(ser_hal_transport_evt_t event)
 uint32_t ser_conn_rx_process(void)
 {
     uint32_t err_code = NRF_SUCCESS;
+    ser_hal_transport_evt_rx_pkt_received_params_t rx_pkt_received_params;
 
     if (m_rx_pkt_to_process)
     {
-        /* No critical section needed on m_rx_pkt_to_process parameter because it is not possible
-         * to get next packet before sending a response. */
-        m_rx_pkt_to_process = false;
-        err_code            = ser_conn_received_pkt_process(&m_rx_pkt_received_params);
+        /* Next packet can be received while this one is processed if there are more RX buffers. */
+        CRITICAL_REGION_ENTER();
+        rx_pkt_received_params = m_rx_pkt_received_params[m_rx_pkt_head];
+        m_rx_pkt_head          = (m_rx_pkt_head + 1) % SER_HAL_TRANSPORT_RX_BUF_COUNT;
+        m_rx_pkt_to_process--;
+        CRITICAL_REGION_EXIT();
+
+        err_code = ser_conn_received_pkt_process(&rx_pkt_received_params);
     }
 
     return err_code;
@@ -64,6 +64,8 @@ void ser_conn_hal_transport_event_handle(ser_hal_transport_evt_t event);
 
 
 /**@brief A function to call the function to process a packet when it is fully received.
+ *
+ * @note The oldest received packet is processed, one packet per call.
  *
  * @retval    NRF_SUCCESS           Operation success.
  * @retval    NRF_ERROR_NULL        Operation failure. NULL pointer supplied.
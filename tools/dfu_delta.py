@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+#
+# Make and apply delta DFU patches.
+#
+# A patch rebuilds a new application image from the one currently in bank 0,
+# so only the changed parts are sent over the air. The format is described in
+# sdk/nrf51_sdk_9.0.0/components/libraries/bootloader_dfu/dfu_delta.h, and the
+# bootloader applies it when built with DFU_PAGE_BUFFERED and DFU_DELTA.
+#
+# The patch is sent instead of the application image. The bootloader checks
+# the init packet against the image it rebuilds, so the init packet is the one
+# made for the new image, not for the patch:
+#
+#   dfu_delta.py diff old_app.hex new_app.hex app.patch
+#   dfu_delta.py apply old_app.hex app.patch check.bin
+#
+# Images are read as Intel HEX if their name ends in .hex, otherwise as raw
+# binary. The old image must be exactly what is in bank 0.
+
+import argparse
+import binascii
+import struct
+import sys
+
+MAGIC = 0x01544C44
+HEADER = struct.Struct('<IIIHH')
+KEY_LEN = 4             # bytes hashed to find copy candidates
+CANDIDATES_MAX = 32     # source positions kept per key
+LITERAL_MAX = 1 << 14   # longest literal run in one command
+UICR_BASE = 0x10000000  # hex records from here on are not part of the image
+
+
+def crc16(data):
+    # Same CRC-16-CCITT as crc16_compute() in the SDK, started from 0xFFFF
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def read_image(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if not path.endswith('.hex'):
+        return data
+
+    memory = {}
+    base = 0
+    for line in data.decode('ascii').split():
+        record = bytes.fromhex(line[1:])
+        length, address, kind = record[0], (record[1] << 8) | record[2], record[3]
+        payload = record[4:4 + length]
+        if kind == 0x00 and base + address < UICR_BASE:
+            for i, byte in enumerate(payload):
+                memory[base + address + i] = byte
+        elif kind == 0x02:
+            base = int.from_bytes(payload, 'big') << 4
+        elif kind == 0x04:
+            base = int.from_bytes(payload, 'big') << 16
+        elif kind == 0x01:
+            break
+    if not memory:
+        return b''
+    start = min(memory)
+    image = bytearray(b'\xff' * (max(memory) + 1 - start))
+    for address, byte in memory.items():
+        image[address - start] = byte
+    return bytes(image)
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def match_length(source, s, target, t):
+    n = 0
+    limit = min(len(source) - s, len(target) - t)
+    # Compare in blocks first, then finish byte by byte
+    while n + 64 <= limit and source[s + n:s + n + 64] == target[t + n:t + n + 64]:
+        n += 64
+    while n < limit and source[s + n] == target[t + n]:
+        n += 1
+    return n
+
+
+def diff(source, target):
+    if len(target) % 4:
+        # The bootloader writes whole words and rejects such a patch.
+        raise ValueError('new image size is not a multiple of 4')
+
+    index = {}
+    for s in range(len(source) - KEY_LEN + 1):
+        positions = index.setdefault(source[s:s + KEY_LEN], [])
+        if len(positions) < CANDIDATES_MAX:
+            positions.append(s)
+
+    out = bytearray(HEADER.pack(MAGIC, len(target), len(source), crc16(source), crc16(target)))
+    literal = bytearray()
+    source_pos = 0      # source position in the decoder, moved by copies only
+    predicted = 0       # source position matching the next target byte
+    t = 0
+
+    def flush_literal():
+        for i in range(0, len(literal), LITERAL_MAX):
+            run = literal[i:i + LITERAL_MAX]
+            out.extend(varint((len(run) - 1) << 1))
+            out.extend(run)
+        literal.clear()
+
+    while t < len(target):
+        # Resuming where the source lines up with the target is cheap to
+        # encode, so try that first
+        best_pos, best_len = predicted, 0
+        if predicted < len(source):
+            best_len = match_length(source, predicted, target, t)
+        for s in index.get(target[t:t + KEY_LEN], ()):
+            n = match_length(source, s, target, t)
+            if n > best_len:
+                best_pos, best_len = s, n
+
+        command = b''
+        if best_len >= KEY_LEN:
+            command = varint(((best_len - 1) << 1) | 1) + varint(zigzag(best_pos - source_pos))
+        if command and best_len > len(command):
+            flush_literal()
+            out.extend(command)
+            source_pos = best_pos + best_len
+            predicted = source_pos
+            t += best_len
+        else:
+            # A changed byte usually replaces one at the same place
+            literal.append(target[t])
+            predicted += 1
+            t += 1
+    flush_literal()
+
+    out.extend(b'\xff' * (-len(out) % 4))
+    return bytes(out)
+
+
+def apply(source, patch):
+    magic, target_size, source_size, source_crc, target_crc = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        raise ValueError('not a delta patch')
+    if target_size % 4:
+        raise ValueError('new image size is not a multiple of 4')
+    if source_size > len(source) or crc16(source[:source_size]) != source_crc:
+        raise ValueError('patch was made for a different source image')
+
+    target = bytearray()
+    source_pos = 0
+    i = HEADER.size
+
+    def read_varint():
+        nonlocal i
+        value, shift = 0, 0
+        while True:
+            byte = patch[i]
+            i += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while len(target) < target_size:
+        command = read_varint()
+        length = (command >> 1) + 1
+        if command & 1:
+            offset = read_varint()
+            source_pos += (offset >> 1) ^ -(offset & 1)
+            target.extend(source[source_pos:source_pos + length])
+            source_pos += length
+        else:
+            target.extend(patch[i:i + length])
+            i += length
+
+    if len(target) != target_size or crc16(target) != target_crc:
+        raise ValueError('target CRC mismatch')
+    return bytes(target)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Make and apply delta DFU patches.')
+    commands = parser.add_subparsers(dest='command')
+    d = commands.add_parser('diff', help='make a patch from OLD to NEW')
+    d.add_argument('old')
+    d.add_argument('new')
+    d.add_argument('patch')
+    a = commands.add_parser('apply', help='rebuild NEW from OLD and a patch')
+    a.add_argument('old')
+    a.add_argument('patch')
+    a.add_argument('new')
+    args = parser.parse_args()
+
+    if args.command == 'diff':
+        source = read_image(args.old)
+        target = read_image(args.new)
+        patch = diff(source, target)
+        with open(args.patch, 'wb') as f:
+            f.write(patch)
+        print('{}: {} bytes, {:.1f}% of the {} byte image (CRC 0x{:04X})'.format(
+            args.patch, len(patch), 100.0 * len(patch) / max(len(target), 1), len(target),
+            crc16(target)))
+    elif args.command == 'apply':
+        with open(args.patch, 'rb') as f:
+            patch = f.read()
+        target = apply(read_image(args.old), patch)
+        with open(args.new, 'wb') as f:
+            f.write(target)
+    else:
+        parser.print_help()
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())